@@ -1,41 +1,178 @@
-// 0/1 Knapsack Problem (Dynamic Programming)
-// From CLRS, Chapter 15.3
-// Author: Mohammad
+/* 0/1 Knapsack Problem (Dynamic Programming)
+From CLRS, Chapter 15.3
+Author: Mohammad
+
+The engines live in knapsack.h. The DP uses O(W) memory instead of the
+(n + 1) x (W + 1) table, and rebuilds the chosen items with Hirschberg's
+divide and conquer. In parallel mode every row is split into capacity
+slices, one per thread. For capacities too large for any DP row,
+branch and bound with Dantzig bounds and a core problem runs in time
+independent of W. -t caps its run time; it then reports the best
+solution found. The default mode, auto, picks the engine from n and W.
+
+Instance file: "n W" followed by n lines "weight value".
+
+gcc -O3 -march=native -fopenmp 0_1_Knapsack_problem.c -o knapsack
+./knapsack [options]                               CLRS example
+./knapsack [options] items.txt
+./knapsack [options] random n W [max_weight]
+
+options: -m sequential | parallel | branch-bound | auto   (default auto)
+         -t seconds   time limit for branch and bound */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "knapsack.h"
+#include "xorshift.h"
+
+// Items listed individually up to this many
+#define PRINT_ITEMS 20
+
+// Cross-check against the value-only DP only when it is cheap
+#define CHECK_MAX_CELLS 1000000000LL
 
-// Function to get the maximum of two integers
-int max(int a, int b) {
-    return (a > b) ? a : b;
+// Solves the 0/1 Knapsack problem; take[i] is set for the chosen items
+struct KnapsackResult knapsack(long long W, const long long wt[], const long long val[], int n,
+                               enum KnapsackMode mode, double seconds, unsigned char take[]) {
+    return knapsackOptimize(wt, val, n, W, mode, seconds, take);
 }
 
-// Solves the 0/1 Knapsack problem using bottom-up DP
-int knapsack(int W, int wt[], int val[], int n) {
-    int K[n + 1][W + 1];
-
-    // Build table K[][] in bottom-up manner
-    for (int i = 0; i <= n; i++) {
-        for (int w = 0; w <= W; w++) {
-            if (i == 0 || w == 0)
-                K[i][w] = 0;
-            else if (wt[i - 1] <= w)
-                K[i][w] = max(val[i - 1] + K[i - 1][w - wt[i - 1]], K[i - 1][w]);
-            else
-                K[i][w] = K[i - 1][w];
+// Reads "n W" and n "weight value" lines
+int readInstance(const char* filename, long long** wt, long long** val, long long* W) {
+    FILE* f = fopen(filename, "r");
+    if (!f) {
+        perror(filename);
+        exit(1);
+    }
+    int n;
+    if (fscanf(f, "%d %lld", &n, W) != 2 || n < 0) {
+        fprintf(stderr, "%s: expected \"n W\" on the first line\n", filename);
+        exit(1);
+    }
+    *wt = (long long*)knapsackAlloc(n * sizeof(long long));
+    *val = (long long*)knapsackAlloc(n * sizeof(long long));
+    for (int i = 0; i < n; i++)
+        if (fscanf(f, "%lld %lld", &(*wt)[i], &(*val)[i]) != 2) {
+            fprintf(stderr, "%s: item %d is missing\n", filename, i);
+            exit(1);
         }
+    fclose(f);
+    return n;
+}
+
+// Weights uniform in [1, maxWeight], values within 10% of the weight, the
+// weakly correlated family that is hard for greedy bounds
+void randomInstance(int n, long long maxWeight, long long* wt, long long* val) {
+    for (int i = 0; i < n; i++) {
+        wt[i] = 1 + (long long)(xorshift64() % maxWeight);
+        long long spread = maxWeight / 10 + 1;
+        long long v = wt[i] + (long long)(xorshift64() % (2 * spread + 1)) - spread;
+        val[i] = v > 0 ? v : 1;
     }
+}
 
-    return K[n][W];
+void usage(const char* program) {
+    printf("Usage: %s [-m sequential|parallel|branch-bound|auto] [-t seconds] "
+           "[items.txt | random n W [max_weight]]\n", program);
+    exit(1);
 }
 
-int main() {
-    // Example input from CLRS
-    int val[] = {60, 100, 120};
-    int wt[] = {10, 20, 30};
-    int W = 50; // knapsack capacity
-    int n = sizeof(val) / sizeof(val[0]);
+int main(int argc, char* argv[]) {
+    enum KnapsackMode mode = KNAPSACK_AUTO;
+    double seconds = 0;
+    long long *wt, *val, W;
+    int n;
+
+    const char* args[4];
+    int nargs = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            if (!parseKnapsackMode(argv[++i], &mode))
+                usage(argv[0]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (nargs < 4)
+            args[nargs++] = argv[i];
+        else
+            usage(argv[0]);
+    }
+
+    if (nargs > 0 && strcmp(args[0], "random") == 0) {
+        if (nargs < 3)
+            usage(argv[0]);
+        n = atoi(args[1]);
+        W = atoll(args[2]);
+        long long maxWeight = nargs > 3 ? atoll(args[3]) : W / 4 + 1;
+        if (n < 0 || maxWeight < 1) {
+            fprintf(stderr, "n must be non-negative and max_weight positive\n");
+            return 1;
+        }
+        wt = (long long*)knapsackAlloc(n * sizeof(long long));
+        val = (long long*)knapsackAlloc(n * sizeof(long long));
+        randomInstance(n, maxWeight, wt, val);
+    } else if (nargs == 1) {
+        n = readInstance(args[0], &wt, &val, &W);
+    } else if (nargs == 0) {
+        // Example input from CLRS
+        static const long long exampleVal[] = {60, 100, 120};
+        static const long long exampleWt[] = {10, 20, 30};
+        n = 3;
+        W = 50;  // knapsack capacity
+        wt = (long long*)knapsackAlloc(n * sizeof(long long));
+        val = (long long*)knapsackAlloc(n * sizeof(long long));
+        memcpy(wt, exampleWt, sizeof(exampleWt));
+        memcpy(val, exampleVal, sizeof(exampleVal));
+    } else {
+        usage(argv[0]);
+    }
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    printf("%d items, W = %lld, %s mode, %d threads\n", n, W, knapsackModeName(mode), threads);
+
+    unsigned char* take = (unsigned char*)knapsackAlloc(n);
+    double t = knapsackClock();
+    struct KnapsackResult r = knapsack(W, wt, val, n, mode, seconds, take);
+    t = knapsackClock() - t;
+
+    long long weight = 0, chosen = 0;
+    for (int i = 0; i < n; i++)
+        if (take[i]) {
+            weight += wt[i];
+            chosen++;
+            if (n <= PRINT_ITEMS)
+                printf("  take item %d (weight %lld, value %lld)\n", i, wt[i], val[i]);
+        }
+    printf("%s value in Knapsack = %lld\n", r.optimal ? "Maximum" : "Time limit reached, best", r.value);
+    printf("%lld items chosen, total weight %lld, %s engine, %.3f s", chosen, weight,
+           knapsackModeName(r.engine), t);
+    if (r.engine == KNAPSACK_BRANCH_BOUND)
+        printf(" (%lld nodes)\n", r.nodes);
+    else
+        printf(" (%.3e cells/s)\n", t > 0 ? (double)n * (W + 1) / t : 0.0);
+
+    // Cross-check against the value-only DP
+    if (weight > W) {
+        fprintf(stderr, "MISMATCH: chosen items exceed the capacity\n");
+        return 1;
+    }
+    if (r.optimal && (double)n * (W + 1) <= CHECK_MAX_CELLS) {
+        long long reference = knapsackValue(wt, val, n, W, KNAPSACK_PARALLEL);
+        if (reference != r.value) {
+            fprintf(stderr, "MISMATCH: value-only DP gives %lld\n", reference);
+            return 1;
+        }
+    }
 
-    int maxValue = knapsack(W, wt, val, n);
-    printf("Maximum value in Knapsack = %d\n", maxValue);
+    free(take);
+    free(wt);
+    free(val);
     return 0;
 }
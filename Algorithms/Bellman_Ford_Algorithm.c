@@ -6,22 +6,8 @@
 #include <stdlib.h>
 #include <limits.h>
 
-struct Edge {
-    int src, dest, weight;
-};
-
-struct Graph {
-    int V, E;
-    struct Edge* edge;
-};
-
-struct Graph* createGraph(int V, int E) {
-    struct Graph* graph = (struct Graph*)malloc(sizeof(struct Graph));
-    graph->V = V;
-    graph->E = E;
-    graph->edge = (struct Edge*)malloc(E * sizeof(struct Edge));
-    return graph;
-}
+#include "../Graph/csr_graph_file.h"
+#include "../Graph/bellman_ford.h"
 
 void printArr(int dist[], int n) {
     printf("Vertex\tDistance from Source\n");
@@ -32,60 +18,68 @@ void printArr(int dist[], int n) {
             printf("%d\t%d\n", i, dist[i]);
 }
 
-void BellmanFord(struct Graph* graph, int src) {
+void BellmanFord(const struct CSRGraph* graph, int src, enum BFMode mode) {
     int V = graph->V;
-    int E = graph->E;
-    int dist[V];
+    int* dist = (int*)csrAlloc(V * sizeof(int));
 
     // Step 1: Initialize distances
     for (int i = 0; i < V; i++)
         dist[i] = INT_MAX;
     dist[src] = 0;
 
-    // Step 2: Relax all edges |V| - 1 times
-    for (int i = 1; i <= V - 1; i++) {
-        for (int j = 0; j < E; j++) {
-            int u = graph->edge[j].src;
-            int v = graph->edge[j].dest;
-            int w = graph->edge[j].weight;
-            if (dist[u] != INT_MAX && dist[u] + w < dist[v])
-                dist[v] = dist[u] + w;
-        }
-    }
-
-    // Step 3: Detect negative weight cycles
-    for (int j = 0; j < E; j++) {
-        int u = graph->edge[j].src;
-        int v = graph->edge[j].dest;
-        int w = graph->edge[j].weight;
-        if (dist[u] != INT_MAX && dist[u] + w < dist[v]) {
-            printf("Graph contains a negative weight cycle!\n");
-            return;
-        }
+    // Step 2 + 3: Relax edges until nothing changes (at most |V| - 1 rounds);
+    // still changing after that means a negative weight cycle
+    struct BFStats stats;
+    if (!bellmanFordSSSP(graph, dist, mode, &stats)) {
+        printf("Graph contains a negative weight cycle!\n");
+        free(dist);
+        return;
     }
 
     printArr(dist, V);
+    fprintf(stderr, "%lld passes, %lld edge relaxations\n", stats.passes, stats.relaxations);
+    free(dist);
 }
 
-int main() {
+// ./bellman_ford                                         built-in example
+// ./bellman_ford graph.csr [src] [early|spfa|parallel]   graph from Graph/Graph_Converter.c
+// gcc -O2 -fopenmp Bellman_Ford_Algorithm.c -o bellman_ford
+int main(int argc, char* argv[]) {
+    enum BFMode mode = BF_SPFA;
+    if (argc > 3 && !parseBFMode(argv[3], &mode)) {
+        printf("Unknown mode '%s' (use early, spfa or parallel)\n", argv[3]);
+        return 1;
+    }
+
+    if (argc > 1) {
+        struct CSRGraph* graph = loadCSRGraphFile(argv[1]);
+        if (!graph)
+            return 1;
+        int src = argc > 2 ? atoi(argv[2]) : 0;
+        if (src < 0 || src >= graph->V) {
+            printf("Source vertex %d is out of range [0, %d).\n", src, graph->V);
+            freeCSRGraph(graph);
+            return 1;
+        }
+        BellmanFord(graph, src, mode);
+        freeCSRGraph(graph);
+        return 0;
+    }
+
     int V = 5;  // vertices
-    int E = 8;  // edges
-    struct Graph* graph = createGraph(V, E);
 
     // Example from CLRS (Chapter 24.1)
-    graph->edge[0] = (struct Edge){0, 1, -1};
-    graph->edge[1] = (struct Edge){0, 2, 4};
-    graph->edge[2] = (struct Edge){1, 2, 3};
-    graph->edge[3] = (struct Edge){1, 3, 2};
-    graph->edge[4] = (struct Edge){1, 4, 2};
-    graph->edge[5] = (struct Edge){3, 2, 5};
-    graph->edge[6] = (struct Edge){3, 1, 1};
-    graph->edge[7] = (struct Edge){4, 3, -3};
+    struct CSREdge edges[] = {
+        {0, 1, -1}, {0, 2, 4},
+        {1, 2, 3}, {1, 3, 2}, {1, 4, 2},
+        {3, 2, 5}, {3, 1, 1},
+        {4, 3, -3}
+    };
+    struct CSRGraph* graph = buildCSRGraph(V, edges, sizeof(edges) / sizeof(edges[0]));
 
-    BellmanFord(graph, 0);
+    BellmanFord(graph, 0, mode);
 
-    free(graph->edge);
-    free(graph);
+    freeCSRGraph(graph);
 
     return 0;
 }
@@ -0,0 +1,969 @@
+/* Empirical complexity harness
+
+Quick_Sort_Complexity_Estimation.c measures one run of one algorithm. This
+program sweeps input sizes n = min, min * f, min * f^2, ... up to max for
+every registered case. Each size gets a fresh generated input. For each
+(case, n) it records the median of r repetitions of
+
+  seconds          wall time (CLOCK_MONOTONIC)
+  cycles           CPU cycles from perf_event_open, or TSC ticks where the
+                   kernel offers no hardware counters (cycle_source says which)
+  instructions     \
+  cache_misses      } perf_event hardware counters, "null" when unavailable
+  branch_misses    /
+
+and then fits time = c * n^k by least squares on (log n, log t). It prints
+k and R^2 per case. Points under HARNESS_MIN_FIT_SECONDS are timer noise
+and stay out of the fit. A case stops growing once its median passes the
+-t limit, so quadratic engines do not hold up the sweep.
+
+In-process cases (input generation and the untimed copy before each
+repetition are excluded):
+
+  sort/qsort, sort/introsort                        uniform random int32
+  sort/radix-lsd, sort/radix-parallel, sort/radix-inplace
+  sssp/dijkstra-heap, -radix, -dial                 V = n, E = 8n random,
+  sssp/bellman-ford-early, -spfa, -parallel         weights in [1, 1000]
+  mst/kruskal, mst/filter-kruskal, mst/boruvka
+  dag/critical-path                                 same edges, made acyclic
+  knapsack/dp, -dp-parallel, -branch-bound          n items, W = 16384,
+                                                    with item reconstruction
+  matrix-chain/dp, -parallel, -hu-shing             n matrices, dimensions
+                                                    in [1, 100]
+  huffman/encode, huffman/decode                    n bytes of English-like
+  huffman/decode-4streams                           text, one block
+
+Other programs run as child processes with -x name:input:command. The
+harness writes the generated input to a temporary file and substitutes
+{in}, {out} and {n} into the command. It times fork to exit, and the
+counters follow the child from exec. The input kinds are
+
+  ints   n random int32 as text, one per line
+  text   n bytes of English-like letter frequencies
+  bytes  n uniformly random bytes
+
+for example
+
+  -x arith:text:"../Data_Compression/arith e {in} {out}"
+  -x radix-cli:ints:"./radix_sort {in} {out}"
+
+Hardware counters are opened on the calling thread with inherit set. OpenMP
+worker threads are folded in only when they exit, so the counter columns
+of the parallel engines are exact with OMP_NUM_THREADS=1. Most kernels
+allow user-space counting at perf_event_paranoid <= 2.
+
+gcc -O2 -fopenmp Complexity_Harness.c -o harness -lm
+./harness [-l] [-k pattern] [-n min max] [-f factor] [-r reps] [-t seconds]
+          [-x name:input:command]... [-csv | -json] */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "radix_sort.h"
+#include "introsort.h"
+#include "int_io.h"
+#include "knapsack.h"
+#include "matrix_chain.h"
+#include "../Data_Compression/huffman.h"
+#include "../Graph/sssp.h"
+#include "../Graph/bellman_ford.h"
+#include "../Graph/mst.h"
+#include "../Graph/dag_longest_path.h"
+#include "../Graph/graph_generator.h"
+
+// Points faster than this are left out of the exponent fit
+#define HARNESS_MIN_FIT_SECONDS 1e-4
+
+#define HARNESS_MAX_CASES 64
+#define HARNESS_MAX_POINTS 64
+#define HARNESS_MAX_REPS 101
+
+// Random graphs have this many edges per vertex
+#define GRAPH_DEGREE 8
+#define GRAPH_MAX_WEIGHT 1000
+
+// Knapsack capacity; the DP costs n * (KNAPSACK_W + 1) cells
+#define KNAPSACK_W 16384
+
+enum ExecInput {
+    INPUT_INTS,
+    INPUT_TEXT,
+    INPUT_BYTES
+};
+
+struct BenchCase {
+    const char* name;
+    void* (*setup)(const struct BenchCase* c, size_t n);  // builds the input, untimed
+    void (*reset)(void* state);                           // before every repetition, untimed
+    void (*run)(void* state);                             // timed
+    void (*teardown)(void* state);                        // checks the result and frees
+    int param;                                            // engine selector for shared drivers
+    const char* command;                                  // -x cases only
+    enum ExecInput input;
+};
+
+// One repetition's measurements; -1 means the counter is unavailable
+struct Sample {
+    double seconds;
+    long long cycles, instructions, cacheMisses, branchMisses;
+};
+
+struct Point {
+    size_t n;
+    struct Sample s;
+};
+
+// ---------- Helpers ----------
+void* harnessAlloc(size_t bytes) {
+    void* p = malloc(bytes ? bytes : 1);
+    if (p == NULL) {
+        perror("Memory allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+// A letter drawn with the frequencies of English text, space included
+char randomLetter(void) {
+    static const char alphabet[] = " etaoinshrdlcumwfgypbvkjxqz";
+    static const int weight[] = {180, 102, 75, 65, 62, 57, 57, 51, 50, 48, 35, 33, 23, 23,
+                                 20, 20, 18, 17, 16, 15, 12, 8, 6, 1, 1, 1, 1};
+    int weightSum = 0;
+    for (size_t i = 0; i < sizeof(weight) / sizeof(weight[0]); i++)
+        weightSum += weight[i];
+    int r = (int)(xorshift64() % weightSum), k = 0;
+    while (r >= weight[k])
+        r -= weight[k++];
+    return alphabet[k];
+}
+
+double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+long long readTSC(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return (long long)__rdtsc();
+#else
+    return -1;
+#endif
+}
+
+// ---------- perf_event counters ----------
+#define PERF_EVENTS 4
+
+static const unsigned long long perfConfig[PERF_EVENTS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+struct PerfCounters {
+    int fd[PERF_EVENTS];
+};
+
+// Opens the counters disabled on pid (0 = this process). With onExec they
+// start counting when pid calls exec. Unavailable events get fd -1.
+void perfOpen(struct PerfCounters* pc, pid_t pid, int onExec) {
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = perfConfig[i];
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.enable_on_exec = onExec;
+        pc->fd[i] = (int)syscall(SYS_perf_event_open, &attr, pid, -1, -1, 0);
+    }
+}
+
+void perfStart(struct PerfCounters* pc) {
+    for (int i = 0; i < PERF_EVENTS; i++)
+        if (pc->fd[i] >= 0) {
+            ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+}
+
+void perfStop(struct PerfCounters* pc) {
+    for (int i = 0; i < PERF_EVENTS; i++)
+        if (pc->fd[i] >= 0)
+            ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+}
+
+long long perfRead(const struct PerfCounters* pc, int i) {
+    unsigned long long v;
+    if (pc->fd[i] < 0 || read(pc->fd[i], &v, sizeof(v)) != (ssize_t)sizeof(v))
+        return -1;
+    return (long long)v;
+}
+
+void perfClose(struct PerfCounters* pc) {
+    for (int i = 0; i < PERF_EVENTS; i++)
+        if (pc->fd[i] >= 0)
+            close(pc->fd[i]);
+}
+
+// Fills the counter fields of s; cycles fall back to the TSC difference
+void perfCollect(const struct PerfCounters* pc, struct Sample* s, long long tscTicks) {
+    s->cycles = perfRead(pc, 0);
+    s->instructions = perfRead(pc, 1);
+    s->cacheMisses = perfRead(pc, 2);
+    s->branchMisses = perfRead(pc, 3);
+    if (s->cycles < 0)
+        s->cycles = tscTicks;
+}
+
+int perfAvailable(const struct PerfCounters* pc) {
+    return pc->fd[0] >= 0;
+}
+
+// Counters for the in-process cases, opened once in main
+struct PerfCounters selfCounters;
+
+// ---------- Sort cases ----------
+enum SortEngine {
+    SORT_QSORT,
+    SORT_INTROSORT,
+    SORT_RADIX_LSD,
+    SORT_RADIX_PARALLEL,
+    SORT_RADIX_INPLACE
+};
+
+struct SortState {
+    int engine;
+    size_t n;
+    int32_t *original, *work, *scratch;
+};
+
+int compareInts(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a, y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+void* sortSetup(const struct BenchCase* c, size_t n) {
+    struct SortState* s = (struct SortState*)harnessAlloc(sizeof(struct SortState));
+    s->engine = c->param;
+    s->n = n;
+    s->original = (int32_t*)harnessAlloc(n * sizeof(int32_t));
+    s->work = (int32_t*)harnessAlloc(n * sizeof(int32_t));
+    s->scratch = (int32_t*)harnessAlloc(n * sizeof(int32_t));
+    for (size_t i = 0; i < n; i++)
+        s->original[i] = (int32_t)xorshift64();
+    return s;
+}
+
+void sortReset(void* state) {
+    struct SortState* s = (struct SortState*)state;
+    memcpy(s->work, s->original, s->n * sizeof(int32_t));
+}
+
+void sortRun(void* state) {
+    struct SortState* s = (struct SortState*)state;
+    switch (s->engine) {
+    case SORT_QSORT:
+        qsort(s->work, s->n, sizeof(int32_t), compareInts);
+        break;
+    case SORT_INTROSORT:
+        introsort(s->work, s->n);
+        break;
+    case SORT_RADIX_LSD:
+        radixSortTyped(s->work, s->scratch, s->n, sizeof(int32_t), RADIX_SIGNED);
+        break;
+    case SORT_RADIX_PARALLEL:
+        radixSortParallel(s->work, s->scratch, s->n, sizeof(int32_t), RADIX_SIGNED);
+        break;
+    case SORT_RADIX_INPLACE:
+        radixSortInPlace(s->work, s->n, sizeof(int32_t), RADIX_SIGNED);
+        break;
+    }
+}
+
+void sortTeardown(void* state) {
+    struct SortState* s = (struct SortState*)state;
+    for (size_t i = 1; i < s->n; i++)
+        if (s->work[i - 1] > s->work[i]) {
+            fprintf(stderr, "sort engine %d: output not sorted at %zu\n", s->engine, i);
+            exit(1);
+        }
+    free(s->original);
+    free(s->work);
+    free(s->scratch);
+    free(s);
+}
+
+// ---------- Graph cases ----------
+enum GraphEngine {
+    GRAPH_DIJKSTRA,      // param & 3 is the PQKind
+    GRAPH_BELLMAN_FORD = 4,  // + BFMode
+    GRAPH_MST = 8,       // + MSTMode
+    GRAPH_DAG = 12
+};
+
+struct GraphState {
+    int engine, V;
+    long long E;
+    struct CSREdge *edges, *work, *forest;
+    struct CSRGraph* g;
+    int *dist, *parent;
+    struct PriorityQueue q;
+};
+
+void* graphSetup(const struct BenchCase* c, size_t n) {
+    struct GraphState* s = (struct GraphState*)harnessAlloc(sizeof(struct GraphState));
+    s->engine = c->param;
+    s->V = n < 2 ? 2 : (int)n;
+    s->E = (long long)GRAPH_DEGREE * s->V;
+    s->edges = generateRandomEdges(s->V, s->E, GRAPH_MAX_WEIGHT);
+    s->work = s->forest = NULL;
+    s->g = NULL;
+    s->dist = (int*)harnessAlloc(s->V * sizeof(int));
+    s->parent = (int*)harnessAlloc(s->V * sizeof(int));
+
+    if (s->engine >= GRAPH_DAG) {
+        // Point every edge from the smaller to the larger id
+        for (long long i = 0; i < s->E; i++) {
+            struct CSREdge* e = &s->edges[i];
+            if (e->src == e->dest)
+                e->dest = e->src + 1 < s->V ? e->src + 1 : e->src - 1;
+            if (e->src > e->dest) {
+                int t = e->src;
+                e->src = e->dest;
+                e->dest = t;
+            }
+        }
+    }
+    if (s->engine >= GRAPH_MST && s->engine < GRAPH_DAG) {
+        s->work = (struct CSREdge*)harnessAlloc(s->E * sizeof(struct CSREdge));
+        s->forest = (struct CSREdge*)harnessAlloc(s->V * sizeof(struct CSREdge));
+    } else {
+        s->g = buildCSRGraph(s->V, s->edges, s->E);
+    }
+    if (s->engine < GRAPH_BELLMAN_FORD)
+        pqInit(&s->q, (enum PQKind)(s->engine & 3), GRAPH_MAX_WEIGHT);
+    return s;
+}
+
+void graphReset(void* state) {
+    struct GraphState* s = (struct GraphState*)state;
+    if (s->engine >= GRAPH_MST && s->engine < GRAPH_DAG) {
+        memcpy(s->work, s->edges, s->E * sizeof(struct CSREdge));
+    } else if (s->engine >= GRAPH_BELLMAN_FORD && s->engine < GRAPH_MST) {
+        for (int i = 0; i < s->V; i++)
+            s->dist[i] = BF_INF;
+        s->dist[0] = 0;
+    }
+}
+
+void graphRun(void* state) {
+    struct GraphState* s = (struct GraphState*)state;
+    if (s->engine < GRAPH_BELLMAN_FORD) {
+        dijkstraSSSP(s->g, 0, s->dist, s->parent, &s->q);
+    } else if (s->engine < GRAPH_MST) {
+        bellmanFordSSSP(s->g, s->dist, (enum BFMode)(s->engine & 3), NULL);
+    } else if (s->engine < GRAPH_DAG) {
+        long long total;
+        minimumSpanningForest(s->work, s->E, s->V, (enum MSTMode)(s->engine & 3), s->forest, &total);
+    } else {
+        int len;
+        dagCriticalPath(s->g, s->parent, &len);
+    }
+}
+
+void graphTeardown(void* state) {
+    struct GraphState* s = (struct GraphState*)state;
+    if (s->engine < GRAPH_BELLMAN_FORD)
+        pqFree(&s->q);
+    if (s->g)
+        freeCSRGraph(s->g);
+    free(s->edges);
+    free(s->work);
+    free(s->forest);
+    free(s->dist);
+    free(s->parent);
+    free(s);
+}
+
+// ---------- Knapsack cases ----------
+struct KnapsackState {
+    enum KnapsackMode mode;
+    int n;
+    long long *weight, *value;
+    unsigned char* take;
+};
+
+void* knapsackSetup(const struct BenchCase* c, size_t n) {
+    struct KnapsackState* s = (struct KnapsackState*)harnessAlloc(sizeof(struct KnapsackState));
+    s->mode = (enum KnapsackMode)c->param;
+    s->n = (int)n;
+    s->weight = (long long*)harnessAlloc(n * sizeof(long long));
+    s->value = (long long*)harnessAlloc(n * sizeof(long long));
+    s->take = (unsigned char*)harnessAlloc(n);
+    // Weakly correlated: values within 10% of the weight
+    for (size_t i = 0; i < n; i++) {
+        s->weight[i] = 1 + (long long)(xorshift64() % (KNAPSACK_W / 4));
+        s->value[i] = s->weight[i] + (long long)(xorshift64() % (KNAPSACK_W / 20 + 1)) - KNAPSACK_W / 40;
+        if (s->value[i] < 1)
+            s->value[i] = 1;
+    }
+    return s;
+}
+
+void knapsackRun(void* state) {
+    struct KnapsackState* s = (struct KnapsackState*)state;
+    knapsackOptimize(s->weight, s->value, s->n, KNAPSACK_W, s->mode, 0, s->take);
+}
+
+void knapsackTeardown(void* state) {
+    struct KnapsackState* s = (struct KnapsackState*)state;
+    long long weight = 0;
+    for (int i = 0; i < s->n; i++)
+        weight += s->take[i] ? s->weight[i] : 0;
+    if (weight > KNAPSACK_W) {
+        fprintf(stderr, "knapsack: chosen items weigh %lld > %d\n", weight, KNAPSACK_W);
+        exit(1);
+    }
+    free(s->weight);
+    free(s->value);
+    free(s->take);
+    free(s);
+}
+
+// ---------- Matrix chain cases ----------
+struct MatrixChainState {
+    enum MatrixChainMode mode;
+    int n;
+    long long* p;
+    struct MatrixChainPlan* plan;
+};
+
+void* matrixChainSetup(const struct BenchCase* c, size_t n) {
+    struct MatrixChainState* s = (struct MatrixChainState*)harnessAlloc(sizeof(struct MatrixChainState));
+    s->mode = (enum MatrixChainMode)c->param;
+    s->n = (int)n;
+    s->p = (long long*)harnessAlloc((n + 1) * sizeof(long long));
+    for (size_t i = 0; i <= n; i++)
+        s->p[i] = 1 + (long long)(xorshift64() % 100);
+    s->plan = NULL;
+    return s;
+}
+
+void matrixChainReset(void* state) {
+    struct MatrixChainState* s = (struct MatrixChainState*)state;
+    freeMatrixChainPlan(s->plan);
+    s->plan = NULL;
+}
+
+void matrixChainRun(void* state) {
+    struct MatrixChainState* s = (struct MatrixChainState*)state;
+    s->plan = buildMatrixChainPlan(s->p, s->n, s->mode);
+}
+
+void matrixChainTeardown(void* state) {
+    struct MatrixChainState* s = (struct MatrixChainState*)state;
+    if (matrixChainPlanCost(s->plan, s->p) != s->plan->cost) {
+        fprintf(stderr, "matrix chain: plan cost does not match\n");
+        exit(1);
+    }
+    freeMatrixChainPlan(s->plan);
+    free(s->p);
+    free(s);
+}
+
+// ---------- Huffman cases ----------
+enum HuffmanDirection {
+    HUFFMAN_ENCODE,
+    HUFFMAN_DECODE,
+    HUFFMAN_DECODE_STREAMS
+};
+
+struct HuffmanState {
+    enum HuffmanDirection direction;
+    int streams;
+    size_t n, len;
+    unsigned char *text, *packed, *back;
+};
+
+// English-like text, encoded once so that decode cases time decoding only
+void* huffmanSetup(const struct BenchCase* c, size_t n) {
+    struct HuffmanState* s = (struct HuffmanState*)harnessAlloc(sizeof(struct HuffmanState));
+    s->direction = (enum HuffmanDirection)c->param;
+    s->streams = s->direction == HUFFMAN_DECODE_STREAMS ? HUFFMAN_STREAMS : 1;
+    s->n = n;
+    s->text = (unsigned char*)harnessAlloc(n);
+    s->packed = (unsigned char*)harnessAlloc(huffmanMaxBlockSize(n));
+    s->back = (unsigned char*)harnessAlloc(n);
+    for (size_t i = 0; i < n; i++)
+        s->text[i] = (unsigned char)randomLetter();
+    s->len = huffmanEncodeBlock(s->text, n, s->packed, s->streams);
+    return s;
+}
+
+void huffmanRun(void* state) {
+    struct HuffmanState* s = (struct HuffmanState*)state;
+    if (s->direction == HUFFMAN_ENCODE)
+        s->len = huffmanEncodeBlock(s->text, s->n, s->packed, s->streams);
+    else if (huffmanDecodeBlock(s->packed, s->len, s->back, s->n, s->streams) != 0)
+        s->len = 0;
+}
+
+void huffmanTeardown(void* state) {
+    struct HuffmanState* s = (struct HuffmanState*)state;
+    if (huffmanDecodeBlock(s->packed, s->len, s->back, s->n, s->streams) != 0 || memcmp(s->text, s->back, s->n) != 0) {
+        fprintf(stderr, "huffman: round trip is not exact\n");
+        exit(1);
+    }
+    free(s->text);
+    free(s->packed);
+    free(s->back);
+    free(s);
+}
+
+// ---------- External programs ----------
+struct ExecState {
+    const struct BenchCase* c;
+    size_t n;
+    char input[PATH_MAX], output[PATH_MAX];
+    char* command;
+};
+
+// Writes n units of the requested kind to fd
+void writeExecInput(int fd, enum ExecInput kind, size_t n) {
+    char buffer[1 << 16];
+    size_t used = 0, total = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (used + INT_IO_MAX_CHARS > sizeof(buffer)) {
+            intWriteAll(fd, buffer, used, (off_t)total, "harness input");
+            total += used;
+            used = 0;
+        }
+        if (kind == INPUT_INTS) {
+            used += intFormat((int32_t)xorshift64(), buffer + used);
+        } else if (kind == INPUT_BYTES) {
+            buffer[used++] = (char)xorshift64();
+        } else {
+            buffer[used++] = randomLetter();
+        }
+    }
+    intWriteAll(fd, buffer, used, (off_t)total, "harness input");
+}
+
+// Copies command into a new string with {in}, {out} and {n} replaced
+char* expandCommand(const char* command, const char* in, const char* out, size_t n) {
+    char number[32];
+    snprintf(number, sizeof(number), "%zu", n);
+    size_t cap = strlen(command) + 1, len = 0;
+    for (const char* p = command; *p; p++)
+        if (*p == '{')
+            cap += strlen(in) + strlen(out) + strlen(number);
+    char* s = (char*)harnessAlloc(cap);
+    for (const char* p = command; *p;) {
+        const char* value = NULL;
+        size_t skip = 0;
+        if (strncmp(p, "{in}", 4) == 0)
+            value = in, skip = 4;
+        else if (strncmp(p, "{out}", 5) == 0)
+            value = out, skip = 5;
+        else if (strncmp(p, "{n}", 3) == 0)
+            value = number, skip = 3;
+        if (value) {
+            memcpy(s + len, value, strlen(value));
+            len += strlen(value);
+            p += skip;
+        } else {
+            s[len++] = *p++;
+        }
+    }
+    s[len] = '\0';
+    return s;
+}
+
+void* execSetup(const struct BenchCase* c, size_t n) {
+    struct ExecState* s = (struct ExecState*)harnessAlloc(sizeof(struct ExecState));
+    const char* dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    s->c = c;
+    s->n = n;
+    if (snprintf(s->input, sizeof(s->input), "%s/harness_in_XXXXXX", dir) >= (int)sizeof(s->input)
+        || snprintf(s->output, sizeof(s->output), "%s/harness_out_XXXXXX", dir) >= (int)sizeof(s->output)) {
+        fprintf(stderr, "Temporary directory name is too long: %s\n", dir);
+        exit(1);
+    }
+    int fd = mkstemp(s->input);
+    int outFd = mkstemp(s->output);
+    if (fd < 0 || outFd < 0) {
+        perror("Temporary file");
+        exit(1);
+    }
+    writeExecInput(fd, c->input, n);
+    close(fd);
+    close(outFd);
+    s->command = expandCommand(c->command, s->input, s->output, n);
+    return s;
+}
+
+void execTeardown(void* state) {
+    struct ExecState* s = (struct ExecState*)state;
+    unlink(s->input);
+    unlink(s->output);
+    free(s->command);
+    free(s);
+}
+
+// Runs the command under /bin/sh. The child waits on a pipe until the
+// counters are attached, so they cover exactly the exec'ed program.
+struct Sample execMeasure(struct ExecState* s) {
+    int gate[2];
+    if (pipe(gate) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    double t = nowSeconds();
+    long long tsc = readTSC();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        char go;
+        close(gate[1]);
+        if (read(gate[0], &go, 1) != 1)
+            _exit(127);
+        if (freopen("/dev/null", "w", stdout) == NULL)
+            _exit(127);
+        execl("/bin/sh", "sh", "-c", s->command, (char*)NULL);
+        _exit(127);
+    }
+
+    struct PerfCounters pc;
+    perfOpen(&pc, pid, 1);
+    close(gate[0]);
+    if (write(gate[1], "x", 1) != 1) {
+        perror("pipe");
+        exit(1);
+    }
+    close(gate[1]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    struct Sample sample;
+    sample.seconds = nowSeconds() - t;
+    perfCollect(&pc, &sample, tsc < 0 ? -1 : readTSC() - tsc);
+    perfClose(&pc);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "%s: command failed: %s\n", s->c->name, s->command);
+        exit(1);
+    }
+    return sample;
+}
+
+// ---------- Registry ----------
+struct BenchCase cases[HARNESS_MAX_CASES];
+int caseCount = 0;
+
+void addCase(const char* name, void* (*setup)(const struct BenchCase*, size_t), void (*reset)(void*),
+             void (*run)(void*), void (*teardown)(void*), int param) {
+    if (caseCount == HARNESS_MAX_CASES) {
+        fprintf(stderr, "Too many cases\n");
+        exit(1);
+    }
+    cases[caseCount++] = (struct BenchCase){name, setup, reset, run, teardown, param, NULL, INPUT_INTS};
+}
+
+void registerBuiltinCases(void) {
+    addCase("sort/qsort", sortSetup, sortReset, sortRun, sortTeardown, SORT_QSORT);
+    addCase("sort/introsort", sortSetup, sortReset, sortRun, sortTeardown, SORT_INTROSORT);
+    addCase("sort/radix-lsd", sortSetup, sortReset, sortRun, sortTeardown, SORT_RADIX_LSD);
+    addCase("sort/radix-parallel", sortSetup, sortReset, sortRun, sortTeardown, SORT_RADIX_PARALLEL);
+    addCase("sort/radix-inplace", sortSetup, sortReset, sortRun, sortTeardown, SORT_RADIX_INPLACE);
+
+    addCase("sssp/dijkstra-heap", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_DIJKSTRA + PQ_DARY_HEAP);
+    addCase("sssp/dijkstra-radix", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_DIJKSTRA + PQ_RADIX_HEAP);
+    addCase("sssp/dijkstra-dial", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_DIJKSTRA + PQ_DIAL_BUCKETS);
+    addCase("sssp/bellman-ford-early", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_BELLMAN_FORD + BF_EARLY_EXIT);
+    addCase("sssp/bellman-ford-spfa", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_BELLMAN_FORD + BF_SPFA);
+    addCase("sssp/bellman-ford-parallel", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_BELLMAN_FORD + BF_PARALLEL);
+    addCase("mst/kruskal", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_MST + MST_KRUSKAL);
+    addCase("mst/filter-kruskal", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_MST + MST_FILTER_KRUSKAL);
+    addCase("mst/boruvka", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_MST + MST_BORUVKA);
+    addCase("dag/critical-path", graphSetup, graphReset, graphRun, graphTeardown, GRAPH_DAG);
+    addCase("knapsack/dp", knapsackSetup, NULL, knapsackRun, knapsackTeardown, KNAPSACK_SEQUENTIAL);
+    addCase("knapsack/dp-parallel", knapsackSetup, NULL, knapsackRun, knapsackTeardown, KNAPSACK_PARALLEL);
+    addCase("knapsack/branch-bound", knapsackSetup, NULL, knapsackRun, knapsackTeardown, KNAPSACK_BRANCH_BOUND);
+    addCase("matrix-chain/dp", matrixChainSetup, matrixChainReset, matrixChainRun, matrixChainTeardown, MATRIX_CHAIN_DP);
+    addCase("matrix-chain/parallel", matrixChainSetup, matrixChainReset, matrixChainRun, matrixChainTeardown,
+            MATRIX_CHAIN_PARALLEL);
+    addCase("matrix-chain/hu-shing", matrixChainSetup, matrixChainReset, matrixChainRun, matrixChainTeardown,
+            MATRIX_CHAIN_HU_SHING);
+    addCase("huffman/encode", huffmanSetup, NULL, huffmanRun, huffmanTeardown, HUFFMAN_ENCODE);
+    addCase("huffman/decode", huffmanSetup, NULL, huffmanRun, huffmanTeardown, HUFFMAN_DECODE);
+    addCase("huffman/decode-4streams", huffmanSetup, NULL, huffmanRun, huffmanTeardown, HUFFMAN_DECODE_STREAMS);
+}
+
+// Parses name:input:command
+void addExecCase(char* spec) {
+    char* input = strchr(spec, ':');
+    char* command = input ? strchr(input + 1, ':') : NULL;
+    if (command == NULL) {
+        fprintf(stderr, "-x expects name:input:command, got \"%s\"\n", spec);
+        exit(1);
+    }
+    *input++ = '\0';
+    *command++ = '\0';
+    enum ExecInput kind;
+    if (strcmp(input, "ints") == 0)
+        kind = INPUT_INTS;
+    else if (strcmp(input, "text") == 0)
+        kind = INPUT_TEXT;
+    else if (strcmp(input, "bytes") == 0)
+        kind = INPUT_BYTES;
+    else {
+        fprintf(stderr, "Unknown input kind \"%s\" (ints, text, bytes)\n", input);
+        exit(1);
+    }
+    addCase(spec, execSetup, NULL, NULL, execTeardown, 0);
+    cases[caseCount - 1].command = command;
+    cases[caseCount - 1].input = kind;
+}
+
+// ---------- Measurement ----------
+int compareSamples(const void* a, const void* b) {
+    double x = ((const struct Sample*)a)->seconds, y = ((const struct Sample*)b)->seconds;
+    return (x > y) - (x < y);
+}
+
+// Runs r repetitions at size n; returns the median-time repetition
+struct Sample measure(const struct BenchCase* c, size_t n, int r) {
+    struct Sample samples[HARNESS_MAX_REPS];
+    void* state = c->setup(c, n);
+    for (int i = 0; i < r; i++) {
+        if (c->command) {
+            samples[i] = execMeasure((struct ExecState*)state);
+            continue;
+        }
+        if (c->reset)
+            c->reset(state);
+        long long tsc = readTSC();
+        perfStart(&selfCounters);
+        double t = nowSeconds();
+        c->run(state);
+        samples[i].seconds = nowSeconds() - t;
+        perfStop(&selfCounters);
+        perfCollect(&selfCounters, &samples[i], tsc < 0 ? -1 : readTSC() - tsc);
+    }
+    c->teardown(state);
+    qsort(samples, r, sizeof(struct Sample), compareSamples);
+    return samples[r / 2];
+}
+
+// Least-squares slope of log(seconds) against log(n) over points above the
+// noise floor; *r2 gets the coefficient of determination. NAN with fewer
+// than two usable points.
+double fitExponent(const struct Point* p, int count, double* r2) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+    int m = 0;
+    for (int i = 0; i < count; i++) {
+        if (p[i].s.seconds < HARNESS_MIN_FIT_SECONDS)
+            continue;
+        double x = log((double)p[i].n), y = log(p[i].s.seconds);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        syy += y * y;
+        m++;
+    }
+    *r2 = NAN;
+    if (m < 2 || m * sxx - sx * sx <= 0)
+        return NAN;
+    double k = (m * sxy - sx * sy) / (m * sxx - sx * sx);
+    double varY = m * syy - sy * sy;
+    if (varY > 0)
+        *r2 = k * k * (m * sxx - sx * sx) / varY;
+    return k;
+}
+
+// ---------- Output ----------
+enum Format {
+    FORMAT_TABLE,
+    FORMAT_CSV,
+    FORMAT_JSON
+};
+
+void printCounter(long long v, enum Format format) {
+    if (v >= 0)
+        printf("%lld", v);
+    else
+        printf(format == FORMAT_JSON ? "null" : format == FORMAT_CSV ? "" : "n/a");
+}
+
+void printNumber(double v, enum Format format) {
+    if (isnan(v))
+        printf(format == FORMAT_JSON ? "null" : format == FORMAT_CSV ? "" : "n/a");
+    else
+        printf("%.4f", v);
+}
+
+void printCase(const struct BenchCase* c, const struct Point* p, int count, enum Format format,
+               const char* cycleSource, int first) {
+    double r2, k = fitExponent(p, count, &r2);
+
+    if (format == FORMAT_CSV) {
+        for (int i = 0; i < count; i++) {
+            printf("%s,%zu,%.9f,", c->name, p[i].n, p[i].s.seconds);
+            printCounter(p[i].s.cycles, format);
+            printf(",%s,", cycleSource);
+            printCounter(p[i].s.instructions, format);
+            printf(",");
+            printCounter(p[i].s.cacheMisses, format);
+            printf(",");
+            printCounter(p[i].s.branchMisses, format);
+            printf(",");
+            printNumber(k, format);
+            printf(",");
+            printNumber(r2, format);
+            printf("\n");
+        }
+    } else if (format == FORMAT_JSON) {
+        printf("%s\n    {\"name\": \"%s\", \"exponent\": ", first ? "" : ",", c->name);
+        printNumber(k, format);
+        printf(", \"r2\": ");
+        printNumber(r2, format);
+        printf(", \"cycle_source\": \"%s\", \"points\": [", cycleSource);
+        for (int i = 0; i < count; i++) {
+            printf("%s\n      {\"n\": %zu, \"seconds\": %.9f, \"cycles\": ", i ? "," : "", p[i].n, p[i].s.seconds);
+            printCounter(p[i].s.cycles, format);
+            printf(", \"instructions\": ");
+            printCounter(p[i].s.instructions, format);
+            printf(", \"cache_misses\": ");
+            printCounter(p[i].s.cacheMisses, format);
+            printf(", \"branch_misses\": ");
+            printCounter(p[i].s.branchMisses, format);
+            printf("}");
+        }
+        printf("\n    ]}");
+    } else {
+        printf("%s  (time ~ n^", c->name);
+        printNumber(k, format);
+        printf(", R^2 ");
+        printNumber(r2, format);
+        printf(")\n");
+        printf("  %12s %12s %10s %16s %16s %14s %14s\n", "n", "seconds", "ns/n", cycleSource,
+               "instructions", "cache-misses", "branch-misses");
+        for (int i = 0; i < count; i++) {
+            printf("  %12zu %12.6f %10.2f ", p[i].n, p[i].s.seconds, p[i].s.seconds * 1e9 / p[i].n);
+            long long v[4] = {p[i].s.cycles, p[i].s.instructions, p[i].s.cacheMisses, p[i].s.branchMisses};
+            for (int j = 0; j < 4; j++) {
+                if (v[j] >= 0)
+                    printf(j == 0 || j == 1 ? "%16lld " : "%14lld ", v[j]);
+                else
+                    printf(j == 0 || j == 1 ? "%16s " : "%14s ", "n/a");
+            }
+            printf("\n");
+        }
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+void usage(const char* program) {
+    printf("Usage: %s [-l] [-k pattern] [-n min max] [-f factor] [-r reps] [-t seconds]\n"
+           "          [-x name:ints|text|bytes:command]... [-csv | -json]\n", program);
+    exit(1);
+}
+
+int main(int argc, char* argv[]) {
+    size_t minN = 1 << 12, maxN = 1 << 20;
+    double factor = 2, limit = 2;
+    int reps = 5, list = 0;
+    const char* pattern = NULL;
+    enum Format format = FORMAT_TABLE;
+
+    registerBuiltinCases();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0)
+            list = 1;
+        else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+            pattern = argv[++i];
+        else if (strcmp(argv[i], "-n") == 0 && i + 2 < argc) {
+            minN = strtoull(argv[++i], NULL, 10);
+            maxN = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+            factor = atof(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            reps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            limit = atof(argv[++i]);
+        else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+            addExecCase(argv[++i]);
+        else if (strcmp(argv[i], "-csv") == 0)
+            format = FORMAT_CSV;
+        else if (strcmp(argv[i], "-json") == 0)
+            format = FORMAT_JSON;
+        else
+            usage(argv[0]);
+    }
+    if (minN < 1 || maxN < minN || factor <= 1 || reps < 1 || reps > HARNESS_MAX_REPS)
+        usage(argv[0]);
+
+    if (list) {
+        for (int c = 0; c < caseCount; c++)
+            printf("%s\n", cases[c].name);
+        return 0;
+    }
+
+    // Open before any OpenMP region so later worker threads inherit them
+    perfOpen(&selfCounters, 0, 0);
+    const char* cycleSource = perfAvailable(&selfCounters) ? "cycles" : readTSC() >= 0 ? "tsc" : "none";
+    if (!perfAvailable(&selfCounters))
+        fprintf(stderr, "perf_event_open unavailable: hardware counters disabled, cycles from %s\n",
+                cycleSource);
+
+    if (format == FORMAT_CSV)
+        printf("case,n,seconds,cycles,cycle_source,instructions,cache_misses,branch_misses,exponent,r2\n");
+    else if (format == FORMAT_JSON)
+        printf("{\"reps\": %d, \"cases\": [", reps);
+
+    int printed = 0;
+    for (int c = 0; c < caseCount; c++) {
+        if (pattern && strstr(cases[c].name, pattern) == NULL)
+            continue;
+        struct Point points[HARNESS_MAX_POINTS];
+        int count = 0;
+        for (double x = (double)minN; x <= (double)maxN * (1 + 1e-9) && count < HARNESS_MAX_POINTS; x *= factor) {
+            size_t n = (size_t)(x + 0.5);
+            if (count > 0 && n == points[count - 1].n)
+                continue;
+            points[count].n = n;
+            points[count].s = measure(&cases[c], n, reps);
+            if (points[count++].s.seconds > limit)
+                break;
+        }
+        printCase(&cases[c], points, count, format, cycleSource, printed++ == 0);
+    }
+
+    if (format == FORMAT_JSON)
+        printf("\n]}\n");
+    perfClose(&selfCounters);
+    return 0;
+}
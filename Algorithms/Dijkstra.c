@@ -1,231 +1,412 @@
 // K Shortest Paths using Dijkstra + Yen's Algorithm
 // Advanced CLRS book style implementation
+//
+// Spur searches never copy the graph: removed edges and root-path vertices
+// are masked out with per-thread bitsets, and each search is a heap-based
+// Dijkstra that stops as soon as the destination is settled. The spur
+// searches of one iteration are independent and run in parallel.
+//
+// gcc -O2 -fopenmp Dijkstra.c -o dijkstra
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
 #include <string.h>
 
-#define INF INT_MAX
-#define MAXV 100
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-struct Edge {
-    int dest;
-    int weight;
-    struct Edge* next;
-};
+#include "../Graph/csr_graph_file.h"
+#include "../Graph/priority_queue.h"
 
-struct Graph {
-    int V;
-    struct Edge** adj;
-};
+#define INF INT_MAX
 
 struct Path {
-    int cost;
-    int vertices[MAXV];
+    long long cost;
+    int* vertices;
     int len;
+    unsigned long long hash;
+};
+
+// ---------- Bitsets ----------
+static inline void bitSet(unsigned long long* bits, long long i) {
+    bits[i >> 6] |= 1ULL << (i & 63);
+}
+
+static inline void bitClear(unsigned long long* bits, long long i) {
+    bits[i >> 6] &= ~(1ULL << (i & 63));
+}
+
+static inline int bitTest(const unsigned long long* bits, long long i) {
+    return (bits[i >> 6] >> (i & 63)) & 1;
+}
+
+// ---------- Per-thread spur search workspace ----------
+// dist[] stays INF between searches: only the touched vertices are reset,
+// and only the mask bits that were set are cleared again.
+struct SpurWorkspace {
+    int* dist;
+    int* parent;
+    int* touched;
+    int nTouched;
+    unsigned long long* vertexMask;
+    unsigned long long* edgeMask;
+    long long* maskedEdges;
+    long long nMaskedEdges, maskedCapacity;
+    struct PriorityQueue queue;
 };
 
-struct Graph* createGraph(int V) {
-    struct Graph* graph = malloc(sizeof(struct Graph));
-    graph->V = V;
-    graph->adj = malloc(V * sizeof(struct Edge*));
-    for (int i = 0; i < V; i++)
-        graph->adj[i] = NULL;
-    return graph;
-}
-
-void addEdge(struct Graph* graph, int src, int dest, int weight) {
-    struct Edge* e = malloc(sizeof(struct Edge));
-    e->dest = dest;
-    e->weight = weight;
-    e->next = graph->adj[src];
-    graph->adj[src] = e;
-}
-
-// ---------- Simple Dijkstra to compute one shortest path ----------
-void dijkstra(struct Graph* g, int src, int dest, int* dist, int* parent) {
-    int V = g->V;
-    int visited[V];
-    for (int i = 0; i < V; i++) {
-        dist[i] = INF;
-        parent[i] = -1;
-        visited[i] = 0;
+void initWorkspace(struct SpurWorkspace* w, const struct CSRGraph* g, int maxW) {
+    w->dist = (int*)csrAlloc(g->V * sizeof(int));
+    w->parent = (int*)csrAlloc(g->V * sizeof(int));
+    w->touched = (int*)csrAlloc(g->V * sizeof(int));
+    w->nTouched = 0;
+    for (int i = 0; i < g->V; i++)
+        w->dist[i] = INF;
+    w->vertexMask = (unsigned long long*)calloc((g->V + 63) / 64 + 1, sizeof(unsigned long long));
+    w->edgeMask = (unsigned long long*)calloc((g->E + 63) / 64 + 1, sizeof(unsigned long long));
+    w->maskedCapacity = 16;
+    w->nMaskedEdges = 0;
+    w->maskedEdges = (long long*)csrAlloc(w->maskedCapacity * sizeof(long long));
+    pqInit(&w->queue, PQ_DARY_HEAP, maxW);
+}
+
+void freeWorkspace(struct SpurWorkspace* w) {
+    free(w->dist);
+    free(w->parent);
+    free(w->touched);
+    free(w->vertexMask);
+    free(w->edgeMask);
+    free(w->maskedEdges);
+    pqFree(&w->queue);
+}
+
+void maskEdge(struct SpurWorkspace* w, long long e) {
+    if (bitTest(w->edgeMask, e))
+        return;
+    if (w->nMaskedEdges == w->maskedCapacity) {
+        w->maskedCapacity *= 2;
+        w->maskedEdges = (long long*)realloc(w->maskedEdges, w->maskedCapacity * sizeof(long long));
     }
-    dist[src] = 0;
-
-    for (int count = 0; count < V - 1; count++) {
-        int u = -1;
-        int min = INF;
-        for (int v = 0; v < V; v++)
-            if (!visited[v] && dist[v] <= min) {
-                min = dist[v];
-                u = v;
-            }
+    w->maskedEdges[w->nMaskedEdges++] = e;
+    bitSet(w->edgeMask, e);
+}
+
+// ---------- Dijkstra from src to dest, skipping masked edges/vertices ----------
+// Returns dist(src, dest) or INF; parent[] describes the path afterwards.
+int dijkstra(const struct CSRGraph* g, struct SpurWorkspace* w, int src, int dest) {
+    for (int i = 0; i < w->nTouched; i++)
+        w->dist[w->touched[i]] = INF;
+    w->nTouched = 0;
 
-        if (u == -1) break;
-        visited[u] = 1;
+    pqClear(&w->queue);
+    w->dist[src] = 0;
+    w->parent[src] = -1;
+    w->touched[w->nTouched++] = src;
+    pqPush(&w->queue, 0, src);
 
-        struct Edge* e = g->adj[u];
-        while (e) {
-            int v = e->dest;
-            if (!visited[v] && dist[u] != INF && dist[u] + e->weight < dist[v]) {
-                dist[v] = dist[u] + e->weight;
-                parent[v] = u;
+    while (!pqEmpty(&w->queue)) {
+        struct PQItem top = pqPop(&w->queue);
+        int u = top.v;
+        if ((int)top.key != w->dist[u])
+            continue;
+        if (u == dest)
+            return w->dist[u];
+
+        for (long long i = g->offset[u]; i < g->offset[u + 1]; i++) {
+            int v = g->dest[i];
+            if (bitTest(w->edgeMask, i) || bitTest(w->vertexMask, v))
+                continue;
+            int nd = w->dist[u] + g->weight[i];
+            if (nd < w->dist[v]) {
+                if (w->dist[v] == INF)
+                    w->touched[w->nTouched++] = v;
+                w->dist[v] = nd;
+                w->parent[v] = u;
+                pqPush(&w->queue, (unsigned)nd, v);
             }
-            e = e->next;
         }
     }
+    return INF;
 }
 
-// ---------- Reconstruct path from parent array ----------
-struct Path buildPath(int* parent, int src, int dest, int dist) {
-    struct Path p;
-    p.len = 0;
-    p.cost = dist;
-    int v = dest;
-    while (v != -1) {
-        p.vertices[p.len++] = v;
-        if (v == src) break;
-        v = parent[v];
-    }
-    // reverse
-    for (int i = 0; i < p.len / 2; i++) {
-        int tmp = p.vertices[i];
-        p.vertices[i] = p.vertices[p.len - 1 - i];
-        p.vertices[p.len - 1 - i] = tmp;
+// ---------- Path helpers ----------
+unsigned long long hashVertices(const int* v, int len) {
+    unsigned long long h = 1469598103934665603ULL;  // FNV-1a over the vertex ids
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned)v[i];
+        h *= 1099511628211ULL;
     }
+    return h;
+}
+
+// Lightest edge u -> v (parallel edges are allowed)
+int edgeWeight(const struct CSRGraph* g, int u, int v) {
+    int best = INF;
+    for (long long i = g->offset[u]; i < g->offset[u + 1]; i++)
+        if (g->dest[i] == v && g->weight[i] < best)
+            best = g->weight[i];
+    return best;
+}
+
+// root[0..rootLen) followed by the parent chain spur -> dest without spur itself
+struct Path* buildPath(const int* root, int rootLen, long long rootCost,
+                       const int* parent, int dest, int spurDist) {
+    int spurLen = 0;
+    for (int v = dest; v != -1; v = parent[v])
+        spurLen++;
+
+    struct Path* p = (struct Path*)csrAlloc(sizeof(struct Path));
+    p->len = rootLen + spurLen - 1;
+    p->vertices = (int*)csrAlloc(p->len * sizeof(int));
+    p->cost = rootCost + spurDist;
+    memcpy(p->vertices, root, rootLen * sizeof(int));
+    int k = p->len - 1;
+    for (int v = dest; parent[v] != -1; v = parent[v])
+        p->vertices[k--] = v;
+    p->hash = hashVertices(p->vertices, p->len);
     return p;
 }
 
+void freePath(struct Path* p) {
+    free(p->vertices);
+    free(p);
+}
+
 // ---------- Print a path ----------
-void printPath(struct Path p) {
-    printf("Cost = %d, Path: ", p.cost);
-    for (int i = 0; i < p.len; i++)
-        printf("%d%s", p.vertices[i], (i == p.len - 1 ? "\n" : " -> "));
+void printPath(const struct Path* p) {
+    printf("Cost = %lld, Path: ", p->cost);
+    for (int i = 0; i < p->len; i++)
+        printf("%d%s", p->vertices[i], (i == p->len - 1 ? "\n" : " -> "));
+}
+
+// ---------- Candidate set: min-heap on (cost, length) plus a hash set ----------
+struct CandidateSet {
+    struct Path** heap;
+    int size, capacity;
+    struct Path** seen;          // open addressing, every path ever accepted
+    long long nSeen, seenCapacity;
+};
+
+int pathLess(const struct Path* a, const struct Path* b) {
+    return a->cost < b->cost || (a->cost == b->cost && a->len < b->len);
+}
+
+int samePath(const struct Path* a, const struct Path* b) {
+    return a->hash == b->hash && a->len == b->len
+        && memcmp(a->vertices, b->vertices, a->len * sizeof(int)) == 0;
+}
+
+// Inserts p into the seen set; returns 0 if an identical path was already there
+int rememberPath(struct CandidateSet* c, struct Path* p) {
+    if (2 * (c->nSeen + 1) > c->seenCapacity) {
+        long long oldCapacity = c->seenCapacity;
+        struct Path** old = c->seen;
+        c->seenCapacity = oldCapacity ? 2 * oldCapacity : 64;
+        c->seen = (struct Path**)calloc(c->seenCapacity, sizeof(struct Path*));
+        for (long long i = 0; i < oldCapacity; i++) {
+            if (!old[i])
+                continue;
+            long long j = old[i]->hash & (c->seenCapacity - 1);
+            while (c->seen[j])
+                j = (j + 1) & (c->seenCapacity - 1);
+            c->seen[j] = old[i];
+        }
+        free(old);
+    }
+    long long j = p->hash & (c->seenCapacity - 1);
+    while (c->seen[j]) {
+        if (samePath(c->seen[j], p))
+            return 0;
+        j = (j + 1) & (c->seenCapacity - 1);
+    }
+    c->seen[j] = p;
+    c->nSeen++;
+    return 1;
+}
+
+void pushCandidate(struct CandidateSet* c, struct Path* p) {
+    if (c->size == c->capacity) {
+        c->capacity = c->capacity ? 2 * c->capacity : 64;
+        c->heap = (struct Path**)realloc(c->heap, c->capacity * sizeof(struct Path*));
+    }
+    int i = c->size++;
+    while (i > 0 && pathLess(p, c->heap[(i - 1) / 2])) {
+        c->heap[i] = c->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    c->heap[i] = p;
+}
+
+struct Path* popCandidate(struct CandidateSet* c) {
+    struct Path* top = c->heap[0];
+    struct Path* last = c->heap[--c->size];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= c->size)
+            break;
+        if (child + 1 < c->size && pathLess(c->heap[child + 1], c->heap[child]))
+            child++;
+        if (!pathLess(c->heap[child], last))
+            break;
+        c->heap[i] = c->heap[child];
+        i = child;
+    }
+    c->heap[i] = last;
+    return top;
 }
 
 // ---------- Yen's K Shortest Paths ----------
-void yenKShortest(struct Graph* g, int src, int dest, int K) {
-    int dist[MAXV], parent[MAXV];
-    struct Path A[K];   // shortest paths
-    struct Path B[K*MAXV]; // potential next paths
-    int Bcount = 0;
+void yenKShortest(const struct CSRGraph* g, int src, int dest, int K) {
+    int minW, maxW;
+    csrWeightRange(g, &minW, &maxW);
+    if (minW < 0) {
+        printf("Dijkstra requires non-negative edge weights (found %d).\n", minW);
+        return;
+    }
+
+    int nThreads = 1;
+#ifdef _OPENMP
+    nThreads = omp_get_max_threads();
+#endif
+    struct SpurWorkspace* work = (struct SpurWorkspace*)csrAlloc(nThreads * sizeof(struct SpurWorkspace));
+    for (int t = 0; t < nThreads; t++)
+        initWorkspace(&work[t], g, maxW);
+
+    struct Path** A = (struct Path**)csrAlloc(K * sizeof(struct Path*));  // shortest paths
+    struct CandidateSet B = {NULL, 0, 0, NULL, 0, 0};                    // potential next paths
 
     // First shortest path
-    dijkstra(g, src, dest, dist, parent);
-    if (dist[dest] == INF) {
+    int d = dijkstra(g, &work[0], src, dest);
+    if (d == INF) {
         printf("No path found.\n");
+        for (int t = 0; t < nThreads; t++)
+            freeWorkspace(&work[t]);
+        free(work);
+        free(A);
         return;
     }
-    A[0] = buildPath(parent, src, dest, dist[dest]);
+    A[0] = buildPath(&src, 1, 0, work[0].parent, dest, d);
+    rememberPath(&B, A[0]);
     printf("1st shortest path:\n");
     printPath(A[0]);
 
     int Acnt = 1;
+    long long* rootCost = NULL;
+    struct Path** spur = NULL;
+
     // Generate up to K paths
     for (int k = 1; k < K; k++) {
-        Bcount = 0;
-        for (int i = 0; i < A[k - 1].len - 1; i++) {
-            int spurNode = A[k - 1].vertices[i];
-            struct Graph* gCopy = createGraph(g->V);
-
-            // Copy graph
-            for (int u = 0; u < g->V; u++) {
-                struct Edge* e = g->adj[u];
-                while (e) {
-                    struct Edge* ne = malloc(sizeof(struct Edge));
-                    *ne = *e;
-                    ne->next = gCopy->adj[u];
-                    gCopy->adj[u] = ne;
-                    e = e->next;
-                }
-            }
+        const struct Path* last = A[k - 1];
+        int nSpurs = last->len - 1;
+
+        rootCost = (long long*)realloc(rootCost, last->len * sizeof(long long));
+        spur = (struct Path**)realloc(spur, (nSpurs > 0 ? nSpurs : 1) * sizeof(struct Path*));
+        rootCost[0] = 0;
+        for (int i = 1; i < last->len; i++)
+            rootCost[i] = rootCost[i - 1] + edgeWeight(g, last->vertices[i - 1], last->vertices[i]);
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < nSpurs; i++) {
+            int t = 0;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+#endif
+            struct SpurWorkspace* w = &work[t];
+            int spurNode = last->vertices[i];
 
             // Remove edges in previous paths that share the same root
             for (int j = 0; j < Acnt; j++) {
-                int match = 1;
-                for (int m = 0; m <= i; m++) {
-                    if (A[j].vertices[m] != A[k - 1].vertices[m]) {
-                        match = 0;
-                        break;
-                    }
-                }
-                if (match && i + 1 < A[j].len) {
-                    int u = A[j].vertices[i];
-                    int v = A[j].vertices[i + 1];
-                    // remove edge u->v
-                    struct Edge** ptr = &gCopy->adj[u];
-                    while (*ptr) {
-                        if ((*ptr)->dest == v) {
-                            *ptr = (*ptr)->next;
-                            break;
-                        }
-                        ptr = &((*ptr)->next);
-                    }
-                }
+                if (A[j]->len <= i + 1
+                    || memcmp(A[j]->vertices, last->vertices, (i + 1) * sizeof(int)) != 0)
+                    continue;
+                int u = A[j]->vertices[i];
+                int v = A[j]->vertices[i + 1];
+                for (long long e = g->offset[u]; e < g->offset[u + 1]; e++)
+                    if (g->dest[e] == v)
+                        maskEdge(w, e);
             }
+            // Remove the root path vertices so spur paths stay loopless
+            for (int m = 0; m < i; m++)
+                bitSet(w->vertexMask, last->vertices[m]);
 
-            // Run Dijkstra from spurNode
-            dijkstra(gCopy, spurNode, dest, dist, parent);
-            if (dist[dest] != INF) {
-                struct Path spur = buildPath(parent, spurNode, dest, dist[dest]);
-
-                struct Path root = A[k - 1];
-                struct Path total;
-                total.len = 0;
-                total.cost = 0;
-
-                // Combine root + spur
-                for (int t = 0; t <= i; t++)
-                    total.vertices[total.len++] = root.vertices[t];
-                for (int t = 1; t < spur.len; t++)
-                    total.vertices[total.len++] = spur.vertices[t];
-
-                total.cost = 0;
-                for (int t = 0; t < total.len - 1; t++) {
-                    struct Edge* e = g->adj[total.vertices[t]];
-                    while (e && e->dest != total.vertices[t + 1])
-                        e = e->next;
-                    if (e)
-                        total.cost += e->weight;
-                }
-
-                B[Bcount++] = total;
-            }
+            int sd = dijkstra(g, w, spurNode, dest);
+            spur[i] = sd == INF ? NULL
+                                : buildPath(last->vertices, i + 1, rootCost[i], w->parent, dest, sd);
 
-            free(gCopy->adj);
-            free(gCopy);
+            for (int m = 0; m < i; m++)
+                bitClear(w->vertexMask, last->vertices[m]);
+            for (long long e = 0; e < w->nMaskedEdges; e++)
+                bitClear(w->edgeMask, w->maskedEdges[e]);
+            w->nMaskedEdges = 0;
         }
 
-        if (Bcount == 0) break;
+        for (int i = 0; i < nSpurs; i++) {
+            if (!spur[i])
+                continue;
+            if (rememberPath(&B, spur[i]))
+                pushCandidate(&B, spur[i]);
+            else
+                freePath(spur[i]);
+        }
 
-        // Find the minimal cost in B[]
-        int minIdx = 0;
-        for (int i = 1; i < Bcount; i++)
-            if (B[i].cost < B[minIdx].cost)
-                minIdx = i;
+        if (B.size == 0) break;
 
-        A[Acnt++] = B[minIdx];
+        A[Acnt++] = popCandidate(&B);
         printf("%dth shortest path:\n", k + 1);
         printPath(A[Acnt - 1]);
     }
+
+    // Every accepted path (in A or still in B) is owned by the seen set
+    for (long long i = 0; i < B.seenCapacity; i++)
+        if (B.seen[i])
+            freePath(B.seen[i]);
+    free(B.seen);
+    free(B.heap);
+    free(spur);
+    free(rootCost);
+    free(A);
+    for (int t = 0; t < nThreads; t++)
+        freeWorkspace(&work[t]);
+    free(work);
 }
 
 // ---------- Example ----------
-int main() {
-    struct Graph* g = createGraph(6);
-    addEdge(g, 0, 1, 7);
-    addEdge(g, 0, 2, 9);
-    addEdge(g, 0, 5, 14);
-    addEdge(g, 1, 2, 10);
-    addEdge(g, 1, 3, 15);
-    addEdge(g, 2, 3, 11);
-    addEdge(g, 2, 5, 2);
-    addEdge(g, 3, 4, 6);
-    addEdge(g, 4, 5, 9);
-
+// ./dijkstra                          built-in CLRS-style example
+// ./dijkstra graph.csr src dest K     graph from Graph/Graph_Converter.c
+int main(int argc, char* argv[]) {
+    struct CSRGraph* g;
     int src = 0, dest = 4, K = 3;
+
+    if (argc == 5) {
+        g = loadCSRGraphFile(argv[1]);
+        if (!g)
+            return 1;
+        src = atoi(argv[2]);
+        dest = atoi(argv[3]);
+        K = atoi(argv[4]);
+        if (src < 0 || src >= g->V || dest < 0 || dest >= g->V || K < 1) {
+            printf("Invalid source, destination or K.\n");
+            freeCSRGraph(g);
+            return 1;
+        }
+    } else if (argc == 1) {
+        struct CSREdge edges[] = {
+            {0, 1, 7}, {0, 2, 9}, {0, 5, 14},
+            {1, 2, 10}, {1, 3, 15},
+            {2, 3, 11}, {2, 5, 2},
+            {3, 4, 6},
+            {4, 5, 9}
+        };
+        g = buildCSRGraph(6, edges, sizeof(edges) / sizeof(edges[0]));
+    } else {
+        printf("Usage: %s [graph.csr src dest K]\n", argv[0]);
+        return 1;
+    }
+
     yenKShortest(g, src, dest, K);
+    freeCSRGraph(g);
     return 0;
 }
@@ -5,170 +5,43 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
-#include <stdbool.h>
-
-// ---------- Graph Representation ----------
-struct Edge {
-    int dest, weight;
-    struct Edge* next;
-};
-
-struct Graph {
-    int V;
-    struct Edge** adj;
-};
-
-struct Edge* newEdge(int dest, int weight) {
-    struct Edge* e = (struct Edge*)malloc(sizeof(struct Edge));
-    e->dest = dest;
-    e->weight = weight;
-    e->next = NULL;
-    return e;
-}
-
-struct Graph* createGraph(int V) {
-    struct Graph* graph = (struct Graph*)malloc(sizeof(struct Graph));
-    graph->V = V;
-    graph->adj = (struct Edge**)malloc(V * sizeof(struct Edge*));
-    for (int i = 0; i < V; i++)
-        graph->adj[i] = NULL;
-    return graph;
-}
-
-void addEdge(struct Graph* graph, int src, int dest, int weight) {
-    struct Edge* e = newEdge(dest, weight);
-    e->next = graph->adj[src];
-    graph->adj[src] = e;
-}
-
-// ---------- Min-Heap (Priority Queue) ----------
-struct MinHeapNode {
-    int v;
-    int dist;
-};
-
-struct MinHeap {
-    int size;
-    int capacity;
-    int* pos;
-    struct MinHeapNode** array;
-};
-
-struct MinHeapNode* newMinHeapNode(int v, int dist) {
-    struct MinHeapNode* node = (struct MinHeapNode*)malloc(sizeof(struct MinHeapNode));
-    node->v = v;
-    node->dist = dist;
-    return node;
-}
-
-struct MinHeap* createMinHeap(int capacity) {
-    struct MinHeap* heap = (struct MinHeap*)malloc(sizeof(struct MinHeap));
-    heap->pos = (int*)malloc(capacity * sizeof(int));
-    heap->size = 0;
-    heap->capacity = capacity;
-    heap->array = (struct MinHeapNode**)malloc(capacity * sizeof(struct MinHeapNode*));
-    return heap;
-}
-
-void swapMinHeapNode(struct MinHeapNode** a, struct MinHeapNode** b) {
-    struct MinHeapNode* t = *a;
-    *a = *b;
-    *b = t;
-}
-
-void minHeapify(struct MinHeap* heap, int idx) {
-    int smallest = idx;
-    int left = 2 * idx + 1;
-    int right = 2 * idx + 2;
-
-    if (left < heap->size && heap->array[left]->dist < heap->array[smallest]->dist)
-        smallest = left;
-
-    if (right < heap->size && heap->array[right]->dist < heap->array[smallest]->dist)
-        smallest = right;
-
-    if (smallest != idx) {
-        struct MinHeapNode* smallestNode = heap->array[smallest];
-        struct MinHeapNode* idxNode = heap->array[idx];
-
-        heap->pos[smallestNode->v] = idx;
-        heap->pos[idxNode->v] = smallest;
-
-        swapMinHeapNode(&heap->array[smallest], &heap->array[idx]);
-        minHeapify(heap, smallest);
-    }
-}
-
-int isEmpty(struct MinHeap* heap) {
-    return heap->size == 0;
-}
-
-struct MinHeapNode* extractMin(struct MinHeap* heap) {
-    if (isEmpty(heap))
-        return NULL;
-
-    struct MinHeapNode* root = heap->array[0];
-    struct MinHeapNode* lastNode = heap->array[heap->size - 1];
-    heap->array[0] = lastNode;
-
-    heap->pos[root->v] = heap->size - 1;
-    heap->pos[lastNode->v] = 0;
-
-    heap->size--;
-    minHeapify(heap, 0);
-
-    return root;
-}
-
-void decreaseKey(struct MinHeap* heap, int v, int dist) {
-    int i = heap->pos[v];
-    heap->array[i]->dist = dist;
-
-    while (i && heap->array[i]->dist < heap->array[(i - 1) / 2]->dist) {
-        heap->pos[heap->array[i]->v] = (i - 1) / 2;
-        heap->pos[heap->array[(i - 1) / 2]->v] = i;
-        swapMinHeapNode(&heap->array[i], &heap->array[(i - 1) / 2]);
-        i = (i - 1) / 2;
-    }
-}
-
-bool isInMinHeap(struct MinHeap* heap, int v) {
-    return heap->pos[v] < heap->size;
+#include <string.h>
+
+#include "../Graph/csr_graph_file.h"
+#include "../Graph/sssp.h"
+
+// ---------- Priority queue selection ----------
+// The queue lives in Graph/priority_queue.h: a flat 4-ary heap of (dist, v)
+// pairs, a radix heap, or Dial's buckets for small integer weights.
+int parseQueueKind(const char* name, enum PQKind* kind) {
+    if (strcmp(name, "heap") == 0)
+        *kind = PQ_DARY_HEAP;
+    else if (strcmp(name, "radix") == 0)
+        *kind = PQ_RADIX_HEAP;
+    else if (strcmp(name, "dial") == 0)
+        *kind = PQ_DIAL_BUCKETS;
+    else
+        return 0;
+    return 1;
 }
 
 // ---------- Dijkstra Algorithm ----------
-void dijkstra(struct Graph* graph, int src) {
+void dijkstra(const struct CSRGraph* graph, int src, enum PQKind kind) {
     int V = graph->V;
-    int dist[V];
-
-    struct MinHeap* heap = createMinHeap(V);
-
-    for (int v = 0; v < V; ++v) {
-        dist[v] = INT_MAX;
-        heap->array[v] = newMinHeapNode(v, dist[v]);
-        heap->pos[v] = v;
+    int minW, maxW;
+    csrWeightRange(graph, &minW, &maxW);
+    if (minW < 0) {
+        printf("Dijkstra requires non-negative edge weights (found %d).\n", minW);
+        return;
     }
 
-    heap->array[src] = newMinHeapNode(src, dist[src]);
-    heap->pos[src] = src;
-    dist[src] = 0;
-    decreaseKey(heap, src, dist[src]);
-    heap->size = V;
+    int* dist = (int*)csrAlloc(V * sizeof(int));
+    struct PriorityQueue queue;
+    pqInit(&queue, kind, maxW);
+    if (queue.kind != kind)
+        printf("Weights up to %d need too many buckets; using the %s.\n", maxW, pqKindName(queue.kind));
 
-    while (!isEmpty(heap)) {
-        struct MinHeapNode* minNode = extractMin(heap);
-        int u = minNode->v;
-
-        struct Edge* e = graph->adj[u];
-        while (e != NULL) {
-            int v = e->dest;
-            if (isInMinHeap(heap, v) && dist[u] != INT_MAX && e->weight + dist[u] < dist[v]) {
-                dist[v] = dist[u] + e->weight;
-                decreaseKey(heap, v, dist[v]);
-            }
-            e = e->next;
-        }
-    }
+    dijkstraSSSP(graph, src, dist, NULL, &queue);
 
     printf("Vertex\tDistance from Source %d\n", src);
     for (int i = 0; i < V; ++i) {
@@ -177,28 +50,49 @@ void dijkstra(struct Graph* graph, int src) {
         else
             printf("%d\t%d\n", i, dist[i]);
     }
+    pqFree(&queue);
+    free(dist);
 }
 
 // ---------- Example ----------
-int main() {
-    int V = 9;
-    struct Graph* graph = createGraph(V);
+// ./dijkstra_heap                                   built-in CLRS Figure 24.6 example
+// ./dijkstra_heap graph.csr [src] [heap|radix|dial]  graph from Graph/Graph_Converter.c
+int main(int argc, char* argv[]) {
+    enum PQKind kind = PQ_DARY_HEAP;
+    if (argc > 3 && !parseQueueKind(argv[3], &kind)) {
+        printf("Unknown queue '%s' (use heap, radix or dial)\n", argv[3]);
+        return 1;
+    }
 
-    addEdge(graph, 0, 1, 4);
-    addEdge(graph, 0, 7, 8);
-    addEdge(graph, 1, 2, 8);
-    addEdge(graph, 1, 7, 11);
-    addEdge(graph, 2, 3, 7);
-    addEdge(graph, 2, 8, 2);
-    addEdge(graph, 2, 5, 4);
-    addEdge(graph, 3, 4, 9);
-    addEdge(graph, 3, 5, 14);
-    addEdge(graph, 4, 5, 10);
-    addEdge(graph, 5, 6, 2);
-    addEdge(graph, 6, 7, 1);
-    addEdge(graph, 6, 8, 6);
-    addEdge(graph, 7, 8, 7);
+    if (argc > 1) {
+        struct CSRGraph* graph = loadCSRGraphFile(argv[1]);
+        if (!graph)
+            return 1;
+        int src = argc > 2 ? atoi(argv[2]) : 0;
+        if (src < 0 || src >= graph->V) {
+            printf("Source vertex %d is out of range [0, %d).\n", src, graph->V);
+            freeCSRGraph(graph);
+            return 1;
+        }
+        dijkstra(graph, src, kind);
+        freeCSRGraph(graph);
+        return 0;
+    }
 
-    dijkstra(graph, 0);
+    int V = 9;
+    struct CSREdge edges[] = {
+        {0, 1, 4}, {0, 7, 8},
+        {1, 2, 8}, {1, 7, 11},
+        {2, 3, 7}, {2, 8, 2}, {2, 5, 4},
+        {3, 4, 9}, {3, 5, 14},
+        {4, 5, 10},
+        {5, 6, 2},
+        {6, 7, 1}, {6, 8, 6},
+        {7, 8, 7}
+    };
+    struct CSRGraph* graph = buildCSRGraph(V, edges, sizeof(edges) / sizeof(edges[0]));
+
+    dijkstra(graph, 0, kind);
+    freeCSRGraph(graph);
     return 0;
 }
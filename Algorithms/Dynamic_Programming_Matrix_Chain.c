@@ -1,56 +1,140 @@
-// Matrix Chain Multiplication using Dynamic Programming
-// Based on CLRS Chapter 15.2
+/* Matrix Chain Multiplication using Dynamic Programming
+Based on CLRS Chapter 15.2
+
+The engine lives in matrix_chain.h. Costs are 64-bit and the tables are on
+the heap, so chains of thousands of matrices work. The result is a plan of
+multiplications that can be printed, costed or executed. Modes:
+
+  dp        O(n^3) DP
+  parallel  the same DP, one OpenMP loop per anti-diagonal
+  hu-shing  Hu and Shing's O(n) near-optimal partition
+
+For a random chain of at most CHECK_MAX_MATRICES matrices, the Hu-Shing
+plan is compared with the DP optimum.
+
+Dimension file: whitespace-separated p[0] .. p[n] for n matrices.
+
+gcc -O3 -fopenmp Dynamic_Programming_Matrix_Chain.c -o matrix_chain
+./matrix_chain                                     CLRS example
+./matrix_chain [-m dp|parallel|hu-shing] dims.txt
+./matrix_chain [-m dp|parallel|hu-shing] random n [max_dim] */
 
 #include <stdio.h>
-#include <limits.h>
-
-// Function to print the optimal parenthesization
-void printParenthesis(int i, int j, int n, int s[n][n], char name) {
-    if (i == j) {
-        printf("%c", name + i - 1);
-        return;
-    }
-    printf("(");
-    printParenthesis(i, s[i][j], n, s, name);
-    printParenthesis(s[i][j] + 1, j, n, s, name);
-    printf(")");
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "matrix_chain.h"
+#include "xorshift.h"
+
+// Parenthesizations are printed up to this many matrices
+#define PRINT_MATRICES 64
+
+// Hu-Shing plans are checked against the DP up to this many matrices
+#define CHECK_MAX_MATRICES 2000
+
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Matrix Chain Order algorithm (CLRS); p has n + 1 entries for n matrices
+struct MatrixChainPlan* matrixChainOrder(const long long p[], int n, enum MatrixChainMode mode) {
+    double t = now();
+    struct MatrixChainPlan* plan = buildMatrixChainPlan(p, n, mode);
+    t = now() - t;
+
+    printf("Minimum number of multiplications%s: %lld\n", mode == MATRIX_CHAIN_HU_SHING ? " (near-optimal)" : "",
+           plan->cost);
+    if (n <= PRINT_MATRICES) {
+        printf("%s Parenthesization: ", mode == MATRIX_CHAIN_HU_SHING ? "Near-optimal" : "Optimal");
+        printMatrixChainPlan(stdout, plan);
+    }
+    printf("%d matrices, %s mode, %.3f s\n", n, matrixChainModeName(mode), t);
+    return plan;
 }
 
-// Matrix Chain Order algorithm (CLRS)
-void matrixChainOrder(int p[], int n) {
-    int m[n][n]; // minimum cost table
-    int s[n][n]; // table for k index to reconstruct solution
-
-    // cost of multiplying one matrix = 0
-    for (int i = 1; i < n; i++)
-        m[i][i] = 0;
-
-    // l = chain length
-    for (int l = 2; l < n; l++) {
-        for (int i = 1; i < n - l + 1; i++) {
-            int j = i + l - 1;
-            m[i][j] = INT_MAX;
-            for (int k = i; k <= j - 1; k++) {
-                int q = m[i][k] + m[k + 1][j] + p[i - 1] * p[k] * p[j];
-                if (q < m[i][j]) {
-                    m[i][j] = q;
-                    s[i][j] = k;
-                }
+// Reads p[0] .. p[n]; returns n
+int readDimensions(const char* filename, long long** p) {
+    FILE* f = fopen(filename, "r");
+    if (!f) {
+        perror(filename);
+        exit(1);
+    }
+    int count = 0, cap = 1024;
+    *p = (long long*)matrixChainAlloc(cap * sizeof(long long));
+    long long x;
+    while (fscanf(f, "%lld", &x) == 1) {
+        if (count == cap) {
+            cap *= 2;
+            *p = (long long*)realloc(*p, cap * sizeof(long long));
+            if (*p == NULL) {
+                perror("Memory allocation failed");
+                exit(1);
             }
         }
+        (*p)[count++] = x;
     }
-
-    printf("Minimum number of multiplications: %d\n", m[1][n - 1]);
-    printf("Optimal Parenthesization: ");
-    printParenthesis(1, n - 1, n, s, 'A');
-    printf("\n");
+    fclose(f);
+    if (count < 2) {
+        fprintf(stderr, "%s: need at least two dimensions\n", filename);
+        exit(1);
+    }
+    return count - 1;
 }
 
-int main() {
-    // Example from CLRS Figure 15.4
-    int p[] = {30, 35, 15, 5, 10, 20, 25};
-    int n = sizeof(p) / sizeof(p[0]);
+int main(int argc, char* argv[]) {
+    enum MatrixChainMode mode = MATRIX_CHAIN_DP;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-m") == 0) {
+        if (!parseMatrixChainMode(argv[2], &mode)) {
+            fprintf(stderr, "Unknown mode %s\n", argv[2]);
+            return 1;
+        }
+        first = 3;
+    }
+
+    long long* p;
+    int n, random = 0;
+    if (argc > first && strcmp(argv[first], "random") == 0) {
+        if (argc <= first + 1) {
+            printf("Usage: %s [-m dp|parallel|hu-shing] random n [max_dim]\n", argv[0]);
+            return 1;
+        }
+        n = atoi(argv[first + 1]);
+        long long maxDim = argc > first + 2 ? atoll(argv[first + 2]) : 1000;
+        if (n < 1 || maxDim < 1) {
+            fprintf(stderr, "n and max_dim must be positive\n");
+            return 1;
+        }
+        p = (long long*)matrixChainAlloc((n + 1) * sizeof(long long));
+        for (int i = 0; i <= n; i++)
+            p[i] = 1 + (long long)(xorshift64() % maxDim);
+        random = 1;
+    } else if (argc > first) {
+        n = readDimensions(argv[first], &p);
+    } else {
+        // Example from CLRS Figure 15.4
+        static const long long example[] = {30, 35, 15, 5, 10, 20, 25};
+        n = sizeof(example) / sizeof(example[0]) - 1;
+        p = (long long*)matrixChainAlloc(sizeof(example));
+        memcpy(p, example, sizeof(example));
+    }
+
+    struct MatrixChainPlan* plan = matrixChainOrder(p, n, mode);
+    if (matrixChainPlanCost(plan, p) != plan->cost) {
+        fprintf(stderr, "MISMATCH: the plan does not cost %lld\n", plan->cost);
+        return 1;
+    }
+    if (random && mode == MATRIX_CHAIN_HU_SHING && n <= CHECK_MAX_MATRICES) {
+        struct MatrixChainPlan* optimal = buildMatrixChainPlan(p, n, MATRIX_CHAIN_PARALLEL);
+        printf("DP optimum %lld, Hu-Shing plan is %.2f%% above it\n", optimal->cost,
+               optimal->cost ? 100.0 * (plan->cost - optimal->cost) / optimal->cost : 0.0);
+        freeMatrixChainPlan(optimal);
+    }
 
-    matrixChainOrder(p, n);
+    freeMatrixChainPlan(plan);
+    free(p);
     return 0;
 }
@@ -2,98 +2,78 @@
 
 Given a connected, undirected, weighted graph G=(V,E),
 find a subset of edges that forms a tree including all vertices and has the minimum total weight.
-From CLRS Chapter 23.2 */
+From CLRS Chapter 23.2
+
+The work is done by the MST engine in Graph/mst.h: radix-sorted Kruskal,
+filter-Kruskal or parallel Boruvka on a lock-free union-find. On a
+disconnected graph the result is a minimum spanning forest.
+
+gcc -O2 -fopenmp Minimum_Spanning_Tree_Kruskal.c -o kruskal
+./kruskal                                          CLRS example
+./kruskal graph.csr [kruskal|filter-kruskal|boruvka]  */
 
 #include <stdio.h>
 #include <stdlib.h>
 
-// Structure to represent an edge
-struct Edge {
-    int src, dest, weight;
-};
+#include "../Graph/csr_graph_file.h"
+#include "../Graph/mst.h"
 
-// Structure to represent a subset for Union-Find
-struct Subset {
-    int parent;
-    int rank;
-};
+// Print at most this many MST edges; larger trees only get a summary
+#define MAX_PRINTED_EDGES 100
 
-// Find set of an element (uses path compression)
-int find(struct Subset subsets[], int i) {
-    if (subsets[i].parent != i)
-        subsets[i].parent = find(subsets, subsets[i].parent);
-    return subsets[i].parent;
-}
+// Kruskal's MST Algorithm (edges[] is reordered)
+void KruskalMST(struct CSREdge edges[], int V, long long E, enum MSTMode mode) {
+    struct CSREdge* result = (struct CSREdge*)csrAlloc(V * sizeof(struct CSREdge));  // Store MST edges
+    long long totalWeight;
 
-// Union of two sets (by rank)
-void Union(struct Subset subsets[], int x, int y) {
-    int xroot = find(subsets, x);
-    int yroot = find(subsets, y);
+    int e = minimumSpanningForest(edges, E, V, mode, result, &totalWeight);
 
-    if (subsets[xroot].rank < subsets[yroot].rank)
-        subsets[xroot].parent = yroot;
-    else if (subsets[xroot].rank > subsets[yroot].rank)
-        subsets[yroot].parent = xroot;
-    else {
-        subsets[yroot].parent = xroot;
-        subsets[xroot].rank++;
+    // Print the MST
+    if (e <= MAX_PRINTED_EDGES) {
+        printf("Edges in the constructed MST:\n");
+        for (int i = 0; i < e; i++)
+            printf("%d -- %d == %d\n", result[i].src, result[i].dest, result[i].weight);
+    } else {
+        printf("Constructed MST with %d edges (%s)\n", e, mstModeName(mode));
     }
-}
+    if (e < V - 1)
+        printf("Graph is disconnected: %d trees\n", V - e);
+    printf("Total weight of MST = %lld\n", totalWeight);
 
-// Compare function for qsort
-int compareEdges(const void* a, const void* b) {
-    struct Edge* a1 = (struct Edge*)a;
-    struct Edge* b1 = (struct Edge*)b;
-    return a1->weight - b1->weight;
+    free(result);
 }
 
-// Kruskal's MST Algorithm
-void KruskalMST(struct Edge edges[], int V, int E) {
-    struct Edge result[V];  // Store MST edges
-    int e = 0;              // Counter for result[]
-    int i = 0;              // Counter for sorted edges
-
-    // Step 1: Sort edges by weight
-    qsort(edges, E, sizeof(edges[0]), compareEdges);
-
-    // Allocate memory for Union-Find subsets
-    struct Subset* subsets = (struct Subset*)malloc(V * sizeof(struct Subset));
-    for (int v = 0; v < V; v++) {
-        subsets[v].parent = v;
-        subsets[v].rank = 0;
-    }
-
-    // Step 2: Process edges one by one
-    while (e < V - 1 && i < E) {
-        struct Edge next = edges[i++];
-
-        int x = find(subsets, next.src);
-        int y = find(subsets, next.dest);
-
-        // If including this edge doesn’t form a cycle
-        if (x != y) {
-            result[e++] = next;
-            Union(subsets, x, y);
-        }
+// Example graph from CLRS
+// ./kruskal graph.csr loads a graph written by Graph/Graph_Converter.c.
+// If an edge is stored in both directions the second copy simply closes a cycle.
+int main(int argc, char* argv[]) {
+    enum MSTMode mode = MST_FILTER_KRUSKAL;
+    if (argc > 2 && !parseMSTMode(argv[2], &mode)) {
+        printf("Unknown mode '%s' (use kruskal, filter-kruskal or boruvka)\n", argv[2]);
+        return 1;
     }
 
-    // Print the MST
-    printf("Edges in the constructed MST:\n");
-    int totalWeight = 0;
-    for (i = 0; i < e; i++) {
-        printf("%d -- %d == %d\n", result[i].src, result[i].dest, result[i].weight);
-        totalWeight += result[i].weight;
+    if (argc > 1) {
+        struct CSRGraph* csr = loadCSRGraphFile(argv[1]);
+        if (!csr)
+            return 1;
+        struct CSREdge* edges = (struct CSREdge*)csrAlloc(csr->E * sizeof(struct CSREdge));
+        long long E = 0;
+        for (int u = 0; u < csr->V; u++)
+            for (long long i = csr->offset[u]; i < csr->offset[u + 1]; i++)
+                if (u != csr->dest[i])
+                    edges[E++] = (struct CSREdge){u, csr->dest[i], csr->weight[i]};
+        int V = csr->V;
+        freeCSRGraph(csr);
+
+        KruskalMST(edges, V, E, mode);
+        free(edges);
+        return 0;
     }
-    printf("Total weight of MST = %d\n", totalWeight);
-
-    free(subsets);
-}
 
-// Example graph from CLRS
-int main() {
     int V = 4;  // Number of vertices
     int E = 5;  // Number of edges
-    struct Edge edges[] = {
+    struct CSREdge edges[] = {
         {0, 1, 10},
         {0, 2, 6},
         {0, 3, 5},
@@ -101,6 +81,6 @@ int main() {
         {2, 3, 4}
     };
 
-    KruskalMST(edges, V, E);
+    KruskalMST(edges, V, E, mode);
     return 0;
 }
@@ -1,44 +1,28 @@
 // QuickSort with Empirical Complexity Estimation
 // Description: Reads numbers, sorts them using QuickSort,
 // counts comparisons and swaps, and prints empirical complexity.
+//
+// The sort is the introsort of introsort.h: ninther / median-of-3 pivots,
+// Hoare partitioning, heapsort fallback, insertion-sort cutoff and a
+// bounded stack, so sorted or adversarial input no longer goes quadratic.
+// Counting is compiled in here; build with -DNO_COUNTERS to time the sort
+// with the counters compiled out.
+//
+// gcc -O2 Quick_Sort_Complexity_Estimation.c -o quicksort -lm
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <math.h>
 
-long long comparisons = 0; // global counter for comparisons
-long long swaps = 0;       // global counter for swaps
+#ifndef NO_COUNTERS
+#define INTROSORT_COUNT
+#endif
+#include "introsort.h"
 
-// Swap two elements
-void swap(int *a, int *b) {
-    int temp = *a;
-    *a = *b;
-    *b = temp;
-    swaps++;
-}
-
-// Partition function (Lomuto partition scheme)
-int partition(int arr[], int low, int high) {
-    int pivot = arr[high];
-    int i = low - 1;
-    for (int j = low; j < high; j++) {
-        comparisons++;
-        if (arr[j] <= pivot) {
-            i++;
-            swap(&arr[i], &arr[j]);
-        }
-    }
-    swap(&arr[i + 1], &arr[high]);
-    return i + 1;
-}
-
-// Recursive QuickSort
-void quickSort(int arr[], int low, int high) {
-    if (low < high) {
-        int pi = partition(arr, low, high);
-        quickSort(arr, low, pi - 1);
-        quickSort(arr, pi + 1, high);
-    }
+// QuickSort entry point (introsort)
+void quickSort(int arr[], int n) {
+    introsort(arr, n);
 }
 
 // Function to print array
@@ -64,7 +48,7 @@ int main() {
         scanf("%d", &arr[i]);
 
     clock_t start = clock();
-    quickSort(arr, 0, n - 1);
+    quickSort(arr, n);
     clock_t end = clock();
 
     double time_taken = ((double)(end - start)) / CLOCKS_PER_SEC;
@@ -74,12 +58,17 @@ int main() {
 
     printf("\n=== QuickSort Complexity Report ===\n");
     printf("Number of elements (n): %d\n", n);
-    printf("Comparisons: %lld\n", comparisons);
-    printf("Swaps: %lld\n", swaps);
+#ifdef INTROSORT_COUNT
+    printf("Comparisons: %lld\n", introsortComparisons);
+    printf("Swaps: %lld\n", introsortSwaps);
+    printf("Heapsort fallbacks: %lld\n", introsortFallbacks);
+#endif
     printf("Execution time: %.6f seconds\n", time_taken);
     printf("Estimated O(n log n): %.2f\n", n * (log(n) / log(2)));
+#ifdef INTROSORT_COUNT
     printf("Empirical ratio (comparisons / n log n): %.2f\n",
-           comparisons / (n * (log(n) / log(2))));
+           introsortComparisons / (n * (log(n) / log(2))));
+#endif
 
     free(arr);
     return 0;
@@ -0,0 +1,165 @@
+/* Benchmark: radix_sort.h on every key type against qsort
+
+For each key type n random keys (full 32/64-bit range, negatives and
+floats of every magnitude included) are sorted with one preallocated
+scratch buffer, then checked for order and for an unchanged sum of the
+raw bit patterns. Each type is sorted by the sequential LSD sort, the
+multithreaded LSD sort, the in-place MSD sort and the key-value sort with
+an index payload. qsort runs on the same input for 32-bit ints and
+doubles as a baseline.
+
+gcc -O2 -fopenmp Radix_Sort_Benchmark.c -o radix_bench
+OMP_NUM_THREADS=32 ./radix_bench [n] [-q]   (default n = 50000000, -q skips qsort) */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "radix_sort.h"
+#include "xorshift.h"
+
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int compareInt32(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a, y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+int compareDouble(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Random bit patterns; NaNs are replaced so every float compares
+void fillRandom(void* data, size_t n, size_t width, enum RadixKeyType type) {
+    for (size_t i = 0; i < n; i++) {
+        uint64_t r = xorshift64();
+        if (width == 4) {
+            uint32_t x = (uint32_t)r;
+            if (type == RADIX_FLOAT && (x & 0x7f800000u) == 0x7f800000u)
+                x &= 0xbfffffffu;
+            ((radix_u32*)data)[i] = x;
+        } else {
+            if (type == RADIX_FLOAT && (r & 0x7ff0000000000000ull) == 0x7ff0000000000000ull)
+                r &= 0xbfffffffffffffffull;
+            ((radix_u64*)data)[i] = r;
+        }
+    }
+}
+
+uint64_t bitSum(const void* data, size_t n, size_t width) {
+    uint64_t s = 0;
+    for (size_t i = 0; i < n; i++)
+        s += width == 4 ? ((const radix_u32*)data)[i] : ((const radix_u64*)data)[i];
+    return s;
+}
+
+int isSorted(const void* data, size_t n, size_t width, enum RadixKeyType type) {
+    for (size_t i = 1; i < n; i++) {
+        uint64_t a, b;
+        if (width == 4) {
+            a = radixEncode32(((const radix_u32*)data)[i - 1], type);
+            b = radixEncode32(((const radix_u32*)data)[i], type);
+        } else {
+            a = radixEncode64(((const radix_u64*)data)[i - 1], type);
+            b = radixEncode64(((const radix_u64*)data)[i], type);
+        }
+        if (a > b)
+            return 0;
+    }
+    return 1;
+}
+
+void report(const char* name, size_t n, size_t width, double t, int ok) {
+    printf("%-20s %9.3f s %10.1f Mkeys/s %8.2f GB/s  %s\n",
+           name, t, n / t / 1e6, n * width / t / 1e9, ok ? "ok" : "NOT SORTED");
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = 50000000;
+    int runQsort = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0)
+            runQsort = 0;
+        else
+            n = strtoull(argv[i], NULL, 10);
+    }
+
+    const struct {
+        const char* name;
+        size_t width;
+        enum RadixKeyType type;
+        int (*compare)(const void*, const void*);  // qsort baseline, if any
+    } kinds[] = {
+        {"uint32", 4, RADIX_UNSIGNED, NULL}, {"int32", 4, RADIX_SIGNED, compareInt32},
+        {"float", 4, RADIX_FLOAT, NULL},     {"uint64", 8, RADIX_UNSIGNED, NULL},
+        {"int64", 8, RADIX_SIGNED, NULL},    {"double", 8, RADIX_FLOAT, compareDouble}
+    };
+
+    void* data = radixAlloc(n * 8);
+    void* copy = radixAlloc(n * 8);
+    void* scratch = radixAlloc(n * 8);
+    void* input = radixAlloc(n * 8);
+    uint32_t* values = (uint32_t*)radixAlloc(n * sizeof(uint32_t));
+    uint32_t* valueScratch = (uint32_t*)radixAlloc(n * sizeof(uint32_t));
+    printf("n = %zu keys, %d-bit digits, %d threads\n\n", n, RADIX_BITS, radixThreadCount());
+
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        size_t w = kinds[k].width;
+        enum RadixKeyType type = kinds[k].type;
+        fillRandom(input, n, w, type);
+        uint64_t sum = bitSum(input, n, w);
+        char name[32];
+
+        for (int variant = 0; variant < 4; variant++) {
+            static const char* variantName[] = {"radix", "parallel", "in-place", "pairs"};
+            memcpy(data, input, n * w);
+            for (size_t i = 0; variant == 3 && i < n; i++)
+                values[i] = (uint32_t)i;
+
+            double t = now();
+            switch (variant) {
+            case 0: radixSortTyped(data, scratch, n, w, type); break;
+            case 1: radixSortParallel(data, scratch, n, w, type); break;
+            case 2: radixSortInPlace(data, n, w, type); break;
+            case 3: radixSortPairs(data, values, scratch, valueScratch, n, w, type); break;
+            }
+            t = now() - t;
+
+            int ok = isSorted(data, n, w, type) && bitSum(data, n, w) == sum;
+            // The payload must still point at each key's original slot
+            for (size_t i = 0; variant == 3 && ok && i < n; i++)
+                ok = memcmp((const char*)input + (size_t)values[i] * w, (const char*)data + i * w, w) == 0;
+            snprintf(name, sizeof(name), "%s %s", variantName[variant], kinds[k].name);
+            report(name, n, w, t, ok);
+        }
+
+        memcpy(copy, input, n * w);
+        double t;
+
+        if (runQsort && kinds[k].compare) {
+            t = now();
+            qsort(copy, n, w, kinds[k].compare);
+            t = now() - t;
+            snprintf(name, sizeof(name), "qsort %s", kinds[k].name);
+            // qsort may order -0.0 and +0.0 either way, so compare by value
+            int same = 1;
+            for (size_t i = 0; i < n && same; i++)
+                same = kinds[k].compare((const char*)copy + i * w, (const char*)data + i * w) == 0;
+            report(name, n, w, t, same);
+        }
+    }
+
+    free(valueScratch);
+    free(values);
+    free(input);
+    free(scratch);
+    free(copy);
+    free(data);
+    return 0;
+}
@@ -0,0 +1,358 @@
+/* External-memory sort of int32 files larger than RAM.
+
+  1. Run formation: the input is read a budget-sized chunk at a time, each
+     chunk is sorted in memory by the caller's sort (radix or merge sort,
+     with a scratch buffer of the same size), and written to a temporary
+     file.
+  2. Merging: up to F runs at a time are merged through a loser tree, one
+     comparison per tree level per output key. Every run gets an equal
+     share of half the budget as its read buffer and the output gets the
+     other half, so all I/O is large sequential pread/pwrite. F is the
+     number of runs whose buffers still hold EXTSORT_MIN_BUFFER bytes;
+     with more runs than that, extra merge passes produce longer runs.
+
+Input and output are text (parsed/formatted as in int_io.h) or raw
+little-endian int32. Temporary files go to tmpDir, are unlinked at once,
+and disappear even if the program dies. The stats count every byte read
+and written, temporaries included. */
+
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+
+#include "int_io.h"
+
+// Smallest useful read buffer per run during a merge
+#define EXTSORT_MIN_BUFFER (1u << 20)
+
+// Sorts a[0 .. n-1]; scratch has room for n values
+typedef void (*ExternalRunSort)(int32_t* a, int32_t* scratch, size_t n);
+
+struct ExternalSortStats {
+    size_t values;
+    int runs;              // initial sorted runs
+    int mergePasses;       // passes over the data after run formation
+    size_t bytesRead;      // input + temporary files
+    size_t bytesWritten;   // temporary files + output
+    double runSeconds, mergeSeconds;
+};
+
+// ---------- Sequential binary file access ----------
+struct ExtFile {
+    int fd;
+    const char* name;  // for error messages
+};
+
+static inline void extRead(struct ExtFile f, void* p, size_t bytes, off_t at, struct ExternalSortStats* st) {
+    char* q = (char*)p;
+    while (bytes > 0) {
+        ssize_t r = pread(f.fd, q, bytes < INT_IO_CHUNK ? bytes : INT_IO_CHUNK, at);
+        if (r <= 0) {
+            fprintf(stderr, "%s: %s\n", f.name, r == 0 ? "unexpected end of file" : strerror(errno));
+            exit(1);
+        }
+        q += r;
+        bytes -= (size_t)r;
+        at += r;
+        st->bytesRead += (size_t)r;
+    }
+}
+
+static inline struct ExtFile extTempFile(const char* tmpDir) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/extsort.XXXXXX", tmpDir);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror(path);
+        exit(1);
+    }
+    unlink(path);
+    return (struct ExtFile){fd, "temporary run file"};
+}
+
+// ---------- Output ----------
+enum ExtFormat {
+    EXT_NATIVE,         // temporary runs
+    EXT_LITTLE_ENDIAN,  // binary output
+    EXT_TEXT
+};
+
+// Buffers values and writes them sequentially
+struct ExtWriter {
+    struct ExtFile f;
+    enum ExtFormat format;
+    char* buffer;
+    size_t used, capacity;
+    off_t at;
+};
+
+static inline void extFlush(struct ExtWriter* w, struct ExternalSortStats* st) {
+    intWriteAll(w->f.fd, w->buffer, w->used, w->at, w->f.name);
+    w->at += (off_t)w->used;
+    st->bytesWritten += w->used;
+    w->used = 0;
+}
+
+static inline void extPut(struct ExtWriter* w, int32_t x, struct ExternalSortStats* st) {
+    if (w->used + INT_IO_MAX_CHARS > w->capacity)
+        extFlush(w, st);
+    if (w->format == EXT_TEXT) {
+        w->used += intFormat(x, w->buffer + w->used);
+    } else {
+        uint32_t v = (uint32_t)x;
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        if (w->format == EXT_LITTLE_ENDIAN)
+            v = __builtin_bswap32(v);
+#endif
+        memcpy(w->buffer + w->used, &v, sizeof(v));
+        w->used += sizeof(v);
+    }
+}
+
+// ---------- Loser tree ----------
+// node[1 .. k-1] hold the loser of each match, node[0] the overall winner.
+// Leaf k is a virtual -infinity used while building.
+struct LoserTree {
+    int k;
+    int* node;
+    int64_t* key;  // k + 1 entries; INT64_MAX marks an exhausted run
+};
+
+static inline void loserTreeAdjust(struct LoserTree* lt, int leaf) {
+    int winner = leaf;
+    for (int p = (leaf + lt->k) / 2; p > 0; p /= 2) {
+        if (lt->key[lt->node[p]] < lt->key[winner]) {
+            int t = lt->node[p];
+            lt->node[p] = winner;
+            winner = t;
+        }
+    }
+    lt->node[0] = winner;
+}
+
+static inline void loserTreeBuild(struct LoserTree* lt) {
+    lt->key[lt->k] = INT64_MIN;
+    for (int i = 0; i < lt->k; i++)
+        lt->node[i] = lt->k;
+    for (int i = lt->k - 1; i >= 0; i--)
+        loserTreeAdjust(lt, i);
+}
+
+// ---------- Merging ----------
+struct ExtRun {
+    struct ExtFile f;
+    off_t start;   // first byte of the run in its file
+    size_t count;  // values in the run
+};
+
+struct ExtReader {
+    struct ExtRun run;
+    size_t next;            // next value of the run to load
+    int32_t* buffer;
+    size_t have, at, capacity;
+};
+
+// Returns 0 when the run is exhausted
+static inline int extReaderFill(struct ExtReader* r, struct ExternalSortStats* st) {
+    size_t left = r->run.count - r->next;
+    if (left == 0)
+        return 0;
+    size_t take = left < r->capacity ? left : r->capacity;
+    extRead(r->run.f, r->buffer, take * sizeof(int32_t),
+            r->run.start + (off_t)(r->next * sizeof(int32_t)), st);
+    r->next += take;
+    r->have = take;
+    r->at = 0;
+    return 1;
+}
+
+// Merges runs[0 .. k-1] into w with readers of perRun values each
+static inline void extMergeRuns(const struct ExtRun* runs, int k, size_t perRun,
+                                struct ExtWriter* w, struct ExternalSortStats* st) {
+    struct ExtReader* readers = (struct ExtReader*)intIOAlloc(k * sizeof(struct ExtReader));
+    struct LoserTree lt = {k, (int*)intIOAlloc(k * sizeof(int)), (int64_t*)intIOAlloc((k + 1) * sizeof(int64_t))};
+    lt.node[0] = k;  // also the winner slot when k == 1
+
+    for (int i = 0; i < k; i++) {
+        readers[i] = (struct ExtReader){runs[i], 0, (int32_t*)intIOAlloc(perRun * sizeof(int32_t)), 0, 0, perRun};
+        lt.key[i] = extReaderFill(&readers[i], st) ? readers[i].buffer[0] : INT64_MAX;
+    }
+    loserTreeBuild(&lt);
+
+    for (;;) {
+        int i = lt.node[0];
+        if (lt.key[i] == INT64_MAX)
+            break;
+        extPut(w, (int32_t)lt.key[i], st);
+        struct ExtReader* r = &readers[i];
+        if (++r->at == r->have && !extReaderFill(r, st))
+            lt.key[i] = INT64_MAX;
+        else
+            lt.key[i] = r->buffer[r->at];
+        loserTreeAdjust(&lt, i);
+    }
+
+    for (int i = 0; i < k; i++)
+        free(readers[i].buffer);
+    free(lt.key);
+    free(lt.node);
+    free(readers);
+}
+
+// ---------- Driver ----------
+static inline double extNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// memoryBytes bounds the buffers of both phases (at least 8 KB is used)
+static inline void externalSort(const char* inputName, int binaryIn, const char* outputName, int binaryOut,
+                                size_t memoryBytes, const char* tmpDir, ExternalRunSort sortRun,
+                                struct ExternalSortStats* st) {
+    memset(st, 0, sizeof(*st));
+    // Run formation holds a chunk plus its scratch; merging splits the same
+    // amount between the run readers and one output buffer
+    size_t capacity = memoryBytes / (2 * sizeof(int32_t));
+    if (capacity < 1024)
+        capacity = 1024;
+    int32_t* chunk = (int32_t*)intIOAlloc(capacity * sizeof(int32_t));
+    int32_t* scratch = (int32_t*)intIOAlloc(capacity * sizeof(int32_t));
+
+    // 1. Sorted runs, appended to one temporary file
+    double t0 = extNow();
+    struct ExtFile runFile = extTempFile(tmpDir);
+    off_t runAt = 0;
+    struct ExtRun* runs = NULL;
+    int runCap = 0;
+
+    struct ExtFile in = {-1, inputName};
+    size_t inputBytes = 0, inputAt = 0;
+    const unsigned char* text = NULL;
+    size_t textSpan = 2 * capacity;  // every token takes at least two bytes
+    if (binaryIn) {
+        struct stat sb;
+        in.fd = open(inputName, O_RDONLY);
+        if (in.fd < 0 || fstat(in.fd, &sb) != 0) {
+            perror(inputName);
+            exit(1);
+        }
+        if (sb.st_size % sizeof(int32_t) != 0) {
+            fprintf(stderr, "%s: size is not a multiple of 4 bytes\n", inputName);
+            exit(1);
+        }
+        inputBytes = (size_t)sb.st_size;
+    } else {
+        text = mapTextFile(inputName, &inputBytes);
+    }
+
+    while (inputAt < inputBytes) {
+        size_t n;
+        if (binaryIn) {
+            size_t bytes = inputBytes - inputAt < capacity * sizeof(int32_t) ? inputBytes - inputAt
+                                                                             : capacity * sizeof(int32_t);
+            extRead(in, chunk, bytes, (off_t)inputAt, st);
+            inputAt += bytes;
+            n = bytes / sizeof(int32_t);
+            intToLittleEndian(chunk, n);
+        } else {
+            // Size the byte range from the token density seen so far, then
+            // shrink it until its tokens fit the chunk
+            size_t span = inputBytes - inputAt < textSpan ? inputBytes - inputAt : textSpan;
+            while (intCountTokens(text, inputAt, inputAt + span) > capacity)
+                span /= 2;
+            n = parseTextIntegers(text, inputBytes, inputAt, inputAt + span, chunk, inputName);
+            st->bytesRead += span;
+            inputAt += span;
+            if (n > 0)
+                textSpan = (size_t)((double)span / n * capacity * 0.95) + 1;
+        }
+        if (n == 0)
+            continue;
+
+        sortRun(chunk, scratch, n);
+        if (st->runs == runCap) {
+            runCap = runCap ? 2 * runCap : 64;
+            runs = (struct ExtRun*)realloc(runs, runCap * sizeof(struct ExtRun));
+            if (!runs) {
+                perror("realloc failed");
+                exit(1);
+            }
+        }
+        runs[st->runs++] = (struct ExtRun){runFile, runAt, n};
+        intWriteAll(runFile.fd, (const char*)chunk, n * sizeof(int32_t), runAt, runFile.name);
+        runAt += (off_t)(n * sizeof(int32_t));
+        st->bytesWritten += n * sizeof(int32_t);
+        st->values += n;
+    }
+    if (text)
+        munmap((void*)text, inputBytes);
+    if (in.fd >= 0)
+        close(in.fd);
+    free(scratch);
+    st->runSeconds = extNow() - t0;
+
+    // 2. Intermediate passes while more than F runs remain
+    t0 = extNow();
+    size_t half = capacity;  // values in half of the budget
+    int fanout = (int)(half * sizeof(int32_t) / EXTSORT_MIN_BUFFER);
+    if (fanout < 2)
+        fanout = 2;
+    int live = st->runs;
+    struct ExtFile src = runFile;
+    while (live > fanout) {
+        struct ExtFile dst = extTempFile(tmpDir);
+        struct ExtWriter w = {dst, EXT_NATIVE, (char*)chunk, 0, half * sizeof(int32_t), 0};
+        int merged = 0;
+        for (int first = 0; first < live; first += fanout) {
+            int k = live - first < fanout ? live - first : fanout;
+            off_t start = w.at + (off_t)w.used;
+            size_t count = 0;
+            for (int i = 0; i < k; i++)
+                count += runs[first + i].count;
+            extMergeRuns(runs + first, k, half / k, &w, st);
+            runs[merged++] = (struct ExtRun){dst, start, count};
+        }
+        extFlush(&w, st);
+        close(src.fd);
+        src = dst;
+        live = merged;
+        st->mergePasses++;
+    }
+
+    // 3. Final merge into the output
+    struct ExtFile out = {open(outputName, O_WRONLY | O_CREAT | O_TRUNC, 0644), outputName};
+    if (out.fd < 0) {
+        perror(outputName);
+        exit(1);
+    }
+    struct ExtWriter w = {out, binaryOut ? EXT_LITTLE_ENDIAN : EXT_TEXT, (char*)chunk, 0, half * sizeof(int32_t), 0};
+    if (live > 0) {
+        extMergeRuns(runs, live, half / live, &w, st);
+        st->mergePasses++;
+    }
+    extFlush(&w, st);
+    if (close(out.fd) != 0) {
+        perror(outputName);
+        exit(1);
+    }
+    close(src.fd);
+    st->mergeSeconds = extNow() - t0;
+
+    free(runs);
+    free(chunk);
+}
+
+// One-line summary of a finished external sort
+static inline void printExternalSortStats(const struct ExternalSortStats* st) {
+    printf("external sort: %zu values, %d runs, %d merge passes\n", st->values, st->runs, st->mergePasses);
+    printf("I/O: %.3f GB read, %.3f GB written (%.2fx the key volume)\n",
+           st->bytesRead / 1e9, st->bytesWritten / 1e9,
+           st->values ? (double)(st->bytesRead + st->bytesWritten) / (st->values * sizeof(int32_t)) : 0.0);
+    printf("runs %.3f s, merge %.3f s\n", st->runSeconds, st->mergeSeconds);
+}
+
+#endif // EXTERNAL_SORT_H
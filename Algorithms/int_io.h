@@ -0,0 +1,354 @@
+/* Fast integer file I/O for the sort tools.
+
+  readTextIntegers    maps the file and parses whitespace-separated
+                      decimal int32 values (optional sign). The file is
+                      cut into one byte range per thread; a token belongs
+                      to the range its first byte lies in. A branch-free
+                      counting pass (plain byte compares the compiler can
+                      vectorise) sizes the output, then every thread parses
+                      its range straight into its slice of the array.
+                      Malformed or out-of-range tokens abort with the
+                      byte offset. parseTextIntegers does the same for a
+                      byte range of a mapped file.
+  writeTextIntegers   one value per line. Threads format consecutive slices
+                      into private buffers with a two-digits-at-a-time
+                      formatter, then pwrite them at their prefix-summed
+                      file offsets.
+  readBinaryIntegers  raw little-endian int32, no header; byte-swapped on
+  writeBinaryIntegers big-endian hosts.
+
+All functions exit with a message on I/O errors. Compile with -fopenmp to
+parse and format in parallel. */
+
+#ifndef INT_IO_H
+#define INT_IO_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Values each thread formats per round of writeTextIntegers
+#define INT_IO_FORMAT_BLOCK (1 << 18)
+
+// Bytes per work item when counting the tokens of a whole file
+#define INT_IO_COUNT_BLOCK (1u << 20)
+
+// Longest formatted value: "-2147483648\n"
+#define INT_IO_MAX_CHARS 12
+
+// Binary I/O moves at most this many bytes per system call
+#define INT_IO_CHUNK (64u << 20)
+
+static inline void* intIOAlloc(size_t bytes) {
+    void* p = malloc(bytes ? bytes : 1);
+    if (p == NULL) {
+        perror("int I/O allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+static inline int intIOThreads(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+static inline int intIsSpace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// ---------- Text input ----------
+// Number of tokens whose first byte lies in [begin, end)
+static inline size_t intCountTokens(const unsigned char* s, size_t begin, size_t end) {
+    size_t n = 0;
+    int prevSpace = begin == 0 || intIsSpace(s[begin - 1]);
+    for (size_t i = begin; i < end; i++) {
+        int space = intIsSpace(s[i]);
+        n += prevSpace & !space;
+        prevSpace = space;
+    }
+    return n;
+}
+
+// Parses the tokens starting in [begin, end) into out[]; a token may run
+// past end up to len. Returns how many were parsed.
+static inline size_t intParseRange(const unsigned char* s, size_t len, size_t begin, size_t end,
+                                   int32_t* out, const char* filename) {
+    size_t i = begin, n = 0;
+    // A token straddling begin belongs to the previous range
+    if (i > 0 && !intIsSpace(s[i - 1]))
+        while (i < len && !intIsSpace(s[i]))
+            i++;
+
+    while (i < end) {
+        if (intIsSpace(s[i])) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        int negative = s[i] == '-';
+        if (s[i] == '-' || s[i] == '+')
+            i++;
+        uint64_t v = 0;
+        size_t digitsStart = i;
+        while (i < len && (unsigned)(s[i] - '0') < 10 && i - digitsStart < 11)
+            v = v * 10 + (s[i++] - '0');
+        if (i == digitsStart || (i < len && !intIsSpace(s[i])) ||
+            v > (negative ? 2147483648ull : 2147483647ull)) {
+            fprintf(stderr, "%s: malformed or out-of-range integer at byte %zu\n", filename, start);
+            exit(1);
+        }
+        out[n++] = (int32_t)(negative ? 0u - (uint32_t)v : (uint32_t)v);
+    }
+    return n;
+}
+
+// Parses every token starting in [begin, end) of the mapped text s into
+// out[], which must have room for them, splitting the range over the
+// threads. Returns the number of values.
+static inline size_t parseTextIntegers(const unsigned char* s, size_t len, size_t begin, size_t end,
+                                       int32_t* out, const char* filename) {
+    int T = intIOThreads();
+    size_t* first = (size_t*)intIOAlloc((T + 1) * sizeof(size_t));
+    size_t total = 0;
+
+    #pragma omp parallel num_threads(T)
+    {
+        int t = 0, nt = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        nt = omp_get_num_threads();
+#endif
+        size_t span = end - begin;
+        size_t lo = begin + span / nt * t, hi = t == nt - 1 ? end : begin + span / nt * (t + 1);
+        first[t + 1] = intCountTokens(s, lo, hi);
+        #pragma omp barrier
+        #pragma omp single
+        {
+            first[0] = 0;
+            for (int k = 0; k < nt; k++)
+                first[k + 1] += first[k];
+            total = first[nt];
+        }
+        intParseRange(s, len, lo, hi, out + first[t], filename);
+    }
+
+    free(first);
+    return total;
+}
+
+// Maps a whole file read-only; *len receives its size. An empty file
+// gives NULL. Release with munmap.
+static inline const unsigned char* mapTextFile(const char* filename, size_t* len) {
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(filename);
+        exit(1);
+    }
+    *len = (size_t)st.st_size;
+    if (*len == 0) {
+        close(fd);
+        return NULL;
+    }
+    const unsigned char* s = (const unsigned char*)mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (s == (const unsigned char*)MAP_FAILED) {
+        perror(filename);
+        exit(1);
+    }
+    madvise((void*)s, *len, MADV_SEQUENTIAL);
+    return s;
+}
+
+// Returns a malloc'ed array; *n receives the number of values
+static inline int32_t* readTextIntegers(const char* filename, size_t* n) {
+    size_t len;
+    const unsigned char* s = mapTextFile(filename, &len);
+    if (s == NULL) {
+        *n = 0;
+        return (int32_t*)intIOAlloc(sizeof(int32_t));
+    }
+
+    size_t count = 0, blocks = (len + INT_IO_COUNT_BLOCK - 1) / INT_IO_COUNT_BLOCK;
+    #pragma omp parallel for schedule(static) reduction(+:count)
+    for (size_t b = 0; b < blocks; b++) {
+        size_t hi = (b + 1) * INT_IO_COUNT_BLOCK;
+        count += intCountTokens(s, b * INT_IO_COUNT_BLOCK, hi < len ? hi : len);
+    }
+    int32_t* values = (int32_t*)intIOAlloc(count * sizeof(int32_t));
+    *n = parseTextIntegers(s, len, 0, len, values, filename);
+
+    munmap((void*)s, len);
+    return values;
+}
+
+// ---------- Text output ----------
+static const char intDigitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes x and a newline to p; returns the number of bytes
+static inline size_t intFormat(int32_t x, char* p) {
+    char tmp[INT_IO_MAX_CHARS];
+    char* q = tmp + sizeof(tmp);
+    uint32_t v = x < 0 ? 0u - (uint32_t)x : (uint32_t)x;
+    *--q = '\n';
+    while (v >= 100) {
+        unsigned r = v % 100;
+        v /= 100;
+        q -= 2;
+        memcpy(q, intDigitPairs + 2 * r, 2);
+    }
+    if (v >= 10) {
+        q -= 2;
+        memcpy(q, intDigitPairs + 2 * v, 2);
+    } else {
+        *--q = (char)('0' + v);
+    }
+    if (x < 0)
+        *--q = '-';
+    size_t len = tmp + sizeof(tmp) - q;
+    memcpy(p, q, len);
+    return len;
+}
+
+static inline void intWriteAll(int fd, const char* p, size_t len, off_t at, const char* filename) {
+    while (len > 0) {
+        ssize_t w = pwrite(fd, p, len, at);
+        if (w <= 0) {
+            perror(filename);
+            exit(1);
+        }
+        p += w;
+        len -= (size_t)w;
+        at += w;
+    }
+}
+
+static inline void writeTextIntegers(const char* filename, const int32_t* a, size_t n) {
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(filename);
+        exit(1);
+    }
+    int T = intIOThreads();
+    size_t* bytes = (size_t*)intIOAlloc((T + 1) * sizeof(size_t));
+    off_t fileAt = 0;
+
+    #pragma omp parallel num_threads(T)
+    {
+        int t = 0, nt = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        nt = omp_get_num_threads();
+#endif
+        char* buffer = (char*)intIOAlloc((size_t)INT_IO_FORMAT_BLOCK * INT_IO_MAX_CHARS);
+        for (size_t base = 0; base < n; base += (size_t)nt * INT_IO_FORMAT_BLOCK) {
+            size_t begin = base + (size_t)t * INT_IO_FORMAT_BLOCK;
+            size_t end = begin + INT_IO_FORMAT_BLOCK < n ? begin + INT_IO_FORMAT_BLOCK : n;
+            size_t len = 0;
+            for (size_t i = begin; i < end; i++)
+                len += intFormat(a[i], buffer + len);
+            bytes[t + 1] = len;
+            #pragma omp barrier
+            #pragma omp single
+            {
+                bytes[0] = 0;
+                for (int k = 0; k < nt; k++)
+                    bytes[k + 1] += bytes[k];
+            }
+            intWriteAll(fd, buffer, len, fileAt + (off_t)bytes[t], filename);
+            #pragma omp barrier
+            #pragma omp single
+            fileAt += (off_t)bytes[nt];
+        }
+        free(buffer);
+    }
+
+    free(bytes);
+    if (close(fd) != 0) {
+        perror(filename);
+        exit(1);
+    }
+}
+
+// ---------- Raw little-endian binary ----------
+static inline void intToLittleEndian(int32_t* a, size_t n) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = 0; i < n; i++)
+        a[i] = (int32_t)__builtin_bswap32((uint32_t)a[i]);
+#else
+    (void)a;
+    (void)n;
+#endif
+}
+
+static inline int32_t* readBinaryIntegers(const char* filename, size_t* n) {
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(filename);
+        exit(1);
+    }
+    if (st.st_size % sizeof(int32_t) != 0) {
+        fprintf(stderr, "%s: size is not a multiple of 4 bytes\n", filename);
+        exit(1);
+    }
+    *n = (size_t)st.st_size / sizeof(int32_t);
+    int32_t* a = (int32_t*)intIOAlloc(*n * sizeof(int32_t));
+    char* p = (char*)a;
+    size_t left = *n * sizeof(int32_t);
+    while (left > 0) {
+        ssize_t r = read(fd, p, left < INT_IO_CHUNK ? left : INT_IO_CHUNK);
+        if (r <= 0) {
+            perror(filename);
+            exit(1);
+        }
+        p += r;
+        left -= (size_t)r;
+    }
+    close(fd);
+    intToLittleEndian(a, *n);  // the swap is its own inverse
+    return a;
+}
+
+// a[] is temporarily byte-swapped on big-endian hosts
+static inline void writeBinaryIntegers(const char* filename, int32_t* a, size_t n) {
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(filename);
+        exit(1);
+    }
+    intToLittleEndian(a, n);
+    const char* p = (const char*)a;
+    size_t left = n * sizeof(int32_t);
+    off_t at = 0;
+    while (left > 0) {
+        size_t chunk = left < INT_IO_CHUNK ? left : INT_IO_CHUNK;
+        intWriteAll(fd, p, chunk, at, filename);
+        p += chunk;
+        at += (off_t)chunk;
+        left -= chunk;
+    }
+    intToLittleEndian(a, n);
+    if (close(fd) != 0) {
+        perror(filename);
+        exit(1);
+    }
+}
+
+#endif // INT_IO_H
@@ -0,0 +1,159 @@
+/* Introsort for int arrays (Musser 1997).
+
+Quicksort that cannot go quadratic or overflow the stack:
+
+  - pivot: median of three (first, middle, last) for small ranges, Tukey's
+    ninther (median of three medians of three) above INTROSORT_NINTHER,
+  - Hoare partitioning, which does about a third of Lomuto's swaps and
+    splits runs of equal keys evenly,
+  - recursion only into the smaller side, the larger side is handled by
+    the loop, so the stack holds O(log n) frames,
+  - after 2 log2(n) partitioning levels a range is finished by heapsort,
+    bounding the worst case at O(n log n),
+  - ranges of at most INTROSORT_INSERTION elements are insertion-sorted.
+
+Instrumentation is a compile-time policy: define INTROSORT_COUNT before
+including this header to count comparisons, swaps (element moves count
+as one) and heapsort fallbacks in introsortComparisons, introsortSwaps and
+introsortFallbacks. Without it the counting macros expand to nothing. */
+
+#ifndef INTROSORT_H
+#define INTROSORT_H
+
+#include <stddef.h>
+
+// Ranges this small are insertion-sorted
+#define INTROSORT_INSERTION 16
+
+// Ranges above this size take the ninther as pivot
+#define INTROSORT_NINTHER 128
+
+#ifdef INTROSORT_COUNT
+static long long introsortComparisons = 0;
+static long long introsortSwaps = 0;
+static long long introsortFallbacks = 0;
+#define INTROSORT_LESS(x, y) (introsortComparisons++, (x) < (y))
+#define INTROSORT_COUNT_SWAP() (introsortSwaps++)
+#define INTROSORT_COUNT_FALLBACK() (introsortFallbacks++)
+#else
+#define INTROSORT_LESS(x, y) ((x) < (y))
+#define INTROSORT_COUNT_SWAP() ((void)0)
+#define INTROSORT_COUNT_FALLBACK() ((void)0)
+#endif
+
+static inline void introsortSwap(int* a, int* b) {
+    int t = *a;
+    *a = *b;
+    *b = t;
+    INTROSORT_COUNT_SWAP();
+}
+
+// ---------- Small ranges ----------
+static inline void introsortInsertion(int a[], ptrdiff_t n) {
+    for (ptrdiff_t i = 1; i < n; i++) {
+        int x = a[i];
+        ptrdiff_t j = i;
+        for (; j > 0 && INTROSORT_LESS(x, a[j - 1]); j--) {
+            a[j] = a[j - 1];
+            INTROSORT_COUNT_SWAP();
+        }
+        a[j] = x;
+    }
+}
+
+// ---------- Heapsort fallback ----------
+static inline void introsortSiftDown(int a[], ptrdiff_t root, ptrdiff_t n) {
+    int x = a[root];
+    for (;;) {
+        ptrdiff_t child = 2 * root + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && INTROSORT_LESS(a[child], a[child + 1]))
+            child++;
+        if (!INTROSORT_LESS(x, a[child]))
+            break;
+        a[root] = a[child];
+        INTROSORT_COUNT_SWAP();
+        root = child;
+    }
+    a[root] = x;
+}
+
+static inline void introsortHeapsort(int a[], ptrdiff_t n) {
+    for (ptrdiff_t i = n / 2 - 1; i >= 0; i--)
+        introsortSiftDown(a, i, n);
+    for (ptrdiff_t end = n - 1; end > 0; end--) {
+        introsortSwap(&a[0], &a[end]);
+        introsortSiftDown(a, 0, end);
+    }
+}
+
+// ---------- Pivot selection ----------
+// Index of the median of a[i], a[j], a[k]
+static inline ptrdiff_t introsortMedian3(const int a[], ptrdiff_t i, ptrdiff_t j, ptrdiff_t k) {
+    if (INTROSORT_LESS(a[i], a[j])) {
+        if (INTROSORT_LESS(a[j], a[k]))
+            return j;
+        return INTROSORT_LESS(a[i], a[k]) ? k : i;
+    }
+    if (INTROSORT_LESS(a[k], a[j]))
+        return j;
+    return INTROSORT_LESS(a[k], a[i]) ? k : i;
+}
+
+static inline ptrdiff_t introsortPivot(const int a[], ptrdiff_t n) {
+    ptrdiff_t mid = n / 2;
+    if (n <= INTROSORT_NINTHER)
+        return introsortMedian3(a, 0, mid, n - 1);
+    ptrdiff_t s = n / 8;
+    return introsortMedian3(a, introsortMedian3(a, 0, s, 2 * s),
+                            introsortMedian3(a, mid - s, mid, mid + s),
+                            introsortMedian3(a, n - 1 - 2 * s, n - 1 - s, n - 1));
+}
+
+// ---------- Hoare partition ----------
+// Pivot value is a[0]. Returns p with a[0 .. p] <= pivot <= a[p+1 .. n),
+// 0 <= p < n - 1, so both sides are non-empty.
+static inline ptrdiff_t introsortPartition(int a[], ptrdiff_t n) {
+    int pivot = a[0];
+    ptrdiff_t i = -1, j = n;
+    for (;;) {
+        do i++; while (INTROSORT_LESS(a[i], pivot));
+        do j--; while (INTROSORT_LESS(pivot, a[j]));
+        if (i >= j)
+            return j;
+        introsortSwap(&a[i], &a[j]);
+    }
+}
+
+static inline void introsortLoop(int a[], ptrdiff_t n, int depthLimit) {
+    while (n > INTROSORT_INSERTION) {
+        if (depthLimit-- == 0) {
+            INTROSORT_COUNT_FALLBACK();
+            introsortHeapsort(a, n);
+            return;
+        }
+        introsortSwap(&a[0], &a[introsortPivot(a, n)]);
+        ptrdiff_t p = introsortPartition(a, n) + 1;
+
+        // Recurse into the smaller side, keep looping on the larger
+        if (p < n - p) {
+            introsortLoop(a, p, depthLimit);
+            a += p;
+            n -= p;
+        } else {
+            introsortLoop(a + p, n - p, depthLimit);
+            n = p;
+        }
+    }
+    introsortInsertion(a, n);
+}
+
+static inline void introsort(int a[], size_t n) {
+    int depthLimit = 0;
+    for (size_t m = n; m > 1; m >>= 1)
+        depthLimit += 2;
+    introsortLoop(a, (ptrdiff_t)n, depthLimit);
+}
+
+#endif // INTROSORT_H
@@ -0,0 +1,616 @@
+/* 0/1 knapsack engine (CLRS 16.2, the DP of exercise 16.2-2)
+
+Items have non-negative integer weights and values; W is the capacity.
+Two dynamic programming modes and a branch and bound engine:
+
+  KNAPSACK_SEQUENTIAL    one thread
+  KNAPSACK_PARALLEL      every item's row update is split into one
+                         capacity slice per OpenMP thread, with a barrier
+                         between items. This is meant for W in the
+                         hundreds of millions, where one row is far larger
+                         than the caches and each slice is a long
+                         streaming loop. Below KNAPSACK_PARALLEL_MIN cells
+                         it runs sequentially.
+  KNAPSACK_BRANCH_BOUND  depth-first branch and bound (below), whose cost
+                         does not depend on W
+  KNAPSACK_AUTO          the DP while n (W + 1) <= KNAPSACK_DP_MAX_CELLS
+                         and its rows fit in KNAPSACK_DP_MAX_BYTES (the
+                         parallel DP when more than one thread is
+                         available), branch and bound otherwise
+
+The table is never stored. A row f[c] is the best value with weight at
+most c. Item (w, v) maps row f to row g by
+
+  g[c] = f[c]                        c < w
+  g[c] = max(f[c], f[c - w] + v)     c >= w
+
+Reading f and writing g (two rows, ping-pong) lets the loop be a plain
+elementwise max with no dependency between iterations, so the compiler
+can vectorise it (-O3, and -march=native for wide vectors).
+
+knapsackValue needs 2 (W + 1) values of memory. knapsackSolve also
+returns the chosen items, using Hirschberg's divide and conquer in
+3 (W + 1) values:
+
+  - split the items into halves A and B and compute the rows fA and fB,
+  - the best total is max over c of fA[c] + fB[W - c]; the maximising c is
+    the capacity A gets in some optimal solution,
+  - recurse on (A, c) and (B, W - c).
+
+Every level of the recursion splits the capacity among its subproblems,
+so level k costs at most n W / 2^k. The total is under twice the
+value-only DP. A subproblem whose full decision table fits in
+KNAPSACK_TABLE_BITS bits is solved directly by backtracking over a
+bitmap. One whose items all fit takes every item of positive value.
+
+Branch and bound (Horowitz-Sahni search, Martello-Toth reduction) sorts
+the items by value density v / w. Taking them greedily in that order
+stops at the break item b. The Dantzig bound is the LP relaxation:
+everything before b plus the fitting fraction of b. Then:
+
+  1. Core problem: the items within KNAPSACK_CORE places of b are searched
+     exactly, with the denser ones fixed in and the sparser ones fixed
+     out. This is usually optimal or nearly, and gives a lower bound z.
+  2. Reduction: an item is fixed to its greedy value when the Dantzig
+     bound with it flipped is at most z. No better solution can then
+     flip it.
+  3. The items that remain free are searched depth first. Each node takes
+     the next item when it fits and is cut when its profit plus the
+     Dantzig bound of the rest cannot beat z. Prefix sums and a binary
+     search give each bound in O(log n).
+
+knapsackOptimize runs any of the four modes. With a time limit, branch
+and bound returns the best solution found so far and clears the optimal
+flag. The DP modes always run to completion.
+
+Invalid input (negative weights, values or capacity) exits with a
+message. Compile with -fopenmp for KNAPSACK_PARALLEL. */
+
+#ifndef KNAPSACK_H
+#define KNAPSACK_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Rows shorter than this are updated by one thread even in parallel mode
+#define KNAPSACK_PARALLEL_MIN (1 << 16)
+
+// Subproblems with at most this many (item, capacity) cells keep a
+// decision bitmap instead of recursing
+#define KNAPSACK_TABLE_BITS (1 << 24)
+
+// Automatic mode: larger DP instances go to branch and bound
+#define KNAPSACK_DP_MAX_CELLS 4000000000LL
+#define KNAPSACK_DP_MAX_BYTES (1LL << 31)
+
+// Items on each side of the break item in the core problem
+#define KNAPSACK_CORE 32
+
+// Search nodes between two looks at the clock
+#define KNAPSACK_CLOCK_NODES 4096
+
+enum KnapsackMode {
+    KNAPSACK_SEQUENTIAL,
+    KNAPSACK_PARALLEL,
+    KNAPSACK_BRANCH_BOUND,
+    KNAPSACK_AUTO
+};
+
+static inline const char* knapsackModeName(enum KnapsackMode mode) {
+    switch (mode) {
+    case KNAPSACK_SEQUENTIAL:   return "sequential";
+    case KNAPSACK_PARALLEL:     return "parallel";
+    case KNAPSACK_BRANCH_BOUND: return "branch-bound";
+    case KNAPSACK_AUTO:         return "auto";
+    }
+    return "?";
+}
+
+static inline int parseKnapsackMode(const char* name, enum KnapsackMode* mode) {
+    for (int m = KNAPSACK_SEQUENTIAL; m <= KNAPSACK_AUTO; m++)
+        if (strcmp(name, knapsackModeName((enum KnapsackMode)m)) == 0) {
+            *mode = (enum KnapsackMode)m;
+            return 1;
+        }
+    return 0;
+}
+
+static inline void* knapsackAlloc(size_t bytes) {
+    void* p = malloc(bytes ? bytes : 1);
+    if (p == NULL) {
+        perror("Knapsack allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+static inline void knapsackCheck(const long long* weight, const long long* value, int n, long long W) {
+    if (n < 0) {
+        fprintf(stderr, "Knapsack item count must be non-negative\n");
+        exit(1);
+    }
+    if (W < 0) {
+        fprintf(stderr, "Knapsack capacity must be non-negative\n");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++)
+        if (weight[i] < 0 || value[i] < 0) {
+            fprintf(stderr, "Knapsack item %d has a negative weight or value\n", i);
+            exit(1);
+        }
+}
+
+// ---------- Row update ----------
+// to[c] for c in [lo, hi) from row `from` after offering item (w, v)
+static inline void knapsackRow(const long long* restrict from, long long* restrict to,
+                               long long lo, long long hi, long long w, long long v) {
+    long long split = w < lo ? lo : w < hi ? w : hi;
+    if (split > lo)
+        memcpy(to + lo, from + lo, (split - lo) * sizeof(long long));
+    const long long* shifted = from - w;
+    for (long long c = split; c < hi; c++) {
+        long long keep = from[c], take = shifted[c] + v;
+        to[c] = keep > take ? keep : take;
+    }
+}
+
+// Items that can change a row of capacity C
+static inline int knapsackUseful(const long long* weight, const long long* value, int i, long long C) {
+    return weight[i] <= C && value[i] > 0;
+}
+
+// Best value for every capacity 0..C using items [lo, hi). a and b hold
+// C + 1 values each; returns whichever of them ends up with the row.
+static inline long long* knapsackRows(const long long* weight, const long long* value, int lo, int hi,
+                                      long long C, long long* a, long long* b, int parallel) {
+    int useful = 0;
+    for (int i = lo; i < hi; i++)
+        useful += knapsackUseful(weight, value, i, C);
+    parallel = parallel && C + 1 >= KNAPSACK_PARALLEL_MIN;
+
+    #pragma omp parallel if(parallel)
+    {
+        int t = 0, T = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        T = omp_get_num_threads();
+#endif
+        // Each thread owns one capacity slice for all items, so it also
+        // zeroes it (first touch places the pages near the thread)
+        long long cells = C + 1;
+        long long begin = cells / T * t, end = t == T - 1 ? cells : cells / T * (t + 1);
+        memset(a + begin, 0, (end - begin) * sizeof(long long));
+
+        int k = 0;
+        for (int i = lo; i < hi; i++) {
+            if (!knapsackUseful(weight, value, i, C))
+                continue;
+            const long long* from = k & 1 ? b : a;
+            long long* to = k & 1 ? a : b;
+            // Row k reads the slices other threads wrote for row k - 1
+            #pragma omp barrier
+            knapsackRow(from, to, begin, end, weight[i], value[i]);
+            k++;
+        }
+    }
+    return useful & 1 ? b : a;
+}
+
+// Returns the maximum total value of items with total weight at most W
+static inline long long knapsackValue(const long long* weight, const long long* value, int n, long long W,
+                                      enum KnapsackMode mode) {
+    knapsackCheck(weight, value, n, W);
+    long long* a = (long long*)knapsackAlloc((W + 1) * sizeof(long long));
+    long long* b = (long long*)knapsackAlloc((W + 1) * sizeof(long long));
+    long long best = knapsackRows(weight, value, 0, n, W, a, b, mode == KNAPSACK_PARALLEL)[W];
+    free(a);
+    free(b);
+    return best;
+}
+
+// ---------- Reconstruction ----------
+struct KnapsackSolver {
+    const long long *weight, *value;
+    unsigned char* take;
+    long long* row[3];  // W + 1 values each
+    uint64_t* bits;     // KNAPSACK_TABLE_BITS decision bits
+    int parallel;
+};
+
+// Full DP over items [lo, hi) and capacities 0..C with one decision bit
+// per cell, then backtrack from C
+static inline void knapsackTable(struct KnapsackSolver* s, int lo, int hi, long long C) {
+    long long* f = s->row[0];
+    long long stride = C + 1;
+    memset(f, 0, stride * sizeof(long long));
+    memset(s->bits, 0, (((hi - lo) * stride + 63) / 64) * sizeof(uint64_t));
+    for (int i = lo; i < hi; i++) {
+        long long w = s->weight[i], v = s->value[i];
+        if (!knapsackUseful(s->weight, s->value, i, C))
+            continue;
+        long long base = (i - lo) * stride;
+        // Descending capacities: f[c - w] still holds the previous row
+        for (long long c = C; c >= w; c--)
+            if (f[c - w] + v > f[c]) {
+                f[c] = f[c - w] + v;
+                s->bits[(base + c) >> 6] |= 1ull << ((base + c) & 63);
+            }
+    }
+    long long c = C;
+    for (int i = hi - 1; i >= lo; i--) {
+        long long cell = (i - lo) * stride + c;
+        if (s->bits[cell >> 6] >> (cell & 63) & 1) {
+            s->take[i] = 1;
+            c -= s->weight[i];
+        }
+    }
+}
+
+static inline void knapsackSplit(struct KnapsackSolver* s, int lo, int hi, long long C) {
+    long long total = 0;
+    for (int i = lo; i < hi && total <= C; i++)
+        total += s->weight[i];
+    if (total <= C) {
+        // Everything fits
+        for (int i = lo; i < hi; i++)
+            s->take[i] = s->value[i] > 0;
+        return;
+    }
+    if (hi - lo == 1)
+        return;  // a single item that does not fit
+    if ((long long)(hi - lo) * (C + 1) <= KNAPSACK_TABLE_BITS) {
+        knapsackTable(s, lo, hi, C);
+        return;
+    }
+
+    int mid = lo + (hi - lo) / 2;
+    long long* left = knapsackRows(s->weight, s->value, lo, mid, C, s->row[0], s->row[1], s->parallel);
+    long long* spare = left == s->row[0] ? s->row[1] : s->row[0];
+    long long* right = knapsackRows(s->weight, s->value, mid, hi, C, spare, s->row[2], s->parallel);
+
+    long long bestC = 0, best = -1;
+    for (long long c = 0; c <= C; c++)
+        if (left[c] + right[C - c] > best) {
+            best = left[c] + right[C - c];
+            bestC = c;
+        }
+
+    knapsackSplit(s, lo, mid, bestC);
+    knapsackSplit(s, mid, hi, C - bestC);
+}
+
+// Dynamic programming: returns the optimal value and sets take[i] to 1 for
+// the chosen items (0 for the rest). Their total weight is at most W.
+static inline long long knapsackSolve(const long long* weight, const long long* value, int n, long long W,
+                                      enum KnapsackMode mode, unsigned char* take) {
+    knapsackCheck(weight, value, n, W);
+    memset(take, 0, n);
+
+    struct KnapsackSolver s;
+    s.weight = weight;
+    s.value = value;
+    s.take = take;
+    s.parallel = mode == KNAPSACK_PARALLEL;
+    for (int r = 0; r < 3; r++)
+        s.row[r] = (long long*)knapsackAlloc((W + 1) * sizeof(long long));
+    s.bits = (uint64_t*)knapsackAlloc(KNAPSACK_TABLE_BITS / 8 + sizeof(uint64_t));
+
+    if (n > 0)
+        knapsackSplit(&s, 0, n, W);
+
+    long long best = 0;
+    for (int i = 0; i < n; i++)
+        if (take[i])
+            best += value[i];
+
+    for (int r = 0; r < 3; r++)
+        free(s.row[r]);
+    free(s.bits);
+    return best;
+}
+
+// ---------- Branch and bound ----------
+struct KnapsackItem {
+    long long weight, value;
+    int index;  // position in the caller's arrays
+};
+
+// Denser items first; densities compared exactly by cross-multiplying
+static inline int knapsackCompareDensity(const void* a, const void* b) {
+    const struct KnapsackItem* x = (const struct KnapsackItem*)a;
+    const struct KnapsackItem* y = (const struct KnapsackItem*)b;
+    __int128 l = (__int128)x->value * y->weight, r = (__int128)y->value * x->weight;
+    return (l < r) - (l > r);
+}
+
+// The fitting fraction of item (w, v) in capacity c, rounded down
+static inline long long knapsackFraction(long long c, long long w, long long v) {
+    return (long long)((__int128)c * v / w);
+}
+
+// Dantzig bound of the items [i, m) of a density-sorted list with prefix
+// sums pw, pv (pw[k] = weight of the first k items) in capacity c
+static inline long long knapsackDantzig(const struct KnapsackItem* it, const long long* pw, const long long* pv,
+                                        int m, int i, long long c) {
+    // Largest t with pw[t] - pw[i] <= c
+    int lo = i, hi = m;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (pw[mid] - pw[i] <= c)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    long long bound = pv[lo] - pv[i];
+    if (lo < m)
+        bound += knapsackFraction(c - (pw[lo] - pw[i]), it[lo].weight, it[lo].value);
+    return bound;
+}
+
+// Dantzig bound of every item except j, in capacity c
+static inline long long knapsackDantzigWithout(const struct KnapsackItem* it, const long long* pw,
+                                               const long long* pv, int m, int j, long long c) {
+    int lo = 0, hi = m;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (pw[mid] - (j < mid ? it[j].weight : 0) <= c)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    // lo != j: the prefix weight does not grow from j to j + 1
+    long long used = pw[lo] - (j < lo ? it[j].weight : 0);
+    long long bound = pv[lo] - (j < lo ? it[j].value : 0);
+    if (lo < m)
+        bound += knapsackFraction(c - used, it[lo].weight, it[lo].value);
+    return bound;
+}
+
+struct KnapsackSearch {
+    const struct KnapsackItem* it;  // free items, density order
+    int m;
+    long long *pw, *pv;             // m + 1 prefix sums
+    unsigned char *x, *best;        // current and best assignment
+    long long bestValue;            // z, the value to beat
+    int improved;
+    long long nodes;
+    double deadline;                // CLOCK_MONOTONIC seconds, 0 = none
+    int timedOut;
+};
+
+static inline double knapsackClock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Depth-first search over s->it in capacity c for a total strictly above
+// s->bestValue. An improvement is copied into s->best.
+static inline void knapsackDFS(struct KnapsackSearch* s, long long c) {
+    const struct KnapsackItem* it = s->it;
+    int m = s->m, k = 0;
+    long long p = 0;
+
+    for (;;) {
+        int backtrack = 0;
+        if (++s->nodes % KNAPSACK_CLOCK_NODES == 0 && s->deadline > 0 && knapsackClock() > s->deadline) {
+            s->timedOut = 1;
+            return;
+        }
+        if (k == m) {
+            if (p > s->bestValue) {
+                s->bestValue = p;
+                s->improved = 1;
+                memcpy(s->best, s->x, m);
+            }
+            backtrack = 1;
+        } else if (p + knapsackDantzig(it, s->pw, s->pv, m, k, c) <= s->bestValue) {
+            backtrack = 1;
+        } else if (it[k].weight <= c) {
+            s->x[k] = 1;
+            c -= it[k].weight;
+            p += it[k].value;
+            k++;
+        } else {
+            s->x[k++] = 0;
+        }
+
+        if (backtrack) {
+            // Undo back to the deepest item taken and try leaving it out
+            do
+                k--;
+            while (k >= 0 && !s->x[k]);
+            if (k < 0)
+                return;
+            s->x[k] = 0;
+            c += it[k].weight;
+            p -= it[k].value;
+            k++;
+        }
+    }
+}
+
+// Searches items [lo, hi) of the sorted list in capacity c, the items
+// before lo taken, the rest left out. On improvement writes the complete
+// assignment to sel[] and returns 1.
+static inline int knapsackSearchRange(const struct KnapsackItem* it, int lo, int hi, long long c, long long fixedValue,
+                                      long long* bestValue, unsigned char* sel, int m, double deadline,
+                                      long long* nodes, int* timedOut) {
+    int r = hi - lo;
+    struct KnapsackSearch s;
+    s.it = it + lo;
+    s.m = r;
+    s.pw = (long long*)knapsackAlloc((r + 1) * sizeof(long long));
+    s.pv = (long long*)knapsackAlloc((r + 1) * sizeof(long long));
+    s.x = (unsigned char*)knapsackAlloc(r);
+    s.best = (unsigned char*)knapsackAlloc(r);
+    s.pw[0] = s.pv[0] = 0;
+    for (int k = 0; k < r; k++) {
+        s.pw[k + 1] = s.pw[k] + s.it[k].weight;
+        s.pv[k + 1] = s.pv[k] + s.it[k].value;
+    }
+    s.bestValue = *bestValue - fixedValue;
+    s.improved = 0;
+    s.nodes = 0;
+    s.deadline = deadline;
+    s.timedOut = 0;
+
+    knapsackDFS(&s, c);
+
+    if (s.improved) {
+        *bestValue = s.bestValue + fixedValue;
+        memset(sel, 1, lo);
+        memcpy(sel + lo, s.best, r);
+        memset(sel + hi, 0, m - hi);
+    }
+    *nodes += s.nodes;
+    *timedOut |= s.timedOut;
+    free(s.pw);
+    free(s.pv);
+    free(s.x);
+    free(s.best);
+    return s.improved;
+}
+
+// Branch and bound; returns the best value found and sets take[]. *optimal
+// is 0 if the time limit (seconds > 0) cut the search short. *nodes gets
+// the number of search nodes.
+static inline long long knapsackBranchBound(const long long* weight, const long long* value, int n, long long W,
+                                            double seconds, unsigned char* take, int* optimal, long long* nodes) {
+    knapsackCheck(weight, value, n, W);
+    double deadline = seconds > 0 ? knapsackClock() + seconds : 0;
+    memset(take, 0, n);
+    *nodes = 0;
+    *optimal = 1;
+
+    // Weightless items are always taken, useless ones never
+    struct KnapsackItem* it = (struct KnapsackItem*)knapsackAlloc(n * sizeof(struct KnapsackItem));
+    long long freeValue = 0;
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        if (value[i] == 0 || weight[i] > W)
+            continue;
+        if (weight[i] == 0) {
+            take[i] = 1;
+            freeValue += value[i];
+            continue;
+        }
+        it[m++] = (struct KnapsackItem){weight[i], value[i], i};
+    }
+    qsort(it, m, sizeof(struct KnapsackItem), knapsackCompareDensity);
+
+    long long* pw = (long long*)knapsackAlloc((m + 1) * sizeof(long long));
+    long long* pv = (long long*)knapsackAlloc((m + 1) * sizeof(long long));
+    pw[0] = pv[0] = 0;
+    for (int k = 0; k < m; k++) {
+        pw[k + 1] = pw[k] + it[k].weight;
+        pv[k + 1] = pv[k] + it[k].value;
+    }
+    int b = 0;
+    while (b < m && pw[b + 1] <= W)
+        b++;
+
+    // Lower bound: the greedy prefix, then any later item that still fits
+    unsigned char* sel = (unsigned char*)knapsackAlloc(m);
+    long long z = 0, c = W;
+    for (int k = 0; k < m; k++) {
+        sel[k] = it[k].weight <= c;
+        if (sel[k]) {
+            c -= it[k].weight;
+            z += it[k].value;
+        }
+    }
+
+    if (b < m) {
+        // 1. Core problem around the break item
+        int lo = b > KNAPSACK_CORE ? b - KNAPSACK_CORE : 0;
+        int hi = b + KNAPSACK_CORE < m ? b + KNAPSACK_CORE : m;
+        int timedOut = 0;
+        knapsackSearchRange(it, lo, hi, W - pw[lo], pv[lo], &z, sel, m, deadline, nodes, &timedOut);
+
+        // 2. Reduction against z: flipping item k must be able to beat z
+        int* freeItems = (int*)knapsackAlloc(m * sizeof(int));
+        int f = 0;
+        long long fixedWeight = 0, fixedValue = 0;
+        for (int k = 0; k < m && !timedOut; k++) {
+            long long flipped = k < b ? knapsackDantzigWithout(it, pw, pv, m, k, W)
+                                      : it[k].value + knapsackDantzigWithout(it, pw, pv, m, k, W - it[k].weight);
+            if (flipped > z)
+                freeItems[f++] = k;
+            else if (k < b) {
+                fixedWeight += it[k].weight;
+                fixedValue += it[k].value;
+            }
+        }
+
+        // 3. Exact search over the free items, denser fixed items taken
+        if (!timedOut && f > 0 && fixedWeight <= W) {
+            struct KnapsackItem* reduced = (struct KnapsackItem*)knapsackAlloc(f * sizeof(struct KnapsackItem));
+            for (int k = 0; k < f; k++)
+                reduced[k] = it[freeItems[k]];
+            unsigned char* reducedSel = (unsigned char*)knapsackAlloc(f);
+            if (knapsackSearchRange(reduced, 0, f, W - fixedWeight, fixedValue, &z, reducedSel, f, deadline,
+                                    nodes, &timedOut)) {
+                for (int k = 0; k < m; k++)
+                    sel[k] = k < b;
+                for (int k = 0; k < f; k++)
+                    sel[freeItems[k]] = reducedSel[k];
+            }
+            free(reduced);
+            free(reducedSel);
+        }
+        *optimal = !timedOut;
+        free(freeItems);
+    }
+
+    for (int k = 0; k < m; k++)
+        take[it[k].index] = sel[k];
+    free(sel);
+    free(pw);
+    free(pv);
+    free(it);
+    return z + freeValue;
+}
+
+// ---------- Engine selection ----------
+struct KnapsackResult {
+    long long value;
+    enum KnapsackMode engine;  // the engine that ran (never KNAPSACK_AUTO)
+    int optimal;               // 0 if branch and bound hit the time limit
+    long long nodes;           // branch and bound search nodes
+};
+
+static inline enum KnapsackMode knapsackChooseEngine(int n, long long W) {
+    if (W < KNAPSACK_DP_MAX_BYTES / (3 * (long long)sizeof(long long)) &&
+        (double)n * (W + 1) <= (double)KNAPSACK_DP_MAX_CELLS) {
+#ifdef _OPENMP
+        if (omp_get_max_threads() > 1 && W + 1 >= KNAPSACK_PARALLEL_MIN)
+            return KNAPSACK_PARALLEL;
+#endif
+        return KNAPSACK_SEQUENTIAL;
+    }
+    return KNAPSACK_BRANCH_BOUND;
+}
+
+// Solves with the given mode; seconds > 0 limits branch and bound
+static inline struct KnapsackResult knapsackOptimize(const long long* weight, const long long* value, int n,
+                                                     long long W, enum KnapsackMode mode, double seconds,
+                                                     unsigned char* take) {
+    struct KnapsackResult r = {0, mode, 1, 0};
+    if (mode == KNAPSACK_AUTO)
+        r.engine = knapsackChooseEngine(n, W);
+    if (r.engine == KNAPSACK_BRANCH_BOUND)
+        r.value = knapsackBranchBound(weight, value, n, W, seconds, take, &r.optimal, &r.nodes);
+    else
+        r.value = knapsackSolve(weight, value, n, W, r.engine, take);
+    return r;
+}
+
+#endif // KNAPSACK_H
@@ -0,0 +1,435 @@
+/* Matrix-chain ordering (CLRS 15.2) for long chains
+
+Matrix i (0-based) is p[i] x p[i + 1], for n matrices and n + 1 dimensions.
+Costs are scalar multiplications in 64-bit integers, so any chain whose
+optimal or heuristic cost fits in a long long is handled. In the DP every
+candidate cost saturates at LLONG_MAX, so a split whose cost would
+overflow is never chosen over one that fits. Three modes:
+
+  MATRIX_CHAIN_DP        the O(n^3) CLRS recurrence
+                           m[i][j] = min over i <= k < j of
+                                     m[i][k] + m[k+1][j] + p[i] p[k+1] p[j+1]
+  MATRIX_CHAIN_PARALLEL  the same recurrence computed as a wavefront: all
+                         cells of one chain length l (one anti-diagonal)
+                         depend only on shorter chains, so each diagonal is
+                         one OpenMP for loop over i
+  MATRIX_CHAIN_HU_SHING  Hu and Shing's O(n) near-optimal partition of the
+                         polygon view, at most about 15% above optimal,
+                         for chains too long for O(n^3)
+
+Both DP modes keep the costs in one heap-allocated n x n array holding two
+triangles. m[i][j] sits above the diagonal, and the same value is mirrored
+at [j][i]. The inner loop over k then reads row i (m[i][k]) and row j
+(m[k+1][j] at [j][k+1]) contiguously. Split points go into a packed upper
+triangle of n (n + 1) / 2 ints.
+
+Hu-Shing: the chain is the convex polygon V0 .. Vn, where vertex Vi has
+weight p[i], side Vi Vi+1 is matrix i and side V0 Vn is the product.
+A triangulation is a parenthesization, and triangle (a, b, c) costs
+p[a] p[b] p[c]. The sweep starts at a vertex V1 of minimum weight and
+pushes the vertices in polygon order. When vertex c arrives, the top t is
+cut off while
+
+  1 / w(V1) + 1 / w(t) < 1 / w(a) + 1 / w(c)      (a = vertex below t)
+
+This is the test that arc a-c beats arc V1-t in quadrilateral V1 a t c.
+Each cut adds triangle (a, t, c). The vertices left on the stack form a
+fan from V1.
+
+The result is a MatrixChainPlan: its n - 1 multiplications in an order
+that can be executed directly. Operand x < n is matrix x, and x >= n is
+the result of step x - n. */
+
+#ifndef MATRIX_CHAIN_H
+#define MATRIX_CHAIN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+enum MatrixChainMode {
+    MATRIX_CHAIN_DP,
+    MATRIX_CHAIN_PARALLEL,
+    MATRIX_CHAIN_HU_SHING
+};
+
+struct MatrixChainStep {
+    int left, right;  // operands, see above
+};
+
+struct MatrixChainPlan {
+    int n;                         // matrices
+    long long cost;                // scalar multiplications
+    struct MatrixChainStep* step;  // n - 1 multiplications, in execution order
+};
+
+static inline const char* matrixChainModeName(enum MatrixChainMode mode) {
+    switch (mode) {
+    case MATRIX_CHAIN_DP:       return "dp";
+    case MATRIX_CHAIN_PARALLEL: return "parallel";
+    case MATRIX_CHAIN_HU_SHING: return "hu-shing";
+    }
+    return "?";
+}
+
+static inline int parseMatrixChainMode(const char* name, enum MatrixChainMode* mode) {
+    for (int m = MATRIX_CHAIN_DP; m <= MATRIX_CHAIN_HU_SHING; m++)
+        if (strcmp(name, matrixChainModeName((enum MatrixChainMode)m)) == 0) {
+            *mode = (enum MatrixChainMode)m;
+            return 1;
+        }
+    return 0;
+}
+
+static inline void* matrixChainAlloc(size_t bytes) {
+    void* p = malloc(bytes ? bytes : 1);
+    if (p == NULL) {
+        perror("Matrix chain allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+// Packed upper triangle, row-major, i <= j < n
+static inline size_t matrixChainIndex(int i, int j, int n) {
+    return (size_t)i * n - (size_t)i * (i - 1) / 2 + (j - i);
+}
+
+// ---------- Plan construction ----------
+// Builds the steps for matrices [i, j] whose split point is found by
+// split(context, i, j) (the last matrix of the left part). Post-order with
+// an explicit stack, so degenerate chains do not recurse n deep.
+static inline void matrixChainBuildSteps(struct MatrixChainPlan* plan,
+                                         int (*split)(const void*, int, int), const void* context) {
+    int n = plan->n;
+    if (n < 2)
+        return;
+    struct Frame { int i, j, k, state; } *stack = (struct Frame*)matrixChainAlloc(n * sizeof(struct Frame));
+    int* result = (int*)matrixChainAlloc(n * sizeof(int));  // operand of each finished frame
+    int top = 0, steps = 0, done = 0;
+    stack[0] = (struct Frame){0, n - 1, 0, 0};
+
+    while (top >= 0) {
+        struct Frame* f = &stack[top];
+        if (f->i == f->j) {
+            result[done++] = f->i;
+            top--;
+            continue;
+        }
+        if (f->state == 0) {
+            f->k = split(context, f->i, f->j);
+            f->state = 1;
+            stack[++top] = (struct Frame){f->i, f->k, 0, 0};
+        } else if (f->state == 1) {
+            f->state = 2;
+            stack[++top] = (struct Frame){f->k + 1, f->j, 0, 0};
+        } else {
+            plan->step[steps] = (struct MatrixChainStep){result[done - 2], result[done - 1]};
+            done -= 2;
+            result[done++] = n + steps++;
+            top--;
+        }
+    }
+    free(stack);
+    free(result);
+}
+
+// Scalar multiplications the plan performs on dimensions p
+static inline long long matrixChainPlanCost(const struct MatrixChainPlan* plan, const long long* p) {
+    int n = plan->n;
+    if (n < 2)
+        return 0;
+    // First and last matrix covered by every operand
+    int* first = (int*)matrixChainAlloc((2 * n - 1) * sizeof(int));
+    int* last = (int*)matrixChainAlloc((2 * n - 1) * sizeof(int));
+    for (int i = 0; i < n; i++)
+        first[i] = last[i] = i;
+    long long cost = 0;
+    for (int s = 0; s < n - 1; s++) {
+        int l = plan->step[s].left, r = plan->step[s].right;
+        cost += p[first[l]] * p[last[l] + 1] * p[last[r] + 1];
+        first[n + s] = first[l];
+        last[n + s] = last[r];
+    }
+    free(first);
+    free(last);
+    return cost;
+}
+
+static inline struct MatrixChainPlan* newMatrixChainPlan(int n) {
+    struct MatrixChainPlan* plan = (struct MatrixChainPlan*)matrixChainAlloc(sizeof(struct MatrixChainPlan));
+    plan->n = n;
+    plan->cost = 0;
+    plan->step = (struct MatrixChainStep*)matrixChainAlloc((n > 1 ? n - 1 : 1) * sizeof(struct MatrixChainStep));
+    return plan;
+}
+
+static inline void freeMatrixChainPlan(struct MatrixChainPlan* plan) {
+    if (plan) {
+        free(plan->step);
+        free(plan);
+    }
+}
+
+// ---------- Dynamic programming ----------
+struct MatrixChainTable {
+    int n;
+    const int* s;
+};
+
+static inline int matrixChainTableSplit(const void* context, int i, int j) {
+    const struct MatrixChainTable* t = (const struct MatrixChainTable*)context;
+    return t->s[matrixChainIndex(i, j, t->n)];
+}
+
+// Fills cell (i, j) from the shorter chains; m is the mirrored square.
+// A split that is not optimal may cost more than 64 bits even when the
+// optimum fits, so a cost that does not fit is stored as LLONG_MAX instead
+// of overflowing. rowMax[i] is the largest m[i][k] filled so far and
+// colMax[j] the largest m[k][j], and maxDim is the largest dimension (at
+// least 1). Together they bound every candidate of the cell: if the bound
+// fits, the plain 64-bit loop runs, otherwise the candidates are summed in
+// 128 bits. Cells of one diagonal touch different rows and columns, so the
+// wavefront can update the maxima without synchronisation.
+static inline void matrixChainCell(long long* m, int* s, const long long* p, int n, int i, int j, long long maxDim,
+                                   long long* rowMax, long long* colMax) {
+    const long long* row = m + (size_t)i * n;      // m[i][k]
+    const long long* col = m + (size_t)j * n + 1;  // m[k + 1][j], mirrored
+    long long outer, bound, best;
+    int bestK = i;
+    if (!__builtin_mul_overflow(p[i], p[j + 1], &outer) && !__builtin_mul_overflow(outer, maxDim, &bound)
+        && !__builtin_add_overflow(bound, rowMax[i], &bound) && !__builtin_add_overflow(bound, colMax[j], &bound)) {
+        best = row[i] + col[i] + outer * p[i + 1];
+        for (int k = i + 1; k < j; k++) {
+            long long q = row[k] + col[k] + outer * p[k + 1];
+            if (q < best) {
+                best = q;
+                bestK = k;
+            }
+        }
+    } else {
+        __int128 wideOuter = (__int128)p[i] * p[j + 1], wideBest = -1;
+        for (int k = i; k < j; k++) {
+            __int128 q = (__int128)row[k] + col[k] + wideOuter * p[k + 1];
+            if (wideBest < 0 || q < wideBest) {
+                wideBest = q;
+                bestK = k;
+            }
+        }
+        best = wideBest > LLONG_MAX ? LLONG_MAX : (long long)wideBest;
+    }
+    m[(size_t)i * n + j] = m[(size_t)j * n + i] = best;
+    s[matrixChainIndex(i, j, n)] = bestK;
+    if (best > rowMax[i])
+        rowMax[i] = best;
+    if (best > colMax[j])
+        colMax[j] = best;
+}
+
+static inline void matrixChainDP(struct MatrixChainPlan* plan, const long long* p, int parallel) {
+    int n = plan->n;
+    long long* m = (long long*)matrixChainAlloc((size_t)n * n * sizeof(long long));
+    int* s = (int*)matrixChainAlloc(matrixChainIndex(n - 1, n - 1, n) * sizeof(int) + sizeof(int));
+    long long* rowMax = (long long*)matrixChainAlloc(2 * (size_t)n * sizeof(long long));
+    long long* colMax = rowMax + n;
+    long long maxDim = 1;
+    for (int i = 0; i <= n; i++)
+        if (p[i] > maxDim)
+            maxDim = p[i];
+    for (int i = 0; i < n; i++) {
+        m[(size_t)i * n + i] = 0;
+        rowMax[i] = colMax[i] = 0;
+    }
+#ifndef _OPENMP
+    (void)parallel;
+#endif
+
+    #pragma omp parallel if(parallel)
+    for (int l = 1; l < n; l++) {
+        // Diagonal l needs every shorter diagonal; the loop's barrier
+        // separates them
+        #pragma omp for schedule(static)
+        for (int i = 0; i < n - l; i++)
+            matrixChainCell(m, s, p, n, i, i + l, maxDim, rowMax, colMax);
+    }
+
+    plan->cost = m[n - 1];
+    struct MatrixChainTable table = {n, s};
+    matrixChainBuildSteps(plan, matrixChainTableSplit, &table);
+    free(m);
+    free(s);
+    free(rowMax);
+}
+
+// ---------- Hu-Shing near-optimal partition ----------
+// Triangle (a, b, c) of the polygon, a < b < c, keyed by its base arc a-c
+struct MatrixChainTriangle {
+    long long key;  // a * (n + 1) + c
+    int apex;       // b
+};
+
+static inline int compareMatrixChainTriangles(const void* x, const void* y) {
+    long long a = ((const struct MatrixChainTriangle*)x)->key, b = ((const struct MatrixChainTriangle*)y)->key;
+    return (a > b) - (a < b);
+}
+
+struct MatrixChainTriangulation {
+    int n;
+    const struct MatrixChainTriangle* t;
+};
+
+// Matrices [i, j] span arc Vi-Vj+1; the apex b splits them after b - 1
+static inline int matrixChainTriangleSplit(const void* context, int i, int j) {
+    const struct MatrixChainTriangulation* tr = (const struct MatrixChainTriangulation*)context;
+    struct MatrixChainTriangle key = {(long long)i * (tr->n + 1) + j + 1, 0};
+    const struct MatrixChainTriangle* found = (const struct MatrixChainTriangle*)bsearch(
+        &key, tr->t, tr->n - 1, sizeof(struct MatrixChainTriangle), compareMatrixChainTriangles);
+    return found->apex - 1;
+}
+
+// Records triangle (x, y, z) under its base arc
+static inline void matrixChainAddTriangle(struct MatrixChainTriangle* t, int* count, int V, int x, int y, int z) {
+    int lo = x < y ? x : y, hi = x < y ? y : x;
+    int a = z < lo ? z : lo, c = z > hi ? z : hi;
+    t[(*count)++] = (struct MatrixChainTriangle){(long long)a * V + c, x + y + z - a - c};
+}
+
+// 1/wv + 1/wt < 1/wa + 1/wc without division: both sides times wv wt wa wc
+static inline int matrixChainCutsOff(long long wv, long long wt, long long wa, long long wc) {
+    return (__int128)wa * wc * (wt + wv) < (__int128)wv * wt * (wa + wc);
+}
+
+static inline void matrixChainHuShing(struct MatrixChainPlan* plan, const long long* p) {
+    int n = plan->n, V = n + 1;
+    int v1 = 0;
+    for (int i = 1; i < V; i++)
+        if (p[i] < p[v1])
+            v1 = i;
+
+    struct MatrixChainTriangle* t = (struct MatrixChainTriangle*)matrixChainAlloc((n - 1) * sizeof(struct MatrixChainTriangle));
+    int* stack = (int*)matrixChainAlloc(V * sizeof(int));
+    int top = 0, count = 0;
+    stack[0] = v1;
+
+    for (int step = 1; step <= V; step++) {
+        int c = step < V ? (v1 + step) % V : v1;  // the last one closes the polygon
+        while (top >= 2 && matrixChainCutsOff(p[v1], p[stack[top]], p[stack[top - 1]], p[c])) {
+            matrixChainAddTriangle(t, &count, V, stack[top - 1], stack[top], c);
+            top--;
+        }
+        if (step < V)
+            stack[++top] = c;
+    }
+    // Fan from V1 over what is left
+    for (int k = 1; k < top; k++)
+        matrixChainAddTriangle(t, &count, V, v1, stack[k], stack[k + 1]);
+
+    qsort(t, count, sizeof(struct MatrixChainTriangle), compareMatrixChainTriangles);
+    struct MatrixChainTriangulation tr = {n, t};
+    matrixChainBuildSteps(plan, matrixChainTriangleSplit, &tr);
+    plan->cost = matrixChainPlanCost(plan, p);
+    free(t);
+    free(stack);
+}
+
+// ---------- Entry points ----------
+// Plans the product of n matrices with dimensions p[0 .. n]. Release with
+// freeMatrixChainPlan.
+static inline struct MatrixChainPlan* buildMatrixChainPlan(const long long* p, int n, enum MatrixChainMode mode) {
+    for (int i = 0; i <= n; i++)
+        if (p[i] < 1) {
+            fprintf(stderr, "Matrix chain dimension %d must be positive\n", i);
+            exit(1);
+        }
+    struct MatrixChainPlan* plan = newMatrixChainPlan(n);
+    if (n < 2)
+        return plan;
+    if (mode == MATRIX_CHAIN_HU_SHING)
+        matrixChainHuShing(plan, p);
+    else
+        matrixChainDP(plan, p, mode == MATRIX_CHAIN_PARALLEL);
+    return plan;
+}
+
+// Writes the parenthesization; matrices are A, B, ... for chains of at
+// most 26, A1, A2, ... otherwise. Recursion depth is the plan's height.
+static inline void printMatrixChainOperand(FILE* out, const struct MatrixChainPlan* plan, int x) {
+    if (x < plan->n) {
+        if (plan->n <= 26)
+            fputc('A' + x, out);
+        else
+            fprintf(out, "A%d", x + 1);
+        return;
+    }
+    fputc('(', out);
+    printMatrixChainOperand(out, plan, plan->step[x - plan->n].left);
+    printMatrixChainOperand(out, plan, plan->step[x - plan->n].right);
+    fputc(')', out);
+}
+
+static inline void printMatrixChainPlan(FILE* out, const struct MatrixChainPlan* plan) {
+    if (plan->n > 0)
+        printMatrixChainOperand(out, plan, plan->n == 1 ? 0 : 2 * plan->n - 2);
+    fputc('\n', out);
+}
+
+// Executes the plan on row-major double matrices a[i] (p[i] x p[i + 1]).
+// Returns a new p[0] x p[n] matrix.
+static inline double* multiplyMatrixChain(const struct MatrixChainPlan* plan, const long long* p,
+                                          double* const* a) {
+    int n = plan->n;
+    double** operand = (double**)matrixChainAlloc((2 * n - 1) * sizeof(double*));
+    int* first = (int*)matrixChainAlloc((2 * n - 1) * sizeof(int));
+    int* last = (int*)matrixChainAlloc((2 * n - 1) * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        operand[i] = a[i];
+        first[i] = last[i] = i;
+    }
+
+    for (int s = 0; s < n - 1; s++) {
+        int l = plan->step[s].left, r = plan->step[s].right;
+        long long rows = p[first[l]], inner = p[last[l] + 1], cols = p[last[r] + 1];
+        double* c = (double*)calloc((size_t)(rows * cols), sizeof(double));
+        if (c == NULL) {
+            perror("Matrix chain allocation failed");
+            exit(1);
+        }
+        // i-k-j order streams through rows of both inputs
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < rows; i++)
+            for (long long k = 0; k < inner; k++) {
+                double x = operand[l][i * inner + k];
+                const double* b = operand[r] + k * cols;
+                double* ci = c + i * cols;
+                for (long long j = 0; j < cols; j++)
+                    ci[j] += x * b[j];
+            }
+        // Intermediate results are no longer needed
+        if (l >= n)
+            free(operand[l]);
+        if (r >= n)
+            free(operand[r]);
+        operand[n + s] = c;
+        first[n + s] = first[l];
+        last[n + s] = last[r];
+    }
+
+    double* result;
+    if (n == 1) {
+        result = (double*)matrixChainAlloc((size_t)(p[0] * p[1]) * sizeof(double));
+        memcpy(result, a[0], (size_t)(p[0] * p[1]) * sizeof(double));
+    } else {
+        result = operand[2 * n - 2];
+    }
+    free(operand);
+    free(first);
+    free(last);
+    return result;
+}
+
+#endif // MATRIX_CHAIN_H
@@ -1,97 +1,80 @@
-#include <stdio.h>
-#include <stdlib.h>
+/* Radix Sort of a file of integers
 
-// Function to find the maximum value in the array
-// This is needed to know how many digits the largest number has
-int getMax(int arr[], int n) {
-    int max = arr[0];
-    for (int i = 1; i < n; i++) {
-        if (arr[i] > max)
-            max = arr[i];
-    }
-    return max;
-}
+The sort itself lives in radix_sort.h: multithreaded LSD on 11-bit digits
+(3 passes for 32-bit keys), one scratch buffer, all histograms in one
+pre-pass. Negative numbers are handled by flipping the sign bit of the key.
+File I/O lives in int_io.h: a parallel mmap text parser and formatter, or
+raw little-endian int32 with -b (both sides), -bi (input) or -bo (output).
+Throughput numbers: Radix_Sort_Benchmark.c.
 
-// A function to do counting sort of arr[] according to
-// the digit represented by exp (1, 10, 100, etc.)
-void countSort(int arr[], int n, int exp) {
-    int *output = (int *)malloc(n * sizeof(int)); // Output array
-    int count[10] = {0}; // Frequency array for digits 0-9
-    int i;
-
-    // Store count of occurrences in count[]
-    for (i = 0; i < n; i++)
-        count[(arr[i] / exp) % 10]++;
-
-    // Change count[i] so that count[i] now contains actual
-    // position of this digit in output[]
-    for (i = 1; i < 10; i++)
-        count[i] += count[i - 1];
-
-    // Build the output array
-    // We traverse backwards to ensure stability
-    for (i = n - 1; i >= 0; i--) {
-        output[count[(arr[i] / exp) % 10] - 1] = arr[i];
-        count[(arr[i] / exp) % 10]--;
-    }
+For inputs larger than RAM, -m <MB> switches to the external sort of
+external_sort.h: radix-sorted runs of at most half the budget are spilled
+to temporary files in -t <dir> (default $TMPDIR or /tmp) and merged with a
+loser tree; the I/O volume is reported at the end.
 
-    // Copy the output array to arr[], so that arr[] now
-    // contains sorted numbers according to current digit
-    for (i = 0; i < n; i++)
-        arr[i] = output[i];
+gcc -O2 -fopenmp radix_sort.c -o radix_sort
+./radix_sort [-b | -bi | -bo] [-m MB [-t dir]] [input.txt [output.txt]] */
 
-    free(output);
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#include "radix_sort.h"
+#include "int_io.h"
+#include "external_sort.h"
 
 // The main function to that sorts arr[] of size n using Radix Sort
-void radixSort(int arr[], int n) {
-    // Find the maximum number to know number of digits
-    int m = getMax(arr, n);
-
-    // Do counting sort for every digit. Note that instead
-    // of passing digit number, exp is passed. exp is 10^i
-    // where i is current digit number
-    for (int exp = 1; m / exp > 0; exp *= 10)
-        countSort(arr, n, exp);
+void radixSort(int arr[], size_t n) {
+    radixSortParallel(arr, NULL, n, sizeof(int), RADIX_SIGNED);
 }
 
-int main() {
-    FILE *inputFile, *outputFile;
-    int *arr;
-    int n = 0, capacity = 10;
-    int temp;
-
-    // 1. Open Input File
-    inputFile = fopen("input.txt", "r");
-    if (inputFile == NULL) {
-        printf("Error: Could not open input.txt\n");
-        return 1;
-    }
+// Run sort for the external mode, which supplies the scratch buffer
+void radixSortRun(int32_t* a, int32_t* scratch, size_t n) {
+    radixSortParallel(a, scratch, n, sizeof(int32_t), RADIX_SIGNED);
+}
 
-    // Allocate initial memory
-    arr = (int *)malloc(capacity * sizeof(int));
-    if (arr == NULL) {
-        printf("Error: Memory allocation failed\n");
-        return 1;
+int main(int argc, char* argv[]) {
+    const char* inputName = "input.txt";
+    const char* outputName = "output.txt";
+    const char* tmpDir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    int binaryIn = 0, binaryOut = 0, files = 0;
+    size_t memoryMB = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-b") == 0)
+            binaryIn = binaryOut = 1;
+        else if (strcmp(argv[i], "-bi") == 0)
+            binaryIn = 1;
+        else if (strcmp(argv[i], "-bo") == 0)
+            binaryOut = 1;
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+            memoryMB = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            tmpDir = argv[++i];
+        else if (files == 0)
+            inputName = argv[i], files++;
+        else if (files == 1)
+            outputName = argv[i], files++;
+        else {
+            printf("Usage: %s [-b | -bi | -bo] [-m MB [-t dir]] [input [output]]\n", argv[0]);
+            return 1;
+        }
     }
 
-    // 2. Read numbers from file
-    // We resize the array dynamically if the file is large
-    while (fscanf(inputFile, "%d", &temp) == 1) {
-        if (n >= capacity) {
-            capacity *= 2;
-            int *newArr = (int *)realloc(arr, capacity * sizeof(int));
-            if (newArr == NULL) {
-                printf("Error: Memory reallocation failed\n");
-                free(arr);
-                fclose(inputFile);
-                return 1;
-            }
-            arr = newArr;
-        }
-        arr[n++] = temp;
+    if (memoryMB > 0) {
+        struct ExternalSortStats stats;
+        externalSort(inputName, binaryIn, outputName, binaryOut, memoryMB << 20, tmpDir, radixSortRun, &stats);
+        printExternalSortStats(&stats);
+        printf("Sorting complete. Check %s\n", outputName);
+        return 0;
     }
-    fclose(inputFile);
+
+    // 1. Read numbers from file
+    double t = omp_get_wtime();
+    size_t n;
+    int* arr = binaryIn ? readBinaryIntegers(inputName, &n) : readTextIntegers(inputName, &n);
+    double readTime = omp_get_wtime() - t;
 
     if (n == 0) {
         printf("File is empty or contains no integers.\n");
@@ -99,28 +82,24 @@ int main() {
         return 0;
     }
 
-    printf("Read %d numbers. Sorting...\n", n);
+    printf("Read %zu numbers. Sorting...\n", n);
 
-    // 3. Perform Radix Sort
+    // 2. Perform Radix Sort
+    t = omp_get_wtime();
     radixSort(arr, n);
+    double sortTime = omp_get_wtime() - t;
 
-    // 4. Write to Output File
-    outputFile = fopen("output.txt", "w");
-    if (outputFile == NULL) {
-        printf("Error: Could not create output.txt\n");
-        free(arr);
-        return 1;
-    }
+    // 3. Write to Output File
+    t = omp_get_wtime();
+    if (binaryOut)
+        writeBinaryIntegers(outputName, arr, n);
+    else
+        writeTextIntegers(outputName, arr, n);
+    double writeTime = omp_get_wtime() - t;
 
-    for (int i = 0; i < n; i++) {
-        fprintf(outputFile, "%d\n", arr[i]);
-    }
+    printf("Sorting complete. Check %s\n", outputName);
+    printf("read %.3f s, sort %.3f s, write %.3f s\n", readTime, sortTime, writeTime);
 
-    printf("Sorting complete. Check output.txt\n");
-
-    // Cleanup
-    fclose(outputFile);
     free(arr);
-
     return 0;
 }
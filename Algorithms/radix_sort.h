@@ -0,0 +1,636 @@
+/* LSD radix sort for 32- and 64-bit keys.
+
+Keys are sorted on 11-bit digits: three passes for 32-bit keys and six for
+64-bit keys, instead of up to ten base-10 passes. Every sort
+
+  - ping-pongs between the data and one scratch buffer of the same size,
+    allocated once (pass your own or NULL to have one allocated),
+  - builds the histograms of all digits in a single pre-pass,
+  - skips a pass when every key has the same digit there,
+  - is stable.
+
+Signed integers and IEEE floats are mapped to unsigned keys with the same
+order: flip the sign bit of an integer; flip every bit of a negative float
+and only the sign bit of a positive one. The mapping is applied in the
+histogram pre-pass and undone during the last scatter, so it costs no
+extra pass. Floats are ordered -inf < ... < -0.0 < +0.0 < ... < +inf, with
+NaNs at either end according to their sign bit.
+
+Multithreaded variants (compile with -fopenmp, one thread otherwise):
+
+  radixSortParallel  LSD as above. Each thread owns a contiguous block of
+                     the input and counts its digits; an exclusive prefix
+                     sum over (bucket, thread) gives every thread disjoint
+                     output ranges, so the scatter needs no atomics and the
+                     sort stays stable. The first pass reuses the pre-pass
+                     histograms; later passes recount the thread's block.
+  radixSortPairs     the same with a 32-bit payload (e.g. the original
+                     index) moved along with each key.
+  radixSortInPlace   American-flag MSD radix sort on 8-bit digits, for
+                     when there is no memory for a scratch copy. Buckets are
+                     permuted in place by cycle swapping and then sorted
+                     recursively as OpenMP tasks; small buckets finish with
+                     insertion sort. Not stable. The first level is
+                     permuted by one thread; the parallelism comes from
+                     the buckets below it. */
+
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define RADIX_BITS 11
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_MASK (RADIX_BUCKETS - 1)
+
+// Number of 11-bit digits in a 32- / 64-bit key
+#define RADIX_DIGITS_32 3
+#define RADIX_DIGITS_64 6
+
+enum RadixKeyType {
+    RADIX_UNSIGNED,
+    RADIX_SIGNED,
+    RADIX_FLOAT
+};
+
+// The sorts read float and double arrays through these, which GCC and
+// Clang allow to alias any type
+typedef uint32_t __attribute__((may_alias)) radix_u32;
+typedef uint64_t __attribute__((may_alias)) radix_u64;
+
+// ---------- Key transforms ----------
+static inline uint32_t radixEncode32(uint32_t x, enum RadixKeyType type) {
+    switch (type) {
+    case RADIX_SIGNED: return x ^ 0x80000000u;
+    case RADIX_FLOAT:  return x & 0x80000000u ? ~x : x ^ 0x80000000u;
+    default:           return x;
+    }
+}
+
+static inline uint32_t radixDecode32(uint32_t k, enum RadixKeyType type) {
+    switch (type) {
+    case RADIX_SIGNED: return k ^ 0x80000000u;
+    case RADIX_FLOAT:  return k & 0x80000000u ? k ^ 0x80000000u : ~k;
+    default:           return k;
+    }
+}
+
+static inline uint64_t radixEncode64(uint64_t x, enum RadixKeyType type) {
+    switch (type) {
+    case RADIX_SIGNED: return x ^ 0x8000000000000000ull;
+    case RADIX_FLOAT:  return x & 0x8000000000000000ull ? ~x : x ^ 0x8000000000000000ull;
+    default:           return x;
+    }
+}
+
+static inline uint64_t radixDecode64(uint64_t k, enum RadixKeyType type) {
+    switch (type) {
+    case RADIX_SIGNED: return k ^ 0x8000000000000000ull;
+    case RADIX_FLOAT:  return k & 0x8000000000000000ull ? k ^ 0x8000000000000000ull : ~k;
+    default:           return k;
+    }
+}
+
+static inline void* radixAlloc(size_t bytes) {
+    void* p = malloc(bytes ? bytes : 1);
+    if (p == NULL) {
+        perror("radix sort allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+// ---------- 32-bit keys ----------
+// data and scratch hold n 4-byte values; the result ends up in data.
+static inline void radixSortKeys32(void* data, void* scratch, size_t n, enum RadixKeyType type) {
+    radix_u32* a = (radix_u32*)data;
+    size_t (*count)[RADIX_BUCKETS] = (size_t (*)[RADIX_BUCKETS])calloc(RADIX_DIGITS_32, sizeof(*count));
+    if (count == NULL) {
+        perror("radix sort allocation failed");
+        exit(1);
+    }
+
+    // Encode in place and build every histogram in one pass
+    for (size_t i = 0; i < n; i++) {
+        uint32_t k = radixEncode32(a[i], type);
+        a[i] = k;
+        for (int d = 0; d < RADIX_DIGITS_32; d++)
+            count[d][(k >> (d * RADIX_BITS)) & RADIX_MASK]++;
+    }
+
+    int pass[RADIX_DIGITS_32], passes = 0;
+    for (int d = 0; d < RADIX_DIGITS_32; d++)
+        if (n > 0 && count[d][(a[0] >> (d * RADIX_BITS)) & RADIX_MASK] != n)
+            pass[passes++] = d;
+
+    radix_u32* from = a;
+    radix_u32* to = (radix_u32*)scratch;
+    for (int p = 0; p < passes; p++) {
+        int shift = pass[p] * RADIX_BITS;
+        size_t* pos = count[pass[p]];
+        size_t sum = 0;
+        for (int b = 0; b < RADIX_BUCKETS; b++) {
+            size_t c = pos[b];
+            pos[b] = sum;
+            sum += c;
+        }
+        if (p == passes - 1) {
+            for (size_t i = 0; i < n; i++)
+                to[pos[(from[i] >> shift) & RADIX_MASK]++] = radixDecode32(from[i], type);
+        } else {
+            for (size_t i = 0; i < n; i++)
+                to[pos[(from[i] >> shift) & RADIX_MASK]++] = from[i];
+        }
+        radix_u32* t = from;
+        from = to;
+        to = t;
+    }
+
+    if (passes == 0)
+        for (size_t i = 0; i < n; i++)
+            a[i] = radixDecode32(a[i], type);
+    else if (from != a)
+        memcpy(a, from, n * sizeof(uint32_t));
+    free(count);
+}
+
+// ---------- 64-bit keys ----------
+static inline void radixSortKeys64(void* data, void* scratch, size_t n, enum RadixKeyType type) {
+    radix_u64* a = (radix_u64*)data;
+    size_t (*count)[RADIX_BUCKETS] = (size_t (*)[RADIX_BUCKETS])calloc(RADIX_DIGITS_64, sizeof(*count));
+    if (count == NULL) {
+        perror("radix sort allocation failed");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t k = radixEncode64(a[i], type);
+        a[i] = k;
+        for (int d = 0; d < RADIX_DIGITS_64; d++)
+            count[d][(k >> (d * RADIX_BITS)) & RADIX_MASK]++;
+    }
+
+    int pass[RADIX_DIGITS_64], passes = 0;
+    for (int d = 0; d < RADIX_DIGITS_64; d++)
+        if (n > 0 && count[d][(a[0] >> (d * RADIX_BITS)) & RADIX_MASK] != n)
+            pass[passes++] = d;
+
+    radix_u64* from = a;
+    radix_u64* to = (radix_u64*)scratch;
+    for (int p = 0; p < passes; p++) {
+        int shift = pass[p] * RADIX_BITS;
+        size_t* pos = count[pass[p]];
+        size_t sum = 0;
+        for (int b = 0; b < RADIX_BUCKETS; b++) {
+            size_t c = pos[b];
+            pos[b] = sum;
+            sum += c;
+        }
+        if (p == passes - 1) {
+            for (size_t i = 0; i < n; i++)
+                to[pos[(from[i] >> shift) & RADIX_MASK]++] = radixDecode64(from[i], type);
+        } else {
+            for (size_t i = 0; i < n; i++)
+                to[pos[(from[i] >> shift) & RADIX_MASK]++] = from[i];
+        }
+        radix_u64* t = from;
+        from = to;
+        to = t;
+    }
+
+    if (passes == 0)
+        for (size_t i = 0; i < n; i++)
+            a[i] = radixDecode64(a[i], type);
+    else if (from != a)
+        memcpy(a, from, n * sizeof(uint64_t));
+    free(count);
+}
+
+// ---------- Typed entry points ----------
+// scratch must hold n elements, or be NULL to allocate one for this call.
+static inline void radixSortTyped(void* data, void* scratch, size_t n, size_t width, enum RadixKeyType type) {
+    void* buffer = scratch ? scratch : radixAlloc(n * width);
+    if (width == 4)
+        radixSortKeys32(data, buffer, n, type);
+    else
+        radixSortKeys64(data, buffer, n, type);
+    if (!scratch)
+        free(buffer);
+}
+
+static inline void radixSortUInt32(uint32_t* a, uint32_t* scratch, size_t n) { radixSortTyped(a, scratch, n, 4, RADIX_UNSIGNED); }
+static inline void radixSortInt32(int32_t* a, int32_t* scratch, size_t n)    { radixSortTyped(a, scratch, n, 4, RADIX_SIGNED); }
+static inline void radixSortFloat(float* a, float* scratch, size_t n)        { radixSortTyped(a, scratch, n, 4, RADIX_FLOAT); }
+static inline void radixSortUInt64(uint64_t* a, uint64_t* scratch, size_t n) { radixSortTyped(a, scratch, n, 8, RADIX_UNSIGNED); }
+static inline void radixSortInt64(int64_t* a, int64_t* scratch, size_t n)    { radixSortTyped(a, scratch, n, 8, RADIX_SIGNED); }
+static inline void radixSortDouble(double* a, double* scratch, size_t n)     { radixSortTyped(a, scratch, n, 8, RADIX_FLOAT); }
+
+// ---------- Parallel LSD ----------
+// Thread t's block of n elements
+static inline void radixBlock(size_t n, int t, int T, size_t* begin, size_t* end) {
+    size_t extra = n % T;  // the first extra threads get one more element
+    *begin = n / T * t + ((size_t)t < extra ? (size_t)t : extra);
+    *end = *begin + n / T + ((size_t)t < extra);
+}
+
+// Turns per-thread bucket counts (hist[t * RADIX_BUCKETS + b]) into each
+// thread's first output position for that bucket
+static inline void radixThreadOffsets(size_t* hist, int T) {
+    size_t sum = 0;
+    for (int b = 0; b < RADIX_BUCKETS; b++)
+        for (int t = 0; t < T; t++) {
+            size_t c = hist[t * RADIX_BUCKETS + b];
+            hist[t * RADIX_BUCKETS + b] = sum;
+            sum += c;
+        }
+}
+
+static inline int radixThreadCount(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// values / valueScratch may be NULL for a keys-only sort
+static inline void radixParallelLSD32(radix_u32* a, radix_u32* scratch, uint32_t* values,
+                                      uint32_t* valueScratch, size_t n, enum RadixKeyType type) {
+    int maxT = radixThreadCount();
+    size_t* pre = (size_t*)radixAlloc((size_t)maxT * RADIX_DIGITS_32 * RADIX_BUCKETS * sizeof(size_t));
+    size_t* hist = (size_t*)radixAlloc((size_t)maxT * RADIX_BUCKETS * sizeof(size_t));
+    int pass[RADIX_DIGITS_32], passes = 0;
+
+    #pragma omp parallel num_threads(maxT)
+    {
+        int t = 0, T = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        T = omp_get_num_threads();
+#endif
+        size_t begin, end;
+        radixBlock(n, t, T, &begin, &end);
+
+        // Encode and count every digit of this thread's block
+        size_t* my = pre + (size_t)t * RADIX_DIGITS_32 * RADIX_BUCKETS;
+        memset(my, 0, RADIX_DIGITS_32 * RADIX_BUCKETS * sizeof(size_t));
+        for (size_t i = begin; i < end; i++) {
+            uint32_t k = radixEncode32(a[i], type);
+            a[i] = k;
+            for (int d = 0; d < RADIX_DIGITS_32; d++)
+                my[d * RADIX_BUCKETS + ((k >> (d * RADIX_BITS)) & RADIX_MASK)]++;
+        }
+        #pragma omp barrier
+        #pragma omp single
+        for (int d = 0; d < RADIX_DIGITS_32; d++) {
+            size_t same = 0;
+            int b = n > 0 ? (int)((a[0] >> (d * RADIX_BITS)) & RADIX_MASK) : 0;
+            for (int s = 0; s < T; s++)
+                same += pre[(size_t)s * RADIX_DIGITS_32 * RADIX_BUCKETS + d * RADIX_BUCKETS + b];
+            if (n > 0 && same != n)
+                pass[passes++] = d;
+        }
+
+        radix_u32* from = a;
+        radix_u32* to = scratch;
+        uint32_t* vFrom = values;
+        uint32_t* vTo = valueScratch;
+        for (int p = 0; p < passes; p++) {
+            int shift = pass[p] * RADIX_BITS;
+            size_t* pos = hist + (size_t)t * RADIX_BUCKETS;
+            if (p == 0) {
+                memcpy(pos, my + pass[0] * RADIX_BUCKETS, RADIX_BUCKETS * sizeof(size_t));
+            } else {
+                memset(pos, 0, RADIX_BUCKETS * sizeof(size_t));
+                for (size_t i = begin; i < end; i++)
+                    pos[(from[i] >> shift) & RADIX_MASK]++;
+            }
+            #pragma omp barrier
+            #pragma omp single
+            radixThreadOffsets(hist, T);
+
+            int last = p == passes - 1;
+            if (values) {
+                for (size_t i = begin; i < end; i++) {
+                    size_t j = pos[(from[i] >> shift) & RADIX_MASK]++;
+                    to[j] = last ? radixDecode32(from[i], type) : from[i];
+                    vTo[j] = vFrom[i];
+                }
+            } else if (last) {
+                for (size_t i = begin; i < end; i++)
+                    to[pos[(from[i] >> shift) & RADIX_MASK]++] = radixDecode32(from[i], type);
+            } else {
+                for (size_t i = begin; i < end; i++)
+                    to[pos[(from[i] >> shift) & RADIX_MASK]++] = from[i];
+            }
+            #pragma omp barrier
+
+            radix_u32* tk = from;
+            from = to;
+            to = tk;
+            uint32_t* tv = vFrom;
+            vFrom = vTo;
+            vTo = tv;
+        }
+
+        // Result back into the caller's arrays
+        if (passes == 0) {
+            for (size_t i = begin; i < end; i++)
+                a[i] = radixDecode32(a[i], type);
+        } else if (from != a) {
+            memcpy(a + begin, from + begin, (end - begin) * sizeof(uint32_t));
+            if (values)
+                memcpy(values + begin, vFrom + begin, (end - begin) * sizeof(uint32_t));
+        }
+    }
+
+    free(hist);
+    free(pre);
+}
+
+static inline void radixParallelLSD64(radix_u64* a, radix_u64* scratch, uint32_t* values,
+                                      uint32_t* valueScratch, size_t n, enum RadixKeyType type) {
+    int maxT = radixThreadCount();
+    size_t* pre = (size_t*)radixAlloc((size_t)maxT * RADIX_DIGITS_64 * RADIX_BUCKETS * sizeof(size_t));
+    size_t* hist = (size_t*)radixAlloc((size_t)maxT * RADIX_BUCKETS * sizeof(size_t));
+    int pass[RADIX_DIGITS_64], passes = 0;
+
+    #pragma omp parallel num_threads(maxT)
+    {
+        int t = 0, T = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        T = omp_get_num_threads();
+#endif
+        size_t begin, end;
+        radixBlock(n, t, T, &begin, &end);
+
+        size_t* my = pre + (size_t)t * RADIX_DIGITS_64 * RADIX_BUCKETS;
+        memset(my, 0, RADIX_DIGITS_64 * RADIX_BUCKETS * sizeof(size_t));
+        for (size_t i = begin; i < end; i++) {
+            uint64_t k = radixEncode64(a[i], type);
+            a[i] = k;
+            for (int d = 0; d < RADIX_DIGITS_64; d++)
+                my[d * RADIX_BUCKETS + ((k >> (d * RADIX_BITS)) & RADIX_MASK)]++;
+        }
+        #pragma omp barrier
+        #pragma omp single
+        for (int d = 0; d < RADIX_DIGITS_64; d++) {
+            size_t same = 0;
+            int b = n > 0 ? (int)((a[0] >> (d * RADIX_BITS)) & RADIX_MASK) : 0;
+            for (int s = 0; s < T; s++)
+                same += pre[(size_t)s * RADIX_DIGITS_64 * RADIX_BUCKETS + d * RADIX_BUCKETS + b];
+            if (n > 0 && same != n)
+                pass[passes++] = d;
+        }
+
+        radix_u64* from = a;
+        radix_u64* to = scratch;
+        uint32_t* vFrom = values;
+        uint32_t* vTo = valueScratch;
+        for (int p = 0; p < passes; p++) {
+            int shift = pass[p] * RADIX_BITS;
+            size_t* pos = hist + (size_t)t * RADIX_BUCKETS;
+            if (p == 0) {
+                memcpy(pos, my + pass[0] * RADIX_BUCKETS, RADIX_BUCKETS * sizeof(size_t));
+            } else {
+                memset(pos, 0, RADIX_BUCKETS * sizeof(size_t));
+                for (size_t i = begin; i < end; i++)
+                    pos[(from[i] >> shift) & RADIX_MASK]++;
+            }
+            #pragma omp barrier
+            #pragma omp single
+            radixThreadOffsets(hist, T);
+
+            int last = p == passes - 1;
+            if (values) {
+                for (size_t i = begin; i < end; i++) {
+                    size_t j = pos[(from[i] >> shift) & RADIX_MASK]++;
+                    to[j] = last ? radixDecode64(from[i], type) : from[i];
+                    vTo[j] = vFrom[i];
+                }
+            } else if (last) {
+                for (size_t i = begin; i < end; i++)
+                    to[pos[(from[i] >> shift) & RADIX_MASK]++] = radixDecode64(from[i], type);
+            } else {
+                for (size_t i = begin; i < end; i++)
+                    to[pos[(from[i] >> shift) & RADIX_MASK]++] = from[i];
+            }
+            #pragma omp barrier
+
+            radix_u64* tk = from;
+            from = to;
+            to = tk;
+            uint32_t* tv = vFrom;
+            vFrom = vTo;
+            vTo = tv;
+        }
+
+        if (passes == 0) {
+            for (size_t i = begin; i < end; i++)
+                a[i] = radixDecode64(a[i], type);
+        } else if (from != a) {
+            memcpy(a + begin, from + begin, (end - begin) * sizeof(uint64_t));
+            if (values)
+                memcpy(values + begin, vFrom + begin, (end - begin) * sizeof(uint32_t));
+        }
+    }
+
+    free(hist);
+    free(pre);
+}
+
+// width is 4 or 8 bytes; scratch may be NULL as for radixSortTyped
+static inline void radixSortParallel(void* data, void* scratch, size_t n, size_t width, enum RadixKeyType type) {
+    void* buffer = scratch ? scratch : radixAlloc(n * width);
+    if (width == 4)
+        radixParallelLSD32((radix_u32*)data, (radix_u32*)buffer, NULL, NULL, n, type);
+    else
+        radixParallelLSD64((radix_u64*)data, (radix_u64*)buffer, NULL, NULL, n, type);
+    if (!scratch)
+        free(buffer);
+}
+
+// Sorts keys and permutes values[] the same way; equal keys keep their
+// order. Pass values[i] = i to get the sorting permutation.
+static inline void radixSortPairs(void* keys, uint32_t* values, void* keyScratch, uint32_t* valueScratch,
+                                  size_t n, size_t width, enum RadixKeyType type) {
+    void* kBuffer = keyScratch ? keyScratch : radixAlloc(n * width);
+    uint32_t* vBuffer = valueScratch ? valueScratch : (uint32_t*)radixAlloc(n * sizeof(uint32_t));
+    if (width == 4)
+        radixParallelLSD32((radix_u32*)keys, (radix_u32*)kBuffer, values, vBuffer, n, type);
+    else
+        radixParallelLSD64((radix_u64*)keys, (radix_u64*)kBuffer, values, vBuffer, n, type);
+    if (!valueScratch)
+        free(vBuffer);
+    if (!keyScratch)
+        free(kBuffer);
+}
+
+// ---------- In-place MSD (American flag) ----------
+#define RADIX_MSD_BITS 8
+#define RADIX_MSD_BUCKETS (1 << RADIX_MSD_BITS)
+
+// Buckets this small are finished by insertion sort
+#define RADIX_MSD_SMALL 64
+
+// Buckets this large become their own OpenMP task
+#define RADIX_MSD_TASK 65536
+
+static inline void radixAmericanFlag32(radix_u32* a, size_t n, int shift) {
+    for (;;) {
+        if (n <= RADIX_MSD_SMALL) {
+            for (size_t i = 1; i < n; i++) {
+                uint32_t x = a[i];
+                size_t j = i;
+                for (; j > 0 && a[j - 1] > x; j--)
+                    a[j] = a[j - 1];
+                a[j] = x;
+            }
+            return;
+        }
+
+        size_t count[RADIX_MSD_BUCKETS] = {0};
+        for (size_t i = 0; i < n; i++)
+            count[(a[i] >> shift) & (RADIX_MSD_BUCKETS - 1)]++;
+        // One bucket holds everything: go straight to the next digit
+        if (count[(a[0] >> shift) & (RADIX_MSD_BUCKETS - 1)] == n) {
+            if (shift == 0)
+                return;
+            shift -= RADIX_MSD_BITS;
+            continue;
+        }
+
+        size_t head[RADIX_MSD_BUCKETS], tail[RADIX_MSD_BUCKETS], sum = 0;
+        for (int b = 0; b < RADIX_MSD_BUCKETS; b++) {
+            head[b] = sum;
+            sum += count[b];
+            tail[b] = sum;
+        }
+        // Cycle each misplaced key to the head of its bucket
+        for (int b = 0; b < RADIX_MSD_BUCKETS; b++) {
+            while (head[b] < tail[b]) {
+                uint32_t x = a[head[b]];
+                int d = (x >> shift) & (RADIX_MSD_BUCKETS - 1);
+                while (d != b) {
+                    uint32_t y = a[head[d]];
+                    a[head[d]++] = x;
+                    x = y;
+                    d = (x >> shift) & (RADIX_MSD_BUCKETS - 1);
+                }
+                a[head[b]++] = x;
+            }
+        }
+
+        if (shift == 0)
+            return;
+        for (int b = 0; b < RADIX_MSD_BUCKETS; b++) {
+            size_t start = tail[b] - count[b];
+            if (count[b] >= RADIX_MSD_TASK) {
+                #pragma omp task firstprivate(start, b, shift)
+                radixAmericanFlag32(a + start, count[b], shift - RADIX_MSD_BITS);
+            } else if (count[b] > 1) {
+                radixAmericanFlag32(a + start, count[b], shift - RADIX_MSD_BITS);
+            }
+        }
+        return;
+    }
+}
+
+static inline void radixAmericanFlag64(radix_u64* a, size_t n, int shift) {
+    for (;;) {
+        if (n <= RADIX_MSD_SMALL) {
+            for (size_t i = 1; i < n; i++) {
+                uint64_t x = a[i];
+                size_t j = i;
+                for (; j > 0 && a[j - 1] > x; j--)
+                    a[j] = a[j - 1];
+                a[j] = x;
+            }
+            return;
+        }
+
+        size_t count[RADIX_MSD_BUCKETS] = {0};
+        for (size_t i = 0; i < n; i++)
+            count[(a[i] >> shift) & (RADIX_MSD_BUCKETS - 1)]++;
+        if (count[(a[0] >> shift) & (RADIX_MSD_BUCKETS - 1)] == n) {
+            if (shift == 0)
+                return;
+            shift -= RADIX_MSD_BITS;
+            continue;
+        }
+
+        size_t head[RADIX_MSD_BUCKETS], tail[RADIX_MSD_BUCKETS], sum = 0;
+        for (int b = 0; b < RADIX_MSD_BUCKETS; b++) {
+            head[b] = sum;
+            sum += count[b];
+            tail[b] = sum;
+        }
+        for (int b = 0; b < RADIX_MSD_BUCKETS; b++) {
+            while (head[b] < tail[b]) {
+                uint64_t x = a[head[b]];
+                int d = (x >> shift) & (RADIX_MSD_BUCKETS - 1);
+                while (d != b) {
+                    uint64_t y = a[head[d]];
+                    a[head[d]++] = x;
+                    x = y;
+                    d = (x >> shift) & (RADIX_MSD_BUCKETS - 1);
+                }
+                a[head[b]++] = x;
+            }
+        }
+
+        if (shift == 0)
+            return;
+        for (int b = 0; b < RADIX_MSD_BUCKETS; b++) {
+            size_t start = tail[b] - count[b];
+            if (count[b] >= RADIX_MSD_TASK) {
+                #pragma omp task firstprivate(start, b, shift)
+                radixAmericanFlag64(a + start, count[b], shift - RADIX_MSD_BITS);
+            } else if (count[b] > 1) {
+                radixAmericanFlag64(a + start, count[b], shift - RADIX_MSD_BITS);
+            }
+        }
+        return;
+    }
+}
+
+// No scratch memory beyond a few KB of stack per task
+static inline void radixSortInPlace(void* data, size_t n, size_t width, enum RadixKeyType type) {
+    radix_u32* a32 = (radix_u32*)data;
+    radix_u64* a64 = (radix_u64*)data;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; i++) {
+        if (width == 4)
+            a32[i] = radixEncode32(a32[i], type);
+        else
+            a64[i] = radixEncode64(a64[i], type);
+    }
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        if (width == 4)
+            radixAmericanFlag32(a32, n, 32 - RADIX_MSD_BITS);
+        else
+            radixAmericanFlag64(a64, n, 64 - RADIX_MSD_BITS);
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; i++) {
+        if (width == 4)
+            a32[i] = radixDecode32(a32[i], type);
+        else
+            a64[i] = radixDecode64(a64[i], type);
+    }
+}
+
+#endif // RADIX_SORT_H
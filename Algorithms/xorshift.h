@@ -0,0 +1,17 @@
+/* Deterministic xorshift64 generator (Marsaglia 2003) for the benchmarks
+and random test inputs, so runs are reproducible. One state per program;
+not thread-safe and not for cryptographic use. */
+
+#ifndef XORSHIFT_H
+#define XORSHIFT_H
+
+static unsigned long long rngState = 88172645463325252ULL;
+
+static inline unsigned long long xorshift64(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return rngState;
+}
+
+#endif // XORSHIFT_H
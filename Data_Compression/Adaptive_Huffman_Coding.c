@@ -7,200 +7,647 @@
  * 1. Dynamic Huffman Tree construction.
  * 2. The Sibling Property maintenance via node swapping.
  * 3. NYT (Not Yet Transmitted) handling for new symbols.
+ *
+ * The tree is implicit. A node's number is its index in the node arrays,
+ * and weights never decrease with the number. Siblings sit at 2k and
+ * 2k + 1, with the right child higher, so a node's code bit is the low
+ * bit of its number. The root is MAX_NODES - 1, and the NYT node is always
+ * the lowest number in use. Swapping two nodes exchanges their contents,
+ * not their numbers.
+ *
+ * Numbers of equal weight form contiguous blocks. Each number knows its
+ * block, and each block knows its leader, the highest number. This makes
+ * find_highest_in_block O(1). Adding 1 to a leader only moves it to the
+ * bottom of the block above or into a new block, also O(1). An update
+ * therefore costs O(depth) instead of O(MAX_NODES x depth).
+ *
+ * The NYT node's sibling always sits directly below the NYT's parent. When
+ * both are in the same block they are incremented together, instead of
+ * swapping a node with its parent.
+ *
+ * All coder state lives in an AdaptiveHuffman context: the node, block
+ * and leaf arrays are fixed-size members, so one allocation holds a whole
+ * tree and reset_context makes it reusable. Contexts share nothing, so
+ * any number of streams can be coded at once on different threads.
+ *
+ * Codes are packed MSB first through a 64-bit bit buffer. A new symbol is
+ * sent as the NYT code followed by the symbol's 8 bits. The decoder walks
+ * the same tree from the root and applies the same updates.
+ *
+ * File format: "AHC1", the original size (8 bytes, little endian), then
+ * the bit stream.
+ *
+ * gcc -O2 -fopenmp Adaptive_Huffman_Coding.c -o adaptive_huffman
+ * ./adaptive_huffman                     codes for "aardvark"
+ * ./adaptive_huffman e input output      encode a file
+ * ./adaptive_huffman d input output      decode a file
+ * ./adaptive_huffman s [sessions] [bytes] [message]
+ *                                        many streams at once, across threads
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define ALPHABET_SIZE 256
-#define MAX_NODES 512  // 2 * ALPHABET_SIZE - 1 + NYT
-
-// Tree Node Structure
-typedef struct Node {
-    int weight;
-    int symbol;       // -1 for internal nodes, -2 for NYT
-    int id;           // Node number (for sibling property ordering)
-    struct Node *parent;
-    struct Node *left;
-    struct Node *right;
-} Node;
-
-Node *nodes[MAX_NODES]; // Pointers to all nodes indexed by ID
-Node *leaf_table[ALPHABET_SIZE]; // Quick access to leaves by symbol
-Node *nyt_node;       // Pointer to current NYT node
-Node *root;           // Pointer to root
-int next_id;          // Next available ID (decrements from MAX_NODES)
+#define NYT_SYMBOL ALPHABET_SIZE              // the NYT leaf's symbol
+#define MAX_NODES (2 * (ALPHABET_SIZE + 1) - 1)  // 256 leaves + NYT, and their parents
+#define ROOT (MAX_NODES - 1)
+
+#define MAGIC "AHC1"
+
+// A maximal run of numbers with one weight
+typedef struct Block {
+    uint64_t weight;
+    int16_t leader;  // highest number in the block
+} Block;
+
+// One coding session. It holds the whole tree in fixed arrays, with no
+// per-node allocation, so independent sessions can run side by side and a
+// session can be reset and reused.
+typedef struct AdaptiveHuffman {
+    // Indexed by node number
+    uint64_t weight[MAX_NODES];
+    int16_t parent[MAX_NODES];  // parent's number, -1 for the root
+    int16_t child[MAX_NODES];   // internal: number of the right child; leaf: -1 - symbol
+    int16_t block[MAX_NODES];   // block of the number
+    Block blocks[MAX_NODES];
+    int16_t free_blocks[MAX_NODES];
+    int16_t leaf_table[ALPHABET_SIZE + 1];  // leaf number of each symbol, -1 if not yet seen
+    int free_count;
+    int nyt_node;  // number of the NYT node, the lowest in use
+} AdaptiveHuffman;
 
 // --- Helper Functions ---
 
+int new_block(AdaptiveHuffman* h, uint64_t w, int leader) {
+    int b = h->free_blocks[--h->free_count];
+    h->blocks[b].weight = w;
+    h->blocks[b].leader = (int16_t)leader;
+    return b;
+}
+
+void free_block(AdaptiveHuffman* h, int b) {
+    h->free_blocks[h->free_count++] = (int16_t)b;
+}
+
 // Initialize the tree with just the NYT node
-void init_tree() {
-    next_id = MAX_NODES - 1;
-    
-    nyt_node = (Node *)malloc(sizeof(Node));
-    nyt_node->weight = 0;
-    nyt_node->symbol = -2; // NYT
-    nyt_node->id = next_id;
-    nyt_node->parent = NULL;
-    nyt_node->left = NULL;
-    nyt_node->right = NULL;
-    
-    root = nyt_node;
-    nodes[next_id] = nyt_node;
-    
-    for(int i=0; i<ALPHABET_SIZE; i++) leaf_table[i] = NULL;
+void reset_context(AdaptiveHuffman* h) {
+    h->free_count = 0;
+    for (int b = MAX_NODES - 1; b >= 0; b--)
+        h->free_blocks[h->free_count++] = (int16_t)b;
+    for (int i = 0; i <= ALPHABET_SIZE; i++)
+        h->leaf_table[i] = -1;
+
+    h->nyt_node = ROOT;
+    h->weight[ROOT] = 0;
+    h->parent[ROOT] = -1;
+    h->child[ROOT] = -1 - NYT_SYMBOL;
+    h->block[ROOT] = (int16_t)new_block(h, 0, ROOT);
+    h->leaf_table[NYT_SYMBOL] = ROOT;
+}
+
+AdaptiveHuffman* create_context(void) {
+    AdaptiveHuffman* h = (AdaptiveHuffman*)malloc(sizeof(AdaptiveHuffman));
+    if (h == NULL) {
+        perror("Memory allocation failed");
+        exit(1);
+    }
+    reset_context(h);
+    return h;
+}
+
+void free_context(AdaptiveHuffman* h) {
+    free(h);
 }
 
 // Find the highest numbered node in the block (same weight)
 // This is critical for the "Update Procedure" in Section 3.4.1
-Node* find_highest_in_block(int weight, Node* exclude) {
-    // Search backwards from max ID because higher IDs have higher/equal weights
-    // in a valid sibling-property tree.
-    for (int i = MAX_NODES - 1; i >= 0; i--) {
-        if (nodes[i] && nodes[i]->weight == weight && nodes[i] != exclude && nodes[i] != exclude->parent) {
-            return nodes[i];
+int find_highest_in_block(const AdaptiveHuffman* h, int q) {
+    return h->blocks[h->block[q]].leader;
+}
+
+// Exchanges the subtrees at numbers a and b, which have the same weight
+void swap_nodes(AdaptiveHuffman* h, int a, int b) {
+    if (a == b)
+        return;
+    int16_t t = h->child[a];
+    h->child[a] = h->child[b];
+    h->child[b] = t;
+
+    int at[2] = {a, b};
+    for (int k = 0; k < 2; k++) {
+        int c = h->child[at[k]];
+        if (c >= 0) {
+            h->parent[c] = (int16_t)at[k];
+            h->parent[c - 1] = (int16_t)at[k];
+        } else {
+            h->leaf_table[-1 - c] = (int16_t)at[k];
         }
     }
-    return exclude; // No swap needed
 }
 
-void swap_nodes(Node *a, Node *b) {
-    if (a == b) return;
+// Adds 1 to the weight of q, the leader of its block
+void increment(AdaptiveHuffman* h, int q) {
+    int b = h->block[q];
+    h->weight[q]++;
+    int above = q < ROOT ? h->block[q + 1] : -1;
+    int joins = above >= 0 && h->blocks[above].weight == h->weight[q];
+    if (q > h->nyt_node && h->block[q - 1] == b) {
+        // The rest of the block stays behind
+        h->blocks[b].leader = (int16_t)(q - 1);
+        h->block[q] = (int16_t)(joins ? above : new_block(h, h->weight[q], q));
+    } else if (joins) {
+        free_block(h, b);
+        h->block[q] = (int16_t)above;
+    } else {
+        h->blocks[b].weight = h->weight[q];
+    }
+}
 
-    // Swap positions in the tree structure
-    Node *parent_a = a->parent;
-    Node *parent_b = b->parent;
+// Adds 1 to q and to its parent q + 1, which together form a block
+void increment_pair(AdaptiveHuffman* h, int q) {
+    int b = h->block[q];
+    h->weight[q]++;
+    h->weight[q + 1]++;
+    h->blocks[b].weight++;
+    int above = q + 1 < ROOT ? h->block[q + 2] : -1;
+    if (above >= 0 && h->blocks[above].weight == h->blocks[b].weight) {
+        free_block(h, b);
+        h->block[q] = h->block[q + 1] = (int16_t)above;
+    }
+}
 
-    // Determine if a and b are left or right children
-    int a_is_left = (parent_a->left == a);
-    int b_is_left = (parent_b->left == b);
+// The core "Update Procedure" (Section 3.4.1): adds 1 to q and its ancestors
+void update_tree(AdaptiveHuffman* h, int q) {
+    for (;;) {
+        int leader = find_highest_in_block(h, q);
+        if (leader == h->parent[q]) {
+            // q is the NYT's sibling and its parent has the same weight
+            increment_pair(h, q);
+            q = h->parent[q];
+        } else {
+            swap_nodes(h, q, leader);
+            increment(h, leader);
+            q = leader;
+        }
+        if (q == ROOT)
+            return;
+        q = h->parent[q];
+    }
+}
+
+// Add a new symbol to the tree (spawning from NYT)
+void spawn_nyt(AdaptiveHuffman* h, int symbol) {
+    // The old NYT becomes an internal node with the new NYT on the left and
+    // the symbol's leaf on the right, both weight 0 before the update
+    int p = h->nyt_node, leaf = p - 1, nyt = p - 2;
+    int zero = h->block[p];
 
-    if (a_is_left) parent_a->left = b; else parent_a->right = b;
-    if (b_is_left) parent_b->left = a; else parent_b->right = a;
+    h->child[p] = (int16_t)leaf;
+    h->child[leaf] = (int16_t)(-1 - symbol);
+    h->child[nyt] = -1 - NYT_SYMBOL;
+    h->parent[leaf] = h->parent[nyt] = (int16_t)p;
+    h->leaf_table[symbol] = (int16_t)leaf;
+    h->leaf_table[NYT_SYMBOL] = (int16_t)nyt;
+    h->nyt_node = nyt;
 
-    b->parent = parent_a;
-    a->parent = parent_b;
+    h->weight[nyt] = 0;
+    h->block[nyt] = (int16_t)zero;
+    h->blocks[zero].leader = (int16_t)nyt;
 
-    // Swap IDs to maintain array indexing implies order
-    // But in C implementation, we just swap the pointers in the 'nodes' array
-    // and the 'id' fields to reflect their new logical position.
-    int temp_id = a->id;
-    a->id = b->id;
-    b->id = temp_id;
+    // The leaf and its parent both go from 0 to 1
+    h->weight[leaf] = h->weight[p] = 1;
+    int above = p < ROOT ? h->block[p + 1] : -1;
+    h->block[leaf] = h->block[p] =
+        (int16_t)(above >= 0 && h->blocks[above].weight == 1 ? above : new_block(h, 1, p));
 
-    nodes[a->id] = a;
-    nodes[b->id] = b;
+    // Increment weights up to root (Start from parent of new internal node)
+    if (p != ROOT)
+        update_tree(h, h->parent[p]);
 }
 
-// The core "Update Procedure" (Section 3.4.1)
-void update_tree(Node *q) {
-    while (q != NULL) {
-        // Find node with highest ID in the same weight block
-        Node *leader = find_highest_in_block(q->weight, q);
-        
-        if (leader != q && leader->parent != q) {
-            swap_nodes(q, leader);
+// --- Bit I/O ---
+
+typedef struct BitWriter {
+    unsigned char* data;
+    size_t size, capacity;
+    uint64_t acc;  // pending bits in the low count bits
+    int count;
+} BitWriter;
+
+typedef struct BitReader {
+    const unsigned char *in, *end;
+    uint64_t acc;  // next bits, first bit highest
+    int count;
+} BitReader;
+
+void* checked_realloc(void* p, size_t bytes) {
+    p = realloc(p, bytes ? bytes : 1);
+    if (p == NULL) {
+        perror("Memory allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+// Appends the low len <= 32 bits of value, highest first
+void put_bits(BitWriter* w, uint32_t value, int len) {
+    w->acc = w->acc << len | value;
+    w->count += len;
+    if (w->count >= 32) {
+        if (w->size + 4 > w->capacity) {
+            w->capacity = 2 * w->capacity + 4096;
+            w->data = (unsigned char*)checked_realloc(w->data, w->capacity);
         }
-        
-        q->weight++;
-        q = q->parent;
+        w->count -= 32;
+        uint32_t v = (uint32_t)(w->acc >> w->count);
+        w->data[w->size++] = (unsigned char)(v >> 24);
+        w->data[w->size++] = (unsigned char)(v >> 16);
+        w->data[w->size++] = (unsigned char)(v >> 8);
+        w->data[w->size++] = (unsigned char)v;
     }
 }
 
-// Add a new symbol to the tree (spawning from NYT)
-void spawn_nyt(int symbol) {
-    Node *old_nyt = nyt_node;
-    
-    // Create new internal node
-    Node *new_internal = (Node *)malloc(sizeof(Node));
-    new_internal->weight = 1; // Will be 0 initially, incremented by update
-    new_internal->symbol = -1;
-    new_internal->id = old_nyt->id; // Takes old NYT's ID
-    new_internal->parent = old_nyt->parent;
-    new_internal->left = old_nyt; // Old NYT becomes left child
-    
-    // Create new leaf node for symbol
-    Node *new_leaf = (Node *)malloc(sizeof(Node));
-    new_leaf->weight = 1; // Will be incremented
-    new_leaf->symbol = symbol;
-    new_leaf->id = old_nyt->id - 1;
-    new_leaf->parent = new_internal;
-    new_leaf->left = NULL;
-    new_leaf->right = NULL;
-    
-    // Reset Old NYT
-    old_nyt->weight = 0;
-    old_nyt->id = old_nyt->id - 2;
-    old_nyt->parent = new_internal;
-    
-    // Link new internal node to parent
-    if (new_internal->parent) {
-        if (new_internal->parent->left == old_nyt) 
-            new_internal->parent->left = new_internal;
-        else 
-            new_internal->parent->right = new_internal;
+void flush_bits(BitWriter* w) {
+    // Pad to whole 32-bit words, then drop the padding bytes
+    int pad = (32 - w->count) & 31, bytes = (w->count + 7) / 8;
+    if (pad) {
+        put_bits(w, 0, pad);
+        w->size -= 4 - bytes;
+    }
+}
+
+// Writes the code of node q: the bits from the root down to q
+void put_code(const AdaptiveHuffman* h, BitWriter* w, int q) {
+    uint32_t chunks[MAX_NODES / 32 + 1];
+    uint32_t code = 0;
+    int len = 0, top = 0;
+    for (int i = q; i != ROOT; i = h->parent[i]) {
+        code |= (uint32_t)(i & 1) << len;
+        if (++len == 32) {
+            chunks[top++] = code;
+            code = 0;
+            len = 0;
+        }
+    }
+    // The last bits collected are the ones nearest the root
+    if (len)
+        put_bits(w, code, len);
+    while (top > 0)
+        put_bits(w, chunks[--top], 32);
+}
+
+// Next bit, or -1 at the end of the input
+int get_bit(BitReader* r) {
+    if (r->count == 0) {
+        if (r->in == r->end)
+            return -1;
+        while (r->count <= 56 && r->in < r->end) {
+            r->acc |= (uint64_t)*r->in++ << (56 - r->count);
+            r->count += 8;
+        }
+    }
+    int bit = (int)(r->acc >> 63);
+    r->acc <<= 1;
+    r->count--;
+    return bit;
+}
+
+// --- Coder ---
+
+void encode_symbol(AdaptiveHuffman* h, BitWriter* w, int symbol) {
+    int q = h->leaf_table[symbol];
+    if (q < 0) {
+        // Transmit the NYT code, then the symbol's fixed 8-bit code
+        put_code(h, w, h->nyt_node);
+        put_bits(w, symbol, 8);
+        spawn_nyt(h, symbol);
     } else {
-        root = new_internal;
-    }
-    
-    new_internal->right = new_leaf; // Right child is the new symbol
-    
-    // Update Tables
-    nodes[new_internal->id] = new_internal;
-    nodes[new_leaf->id] = new_leaf;
-    nodes[old_nyt->id] = old_nyt;
-    leaf_table[symbol] = new_leaf;
-    
-    next_id -= 2;
-    
-    // Increment weights up to root (Start from parent of new leaf)
-    update_tree(new_internal->parent);
+        put_code(h, w, q);
+        update_tree(h, q);
+    }
+}
+
+// Next symbol, or -1 if the input ends first
+int decode_symbol(AdaptiveHuffman* h, BitReader* r) {
+    int q = ROOT;
+    while (h->child[q] >= 0) {
+        int bit = get_bit(r);
+        if (bit < 0)
+            return -1;
+        q = h->child[q] - 1 + bit;
+    }
+    int symbol = -1 - h->child[q];
+    if (symbol != NYT_SYMBOL) {
+        update_tree(h, q);
+        return symbol;
+    }
+    symbol = 0;
+    for (int k = 0; k < 8; k++) {
+        int bit = get_bit(r);
+        if (bit < 0)
+            return -1;
+        symbol = symbol << 1 | bit;
+    }
+    spawn_nyt(h, symbol);
+    return symbol;
+}
+
+// Encodes n bytes; returns the bit stream, *len bytes long
+unsigned char* adaptive_compress(AdaptiveHuffman* h, const unsigned char* src, size_t n, size_t* len) {
+    BitWriter w = {NULL, 0, 0, 0, 0};
+    reset_context(h);
+    for (size_t i = 0; i < n; i++)
+        encode_symbol(h, &w, src[i]);
+    flush_bits(&w);
+    *len = w.size;
+    return w.data;
+}
+
+// Decodes n bytes; returns 0, or -1 if the stream ends early
+int adaptive_decompress(AdaptiveHuffman* h, const unsigned char* src, size_t len, unsigned char* dst, size_t n) {
+    BitReader r = {src, src + len, 0, 0};
+    reset_context(h);
+    for (size_t i = 0; i < n; i++) {
+        int symbol = decode_symbol(h, &r);
+        if (symbol < 0)
+            return -1;
+        dst[i] = (unsigned char)symbol;
+    }
+    return 0;
 }
 
 // --- Output Functions ---
 
-void print_code(Node *n) {
-    if (n == NULL || n->parent == NULL) return;
-    print_code(n->parent);
-    if (n->parent->left == n) printf("0");
-    else printf("1");
+void print_code(const AdaptiveHuffman* h, int q) {
+    char bits[MAX_NODES + 1];
+    int len = 0;
+    for (int i = q; i != ROOT; i = h->parent[i])
+        bits[len++] = (char)('0' + (i & 1));
+    while (len > 0)
+        putchar(bits[--len]);
 }
 
-void adaptive_encode(char *input) {
-    init_tree();
-    
+void adaptive_encode(const char* input) {
+    AdaptiveHuffman* h = create_context();
+
     printf("Input: %s\n", input);
     printf("Encoding Stream:\n");
-    
+
     for (int i = 0; input[i] != '\0'; i++) {
         int symbol = (unsigned char)input[i];
-        
-        if (leaf_table[symbol] == NULL) {
+
+        if (h->leaf_table[symbol] < 0) {
             // 1. Transmit NYT Code
-            print_code(nyt_node);
-            
+            print_code(h, h->nyt_node);
+
             // 2. Transmit fixed code for symbol (8-bit ASCII for simplicity)
             // In Sayood's book, this is e+1 bits, but we use standard char here.
             printf(" [NYT '%c'] ", symbol);
-            
+
             // 3. Spawn new node and update
-            spawn_nyt(symbol);
+            spawn_nyt(h, symbol);
         } else {
             // 1. Transmit Symbol Code
-            print_code(leaf_table[symbol]);
+            print_code(h, h->leaf_table[symbol]);
             printf(" ");
-            
+
             // 2. Update Tree (Section 3.4.1)
-            update_tree(leaf_table[symbol]);
+            update_tree(h, h->leaf_table[symbol]);
         }
     }
     printf("\n");
+    free_context(h);
+}
+
+// --- Files ---
+
+double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+unsigned char* read_file(const char* filename, size_t* n) {
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        perror(filename);
+        exit(1);
+    }
+    size_t capacity = 1 << 16, got;
+    unsigned char* data = (unsigned char*)checked_realloc(NULL, capacity);
+    *n = 0;
+    while ((got = fread(data + *n, 1, capacity - *n, f)) > 0) {
+        *n += got;
+        if (*n == capacity) {
+            capacity *= 2;
+            data = (unsigned char*)checked_realloc(data, capacity);
+        }
+    }
+    if (ferror(f)) {
+        perror(filename);
+        exit(1);
+    }
+    fclose(f);
+    return data;
+}
+
+void write_file(const char* filename, const unsigned char* header, size_t header_len, const unsigned char* data,
+                size_t n) {
+    FILE* f = fopen(filename, "wb");
+    if (!f || (header_len && fwrite(header, 1, header_len, f) != header_len) || (n && fwrite(data, 1, n, f) != n) ||
+        fclose(f) != 0) {
+        perror(filename);
+        exit(1);
+    }
+}
+
+void encode_file(const char* input, const char* output) {
+    size_t n, len;
+    unsigned char* src = read_file(input, &n);
+    AdaptiveHuffman* h = create_context();
+    double t = now_seconds();
+    unsigned char* bits = adaptive_compress(h, src, n, &len);
+    t = now_seconds() - t;
+
+    unsigned char header[12];
+    memcpy(header, MAGIC, 4);
+    for (int i = 0; i < 8; i++)
+        header[4 + i] = (unsigned char)((uint64_t)n >> (8 * i));
+    write_file(output, header, sizeof(header), bits, len);
+    printf("%zu -> %zu bytes (%.2f bits/byte), %.1f MB/s\n", n, len + sizeof(header), n ? 8.0 * len / n : 0.0,
+           t > 0 ? n / t / 1e6 : 0.0);
+    free_context(h);
+    free(src);
+    free(bits);
+}
+
+void decode_file(const char* input, const char* output) {
+    size_t len;
+    unsigned char* src = read_file(input, &len);
+    if (len < 12 || memcmp(src, MAGIC, 4) != 0) {
+        fprintf(stderr, "%s: not an adaptive Huffman file\n", input);
+        exit(1);
+    }
+    uint64_t n = 0;
+    for (int i = 0; i < 8; i++)
+        n |= (uint64_t)src[4 + i] << (8 * i);
+    // Every symbol takes at least one bit once the tree has two leaves
+    if (n / 8 > len) {
+        fprintf(stderr, "%s: size field is corrupt\n", input);
+        exit(1);
+    }
+    unsigned char* dst = (unsigned char*)checked_realloc(NULL, n);
+    AdaptiveHuffman* h = create_context();
+    double t = now_seconds();
+    if (adaptive_decompress(h, src + 12, len - 12, dst, n) != 0) {
+        fprintf(stderr, "%s: stream ends early\n", input);
+        exit(1);
+    }
+    t = now_seconds() - t;
+    write_file(output, NULL, 0, dst, n);
+    printf("%zu -> %llu bytes, %.1f MB/s\n", len, (unsigned long long)n, t > 0 ? n / t / 1e6 : 0.0);
+    free_context(h);
+    free(src);
+    free(dst);
+}
+
+// --- Sessions ---
+
+// One stream of the benchmark: its own context, input and bit stream
+typedef struct Session {
+    unsigned char* input;
+    BitWriter writer;
+    BitReader reader;
+} Session;
+
+uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
 }
 
-int main() {
-    // Example from the book usually involves "aardvark" to show repetition effects
-    char *data = "aardvark";
-    adaptive_encode(data);
+// Skewed bytes over a range that differs per session, so trees differ
+void fill_session(unsigned char* data, size_t n, int session) {
+    uint64_t state = 0x9E3779B97F4A7C15ULL * (uint64_t)(session + 1);
+    int base = (int)(next_random(&state) % 256);
+    int span = 2 + (int)(next_random(&state) % 255);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t x = next_random(&state);
+        int k = (int)((x % span) * ((x >> 32) % span) / span);
+        data[i] = (unsigned char)(base + k);
+    }
+}
+
+// Runs many independent streams side by side. Each round, every session
+// encodes its next message of message_len bytes in parallel, as a server
+// interleaving traffic from many connections would. The decoder reuses the
+// same contexts after a reset and checks every byte.
+int session_benchmark(int sessions, size_t bytes, size_t message_len) {
+    Session* s = (Session*)checked_realloc(NULL, sessions * sizeof(Session));
+    AdaptiveHuffman* contexts = (AdaptiveHuffman*)checked_realloc(NULL, sessions * sizeof(AdaptiveHuffman));
+    unsigned char* output = (unsigned char*)checked_realloc(NULL, sessions * bytes);
+    size_t rounds = (bytes + message_len - 1) / message_len;
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < sessions; i++) {
+        s[i].input = (unsigned char*)checked_realloc(NULL, bytes);
+        fill_session(s[i].input, bytes, i);
+        s[i].writer = (BitWriter){NULL, 0, 0, 0, 0};
+        reset_context(&contexts[i]);
+    }
+
+    double t = now_seconds();
+    for (size_t r = 0; r < rounds; r++) {
+        size_t begin = r * message_len, end = begin + message_len < bytes ? begin + message_len : bytes;
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (int i = 0; i < sessions; i++)
+            for (size_t k = begin; k < end; k++)
+                encode_symbol(&contexts[i], &s[i].writer, s[i].input[k]);
+    }
+    size_t total_bits = 0;
+    for (int i = 0; i < sessions; i++) {
+        flush_bits(&s[i].writer);
+        total_bits += 8 * s[i].writer.size;
+    }
+    double encode_time = now_seconds() - t;
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < sessions; i++) {
+        s[i].reader = (BitReader){s[i].writer.data, s[i].writer.data + s[i].writer.size, 0, 0};
+        reset_context(&contexts[i]);
+    }
+
+    int failures = 0;
+    t = now_seconds();
+    for (size_t r = 0; r < rounds; r++) {
+        size_t begin = r * message_len, end = begin + message_len < bytes ? begin + message_len : bytes;
+        #pragma omp parallel for schedule(dynamic, 16) reduction(+ : failures)
+        for (int i = 0; i < sessions; i++) {
+            unsigned char* dst = output + (size_t)i * bytes;
+            for (size_t k = begin; k < end; k++) {
+                int symbol = decode_symbol(&contexts[i], &s[i].reader);
+                if (symbol < 0) {
+                    failures++;
+                    break;
+                }
+                dst[k] = (unsigned char)symbol;
+            }
+        }
+    }
+    double decode_time = now_seconds() - t;
+
+    for (int i = 0; i < sessions; i++) {
+        if (memcmp(output + (size_t)i * bytes, s[i].input, bytes) != 0)
+            failures++;
+        free(s[i].input);
+        free(s[i].writer.data);
+    }
+
+    double total = (double)sessions * bytes;
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    printf("%d sessions x %zu bytes in %zu-byte messages, %d threads, %zu-byte context\n", sessions, bytes,
+           message_len, threads, sizeof(AdaptiveHuffman));
+    printf("%.2f bits/byte, encode %.1f MB/s, decode %.1f MB/s\n", total > 0 ? total_bits / total : 0.0,
+           encode_time > 0 ? total / encode_time / 1e6 : 0.0, decode_time > 0 ? total / decode_time / 1e6 : 0.0);
+    if (failures)
+        printf("MISMATCH in %d sessions\n", failures);
+    free(s);
+    free(contexts);
+    free(output);
+    return failures != 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 4 && strcmp(argv[1], "e") == 0) {
+        encode_file(argv[2], argv[3]);
+    } else if (argc == 4 && strcmp(argv[1], "d") == 0) {
+        decode_file(argv[2], argv[3]);
+    } else if (argc >= 2 && argc <= 5 && strcmp(argv[1], "s") == 0) {
+        int sessions = argc > 2 ? atoi(argv[2]) : 4096;
+        long bytes = argc > 3 ? atol(argv[3]) : 16384;
+        long message_len = argc > 4 ? atol(argv[4]) : 512;
+        if (sessions < 1 || bytes < 1 || message_len < 1) {
+            fprintf(stderr, "sessions, bytes and message length must be positive\n");
+            return 1;
+        }
+        return session_benchmark(sessions, (size_t)bytes, (size_t)message_len);
+    } else if (argc == 1) {
+        // Example from the book usually involves "aardvark" to show repetition effects
+        adaptive_encode("aardvark");
+    } else {
+        printf("Usage: %s [e|d input output] [s [sessions] [bytes] [message]]\n", argv[0]);
+        return 1;
+    }
     return 0;
 }
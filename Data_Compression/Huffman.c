@@ -1,201 +1,422 @@
+/* Huffman coding of files
+Based on CLRS Chapter 16.3
+
+The engine lives in huffman.h. The tree built by buildHuffmanTree gives the
+code lengths. Package-merge limits them to HUFFMAN_MAX_BITS, and codes are
+assigned canonically, so a block stores only the 256 code lengths. A
+64-bit bit writer encodes; a table decoder resolves several symbols per
+lookup.
+
+Files are cut into blocks (-b, default 256 KB), each with its own code.
+The blocks are compressed and decompressed in parallel with OpenMP. An
+index of block offsets in the header lets r decode any byte range from
+just the blocks that cover it. Each block is coded as four streams that
+one loop decodes together (-s 4, the default), or as a single stream
+(-s 1).
+
+The t mode round-trips every given file, or a built-in set of inputs
+(empty, one byte, one symbol, all bytes, skewed past the length limit,
+text, random), through memory. It checks that decoding is bit-exact,
+whole and over random ranges, and reports sizes and throughput. It exits
+with 1 if any check fails. Both stream layouts are checked.
+
+The b mode compares the single-stream and four-stream decode loops on one
+thread over the same inputs. It times only the loops, not the table
+builds, and reports cycles per byte (TSC ticks on x86, else nanoseconds).
+
+gcc -O3 -fopenmp Huffman.c -o huffman
+./huffman                                codes of a line of text
+./huffman c [-b KB] [-s 1|4] input output   compress
+./huffman d input output                    decompress
+./huffman r input offset length output      decompress a byte range
+./huffman t [-b KB] [files ...]             round-trip check and throughput
+./huffman b [-b KB] [files ...]             decode loops in cycles/byte */
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-// gcc huffman.c -o huffman
-
-#define MAX_TREE_HT 256
-
-// A Huffman tree node
-struct MinHeapNode {
-    char data;               // input character
-    unsigned freq;           // frequency of the character
-    struct MinHeapNode *left, *right;  // left and right child
-};
-
-// A Min Heap
-struct MinHeap {
-    unsigned size;
-    unsigned capacity;
-    struct MinHeapNode** array;
-};
-
-// Create a new node
-struct MinHeapNode* newNode(char data, unsigned freq) {
-    struct MinHeapNode* temp = 
-        (struct MinHeapNode*) malloc(sizeof(struct MinHeapNode));
-    temp->left = temp->right = NULL;
-    temp->data = data;
-    temp->freq = freq;
-    return temp;
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "huffman.h"
+#include "../Algorithms/xorshift.h"
+
+// Decoding of each round-trip input is repeated for at least this long
+#define MIN_BENCH_SECONDS 0.2
+
+// Random ranges decoded per round trip
+#define RANGE_CHECKS 100
+
+size_t blockSize = HUFFMAN_BLOCK_SIZE;
+int streamLayout = HUFFMAN_STREAMS;  // -s, used by the c mode
+
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
-// Create min heap
-struct MinHeap* createMinHeap(unsigned capacity) {
-    struct MinHeap* minHeap = 
-         (struct MinHeap*) malloc(sizeof(struct MinHeap));
-    minHeap->size = 0;
-    minHeap->capacity = capacity;
-    minHeap->array =
-        (struct MinHeapNode**) malloc(minHeap->capacity * sizeof(struct MinHeapNode*));
-    return minHeap;
+int maxThreads(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
 }
 
-void swapMinHeapNode(struct MinHeapNode** a, struct MinHeapNode** b) {
-    struct MinHeapNode* t = *a;
-    *a = *b;
-    *b = t;
+// TSC ticks where available, else nanoseconds
+long long readTicks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return (long long)__rdtsc();
+#else
+    return (long long)(now() * 1e9);
+#endif
 }
 
-// Heapify
-void minHeapify(struct MinHeap* minHeap, int idx) {
-    int smallest = idx;
-    int left = 2 * idx + 1;
-    int right = 2 * idx + 2;
-
-    if (left < (int)minHeap->size &&
-        minHeap->array[left]->freq < minHeap->array[smallest]->freq)
-        smallest = left;
-
-    if (right < (int)minHeap->size &&
-        minHeap->array[right]->freq < minHeap->array[smallest]->freq)
-        smallest = right;
-
-    if (smallest != idx) {
-        swapMinHeapNode(&minHeap->array[smallest], &minHeap->array[idx]);
-        minHeapify(minHeap, smallest);
+// Print canonical Huffman codes, first bit first
+void printCodes(const struct HuffmanCode* c) {
+    for (int s = 0; s < HUFFMAN_SYMBOLS; s++) {
+        if (c->length[s] == 0)
+            continue;
+        if (s >= 32 && s < 127)
+            printf("Character '%c' : ", s);
+        else
+            printf("Byte 0x%02x : ", s);
+        for (int i = 0; i < c->length[s]; i++)
+            printf("%d", (c->code[s] >> i) & 1);
+        printf("\n");
     }
 }
 
-// Check size = 1
-int isSizeOne(struct MinHeap* minHeap) {
-    return (minHeap->size == 1);
+// Wrapper
+void HuffmanCodes(const unsigned char* text, size_t n) {
+    struct HuffmanCode c;
+    huffmanBuildCode(text, n, &c);
+    printCodes(&c);
 }
 
-// Extract minimum value node
-struct MinHeapNode* extractMin(struct MinHeap* minHeap) {
-    struct MinHeapNode* temp = minHeap->array[0];
-    minHeap->array[0] = minHeap->array[minHeap->size - 1];
-    --minHeap->size;
-    minHeapify(minHeap, 0);
-    return temp;
+// ---------- Files ----------
+unsigned char* readFile(const char* filename, size_t* n) {
+    FILE* f = fopen(filename, "rb");
+    if (!f) {
+        perror(filename);
+        exit(1);
+    }
+    size_t cap = 1 << 16;
+    *n = 0;
+    unsigned char* data = (unsigned char*)huffmanAlloc(cap);
+    size_t got;
+    while ((got = fread(data + *n, 1, cap - *n, f)) > 0) {
+        *n += got;
+        if (*n == cap) {
+            cap *= 2;
+            data = (unsigned char*)realloc(data, cap);
+            if (data == NULL) {
+                perror("Memory allocation failed");
+                exit(1);
+            }
+        }
+    }
+    if (ferror(f)) {
+        perror(filename);
+        exit(1);
+    }
+    fclose(f);
+    return data;
 }
 
-// Insert node
-void insertMinHeap(struct MinHeap* minHeap, struct MinHeapNode* minHeapNode) {
-    ++minHeap->size;
-    int i = minHeap->size - 1;
-
-    while (i && minHeapNode->freq < minHeap->array[(i - 1) / 2]->freq) {
-        minHeap->array[i] = minHeap->array[(i - 1) / 2];
-        i = (i - 1) / 2;
+void writeFile(const char* filename, const unsigned char* data, size_t n) {
+    FILE* f = fopen(filename, "wb");
+    if (!f || fwrite(data, 1, n, f) != n || fclose(f) != 0) {
+        perror(filename);
+        exit(1);
     }
-
-    minHeap->array[i] = minHeapNode;
 }
 
-// Build a min heap
-void buildMinHeap(struct MinHeap* minHeap) {
-    int n = minHeap->size - 1;
-    int i;
-
-    for (i = (n - 1) / 2; i >= 0; --i)
-        minHeapify(minHeap, i);
+void compressFile(const char* input, const char* output) {
+    size_t n;
+    unsigned char* src = readFile(input, &n);
+    unsigned char* dst = (unsigned char*)huffmanAlloc(huffmanCompressBound(n, blockSize));
+    double t = now();
+    size_t len = huffmanCompress(src, n, blockSize, streamLayout, dst);
+    t = now() - t;
+    writeFile(output, dst, len);
+    printf("%zu -> %zu bytes (%.2f bits/byte), %zu blocks, %d threads, %.1f MB/s\n", n, len,
+           n ? 8.0 * len / n : 0.0, huffmanBlockCount(n, blockSize), maxThreads(), t > 0 ? n / t / 1e6 : 0.0);
+    free(src);
+    free(dst);
 }
 
-// Check leaf
-int isLeaf(struct MinHeapNode* root) {
-    return !(root->left) && !(root->right);
+// Decompresses input, or only bytes [offset, offset + count) if range is set
+void decompressFile(const char* input, const char* output, int range, size_t offset, size_t count) {
+    size_t len;
+    unsigned char* src = readFile(input, &len);
+    long long n = huffmanDecompressedSize(src, len);
+    if (n < 0) {
+        fprintf(stderr, "%s: not a Huffman file\n", input);
+        exit(1);
+    }
+    if (!range)
+        count = n;
+    if (offset > (size_t)n || count > (size_t)n - offset) {
+        fprintf(stderr, "%s: range outside the data (%lld bytes)\n", input, n);
+        exit(1);
+    }
+    unsigned char* dst = (unsigned char*)huffmanAlloc(count);
+    double t = now();
+    int status = range ? huffmanDecompressRange(src, len, offset, count, dst) : huffmanDecompress(src, len, dst);
+    t = now() - t;
+    if (status != 0) {
+        fprintf(stderr, range ? "%s: range outside the data or corrupt stream\n" : "%s: corrupt stream\n", input);
+        exit(1);
+    }
+    writeFile(output, dst, count);
+    printf("%zu -> %zu bytes, %d threads, %.1f MB/s\n", len, count, maxThreads(),
+           t > 0 ? count / t / 1e6 : 0.0);
+    free(src);
+    free(dst);
 }
 
-// Create and build min heap
-struct MinHeap* createAndBuildMinHeap(char data[], int freq[], int size) {
-    struct MinHeap* minHeap = createMinHeap(size);
-
-    for (int i = 0; i < size; ++i)
-        minHeap->array[i] = newNode(data[i], freq[i]);
-
-    minHeap->size = size;
-    buildMinHeap(minHeap);
-
-    return minHeap;
+// ---------- Round-trip check ----------
+// Compresses and decompresses src with the given stream layout; returns 0
+// if the result is bit-exact
+int roundTripStreams(const char* name, const unsigned char* src, size_t n, int streams) {
+    unsigned char* packed = (unsigned char*)huffmanAlloc(huffmanCompressBound(n, blockSize));
+    unsigned char* back = (unsigned char*)huffmanAlloc(n);
+
+    double t = now();
+    size_t len = huffmanCompress(src, n, blockSize, streams, packed);
+    double encode = now() - t;
+
+    int reps = 0;
+    double decode = 0;
+    int ok = huffmanDecompressedSize(packed, len) == (long long)n;
+    t = now();
+    do {
+        ok = ok && huffmanDecompress(packed, len, back) == 0 && memcmp(src, back, n) == 0;
+        reps++;
+        decode = now() - t;
+    } while (ok && decode < MIN_BENCH_SECONDS);
+    decode /= reps;
+
+    // Ranges, including ones crossing block boundaries and empty ones
+    for (int i = 0; ok && i < RANGE_CHECKS; i++) {
+        size_t offset = xorshift64() % (n + 1);
+        size_t count = xorshift64() % (n - offset + 1);
+        memset(back, 0, count);
+        ok = huffmanDecompressRange(packed, len, offset, count, back) == 0 && memcmp(src + offset, back, count) == 0;
+    }
+    ok = ok && huffmanDecompressRange(packed, len, n, 1, back) != 0;
+
+    // A truncated stream must be rejected, never overrun
+    if (ok && n > 0 && huffmanDecompress(packed, len - 1, back) == 0)
+        ok = 0;
+
+    printf("%-20s %d %10zu -> %10zu  %5.2f bits/byte  encode %7.1f MB/s  decode %7.1f MB/s  %s\n", name, streams, n,
+           len, n ? 8.0 * len / n : 0.0, encode > 0 ? n / encode / 1e6 : 0.0, decode > 0 ? n / decode / 1e6 : 0.0,
+           ok ? "ok" : "MISMATCH");
+    free(packed);
+    free(back);
+    return ok ? 0 : 1;
 }
 
-// Build Huffman Tree
-struct MinHeapNode* buildHuffmanTree(char data[], int freq[], int size) {
-    struct MinHeapNode *left, *right, *top;
-
-    struct MinHeap* minHeap = createAndBuildMinHeap(data, freq, size);
-
-    while (!isSizeOne(minHeap)) {
-        left = extractMin(minHeap);
-        right = extractMin(minHeap);
+int roundTrip(const char* name, const unsigned char* src, size_t n) {
+    return roundTripStreams(name, src, n, 1) + roundTripStreams(name, src, n, HUFFMAN_STREAMS);
+}
 
-        top = newNode('$', left->freq + right->freq);
-        top->left = left;
-        top->right = right;
+// ---------- Decode loop benchmark ----------
+// Times the single-stream or four-stream decode loop over the blocks of
+// src on one thread; returns the best ticks per byte, or -1 on a mismatch
+double decodeTicksPerByte(const unsigned char* src, size_t n, int streams, double* seconds) {
+    size_t blocks = huffmanBlockCount(n, blockSize), slot = huffmanMaxBlockSize(blockSize);
+    unsigned char* packed = (unsigned char*)huffmanAlloc(blocks * slot);
+    unsigned char* back = (unsigned char*)huffmanAlloc(n);
+    struct HuffmanDecoder* d = (struct HuffmanDecoder*)huffmanAlloc(blocks * sizeof(struct HuffmanDecoder));
+    const unsigned char** start = (const unsigned char**)huffmanAlloc(blocks * HUFFMAN_STREAMS * sizeof(void*));
+    size_t* size = (size_t*)huffmanAlloc(blocks * HUFFMAN_STREAMS * sizeof(size_t));
+
+    // Encoding and the decode tables stay out of the timing
+    int ok = 1;
+    for (size_t b = 0; b < blocks && ok; b++) {
+        size_t len = b + 1 < blocks ? blockSize : n - b * blockSize;
+        unsigned char* block = packed + b * slot;
+        size_t blockLen = huffmanEncodeBlock(src + b * blockSize, len, block, streams);
+        int lengths[HUFFMAN_SYMBOLS];
+        huffmanUnpackLengths(block, lengths);
+        ok = huffmanBuildDecoder(lengths, &d[b]) &&
+             !huffmanBlockStreams(block, blockLen, streams, start + b * HUFFMAN_STREAMS, size + b * HUFFMAN_STREAMS);
+    }
 
-        insertMinHeap(minHeap, top);
+    long long best = -1;
+    double begin = now(), fastest = 0;
+    while (ok) {
+        double t = now();
+        long long ticks = readTicks();
+        for (size_t b = 0; b < blocks; b++) {
+            size_t len = b + 1 < blocks ? blockSize : n - b * blockSize;
+            const unsigned char** s = start + b * HUFFMAN_STREAMS;
+            size_t* z = size + b * HUFFMAN_STREAMS;
+            ok &= (streams == 1 ? huffmanDecodeBits(&d[b], s[0], z[0], back + b * blockSize, len)
+                                : huffmanDecodeBits4(&d[b], s, z, back + b * blockSize, len)) == 0;
+        }
+        ticks = readTicks() - ticks;
+        t = now() - t;
+        if (best < 0 || ticks < best) {
+            best = ticks;
+            fastest = t;
+        }
+        if (now() - begin >= MIN_BENCH_SECONDS)
+            break;
     }
+    ok = ok && memcmp(src, back, n) == 0;
+
+    free(packed);
+    free(back);
+    free(d);
+    free(start);
+    free(size);
+    *seconds = fastest;
+    return ok ? (double)best / n : -1;
+}
 
-    return extractMin(minHeap);
+int benchmarkDecode(const char* name, const unsigned char* src, size_t n) {
+    if (n == 0)
+        return 0;
+    double t1, t4;
+    double one = decodeTicksPerByte(src, n, 1, &t1);
+    double four = decodeTicksPerByte(src, n, HUFFMAN_STREAMS, &t4);
+    int ok = one >= 0 && four >= 0;
+    printf("%-20s %10zu  1 stream %6.2f cycles/byte %7.1f MB/s  4 streams %6.2f cycles/byte %7.1f MB/s  %5.2fx  %s\n",
+           name, n, one, t1 > 0 ? n / t1 / 1e6 : 0.0, four, t4 > 0 ? n / t4 / 1e6 : 0.0, four > 0 ? one / four : 0.0,
+           ok ? "ok" : "MISMATCH");
+    return ok ? 0 : 1;
 }
 
-// Print Huffman Codes
-void printCodes(struct MinHeapNode* root, int arr[], int top) {
-    if (root->left) {
-        arr[top] = 0;
-        printCodes(root->left, arr, top + 1);
+// Runs check over built-in inputs covering the code's edge cases
+int forEachBuiltinInput(int (*check)(const char* name, const unsigned char* src, size_t n)) {
+    const size_t n = 1 << 24;
+    unsigned char* data = (unsigned char*)huffmanAlloc(n);
+    int failures = 0;
+
+    data[0] = 'a';
+    failures += check("empty", data, 0);
+    failures += check("one byte", data, 1);
+    memset(data, 0xff, n);
+    failures += check("one symbol", data, n);
+
+    for (size_t i = 0; i < n; i++)
+        data[i] = (unsigned char)i;
+    failures += check("all bytes", data, n);
+
+    // Fibonacci frequencies make the tree about 30 levels deep
+    size_t fib[30] = {1, 1}, used = 0;
+    for (int i = 2; i < 30; i++)
+        fib[i] = fib[i - 1] + fib[i - 2];
+    for (int s = 0; s < 30; s++)
+        for (size_t k = 0; k < fib[s] && used < n; k++)
+            data[used++] = (unsigned char)s;
+    for (size_t i = used; i > 1; i--) {
+        size_t j = xorshift64() % i;
+        unsigned char t = data[i - 1];
+        data[i - 1] = data[j];
+        data[j] = t;
     }
-
-    if (root->right) {
-        arr[top] = 1;
-        printCodes(root->right, arr, top + 1);
+    failures += check("skewed (limited)", data, used);
+
+    static const char* words[] = {"the ", "of ", "and ", "huffman ", "code ", "tree ", "a ", "is ",
+                                  "symbol ", "length ", "table ", "bit ", "stream ", ".\n", ", ", "to "};
+    for (size_t i = 0; i < n;) {
+        const char* w = words[xorshift64() % 16];
+        for (; *w && i < n; w++)
+            data[i++] = (unsigned char)*w;
     }
+    failures += check("text", data, n);
 
-    if (isLeaf(root)) {
-        printf("Character '%c' : ", root->data);
-        for (int i = 0; i < top; ++i)
-            printf("%d", arr[i]);
-        printf("\n");
+    // Geometric bytes: a few very short codes, as in residuals
+    for (size_t i = 0; i < n; i++) {
+        unsigned long long r = xorshift64();
+        data[i] = (unsigned char)(r ? __builtin_ctzll(r) : 64);
     }
-}
+    failures += check("geometric", data, n);
 
-// Wrapper
-void HuffmanCodes(char data[], int freq[], int size) {
-    struct MinHeapNode* root = buildHuffmanTree(data, freq, size);
-    int arr[MAX_TREE_HT], top = 0;
-    printCodes(root, arr, top);
+    for (size_t i = 0; i < n; i++)
+        data[i] = (unsigned char)xorshift64();
+    failures += check("random", data, n);
+
+    // Odd sizes exercise the encoder's and decoder's tails
+    static const size_t tails[] = {2, 3, 5, 15, 17, 33, 1000003};
+    for (int i = 0; i < 7; i++)
+        failures += check("random (tail)", data, tails[i]);
+
+    free(data);
+    return failures;
 }
 
-int main() {
-    char text[1000];
-    printf("Enter a text: ");
-    fgets(text, sizeof(text), stdin);
+void usage(const char* program) {
+    printf("Usage: %s [c [-b KB] [-s 1|4] input output | d input output | r input offset length output | "
+           "t|b [-b KB] [files ...]]\n", program);
+    exit(1);
+}
 
-    int freq[256] = {0};
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        char text[1000];
+        printf("Enter a text: ");
+        if (!fgets(text, sizeof(text), stdin))
+            return 0;
 
-    // Count frequencies
-    for (int i = 0; text[i] != '\0'; i++) {
-        unsigned char c = text[i];
-        freq[c]++;
+        printf("\nHuffman Codes:\n");
+        HuffmanCodes((const unsigned char*)text, strlen(text));
+        return 0;
     }
 
-    // Prepare data and non-zero freq arrays
-    char data[256];
-    int freq2[256];
-    int size = 0;
-
-    for (int i = 0; i < 256; i++) {
-        if (freq[i] > 0) {
-            data[size] = (char)i;
-            freq2[size] = freq[i];
-            size++;
+    const char* mode = argv[1];
+    int first = 2;
+    for (; first + 1 < argc && argv[first][0] == '-'; first += 2) {
+        if (strcmp(argv[first], "-b") == 0) {
+            long kb = atol(argv[first + 1]);
+            if (kb < 1 || kb > 1 << 20) {
+                fprintf(stderr, "Block size must be 1 KB to 1 GB\n");
+                return 1;
+            }
+            blockSize = (size_t)kb * 1024;
+        } else if (strcmp(argv[first], "-s") == 0) {
+            streamLayout = atoi(argv[first + 1]);
+            if (streamLayout != 1 && streamLayout != HUFFMAN_STREAMS)
+                usage(argv[0]);
+        } else {
+            usage(argv[0]);
         }
     }
-
-    printf("\nHuffman Codes:\n");
-    HuffmanCodes(data, freq2, size);
-
+    int args = argc - first;
+
+    if (strcmp(mode, "c") == 0 && args == 2) {
+        compressFile(argv[first], argv[first + 1]);
+    } else if (strcmp(mode, "d") == 0 && args == 2) {
+        decompressFile(argv[first], argv[first + 1], 0, 0, 0);
+    } else if (strcmp(mode, "r") == 0 && args == 4) {
+        decompressFile(argv[first], argv[first + 3], 1, strtoull(argv[first + 1], NULL, 10),
+                       strtoull(argv[first + 2], NULL, 10));
+    } else if (strcmp(mode, "t") == 0 || strcmp(mode, "b") == 0) {
+        int (*check)(const char*, const unsigned char*, size_t) = mode[0] == 't' ? roundTrip : benchmarkDecode;
+        int failures = 0;
+        if (args == 0)
+            failures = forEachBuiltinInput(check);
+        for (int i = first; i < argc; i++) {
+            size_t n;
+            unsigned char* data = readFile(argv[i], &n);
+            failures += check(argv[i], data, n);
+            free(data);
+        }
+        printf("%s\n", failures ? "FAILED" : "all checks passed");
+        return failures ? 1 : 0;
+    } else {
+        usage(argv[0]);
+    }
     return 0;
 }
@@ -0,0 +1,846 @@
+/* Canonical Huffman coding of byte blocks
+
+  buildHuffmanTree      CLRS 16.3 HUFFMAN with a binary min-heap. The depth
+                        of each leaf is its optimal code length.
+  huffmanLimitedLengths package-merge (Larmore and Hirschberg). These are
+                        optimal lengths under the limit HUFFMAN_MAX_BITS,
+                        used when the tree is deeper than that.
+  huffmanCanonicalCodes codes assigned in (length, symbol) order, so only
+                        the 256 lengths need to be stored (4 bits each).
+
+Bits are written LSB first: a code's first bit is the lowest bit not yet
+used, as in DEFLATE. Canonical codes are therefore stored bit-reversed.
+
+The encoder keeps a 64-bit bit buffer. It adds four codes (at most 48
+bits), then stores all 8 bytes of the buffer and advances by the whole
+bytes filled.
+
+The decoder reads through one table of 2^HUFFMAN_MAX_BITS entries indexed
+by the next HUFFMAN_MAX_BITS bits. Each entry holds every complete code
+among those bits, up to four symbols, packed as
+
+  bits  0..31  the symbols, one byte each
+  bits 32..36  bits consumed by all of them
+  bits 40..42  how many symbols
+  bits 48..52  length of the first code alone (0: no valid code)
+
+One refill of the bit buffer to at least 56 bits covers four lookups. Each
+lookup stores four bytes unconditionally and advances the output by the
+symbol count, so there is no branch per symbol. The last symbols of a
+block go through a careful byte-at-a-time tail.
+
+A block is the 128 bytes of packed code lengths followed by the bit
+stream. The caller records the decoded size. A single-symbol block uses a
+1-bit code.
+
+A block can instead be split into HUFFMAN_STREAMS contiguous segments.
+Each segment is coded into its own stream with the block's code, and the
+sizes of all streams but the last are stored after the lengths. In a
+single stream each lookup needs the bit position left by the one before,
+so decoding is bound by the latency of that chain. huffmanDecodeBits4
+advances all four streams in one branch-free loop, so the core overlaps
+four independent chains. Decoding never reads past the input or writes past the output;
+corrupt input makes it return -1.
+
+A container splits the input into fixed-size blocks. Each block has its
+own frequency table, so blocks are coded independently, in parallel
+under OpenMP. After the header comes an index holding the end offset of
+every block, so decoding can also fan out across threads, and a byte
+range can be decoded from only the blocks that cover it:
+
+  "HUFB"            4 bytes
+  original size     8 bytes, little endian
+  block size        4 bytes
+  streams           4 bytes, 1 or HUFFMAN_STREAMS
+  block ends        8 bytes per block, offsets from the first block
+  blocks            huffman blocks, back to back */
+
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Longest code; the decode table has 2^HUFFMAN_MAX_BITS entries
+#define HUFFMAN_MAX_BITS 12
+#define HUFFMAN_TABLE_SIZE (1 << HUFFMAN_MAX_BITS)
+
+#define HUFFMAN_SYMBOLS 256
+
+// 256 code lengths, 4 bits each
+#define HUFFMAN_LENGTHS_BYTES (HUFFMAN_SYMBOLS / 2)
+
+// Streams per block in interleaved mode
+#define HUFFMAN_STREAMS 4
+
+static inline void* huffmanAlloc(size_t bytes) {
+    void* p = malloc(bytes ? bytes : 1);
+    if (p == NULL) {
+        perror("Huffman allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+// ---------- Huffman tree (CLRS 16.3) ----------
+// A Huffman tree node
+struct MinHeapNode {
+    unsigned char data;                // input byte (leaves only)
+    uint64_t freq;                     // frequency of the byte or subtree
+    struct MinHeapNode *left, *right;  // left and right child
+};
+
+// A Min Heap
+struct MinHeap {
+    unsigned size;
+    unsigned capacity;
+    struct MinHeapNode** array;
+};
+
+// Create a new node
+static inline struct MinHeapNode* newNode(unsigned char data, uint64_t freq) {
+    struct MinHeapNode* temp = (struct MinHeapNode*)huffmanAlloc(sizeof(struct MinHeapNode));
+    temp->left = temp->right = NULL;
+    temp->data = data;
+    temp->freq = freq;
+    return temp;
+}
+
+// Create min heap
+static inline struct MinHeap* createMinHeap(unsigned capacity) {
+    struct MinHeap* minHeap = (struct MinHeap*)huffmanAlloc(sizeof(struct MinHeap));
+    minHeap->size = 0;
+    minHeap->capacity = capacity;
+    minHeap->array = (struct MinHeapNode**)huffmanAlloc(minHeap->capacity * sizeof(struct MinHeapNode*));
+    return minHeap;
+}
+
+static inline void freeMinHeap(struct MinHeap* minHeap) {
+    free(minHeap->array);
+    free(minHeap);
+}
+
+static inline void swapMinHeapNode(struct MinHeapNode** a, struct MinHeapNode** b) {
+    struct MinHeapNode* t = *a;
+    *a = *b;
+    *b = t;
+}
+
+// Heapify
+static inline void minHeapify(struct MinHeap* minHeap, int idx) {
+    for (;;) {
+        int smallest = idx;
+        int left = 2 * idx + 1;
+        int right = 2 * idx + 2;
+
+        if (left < (int)minHeap->size && minHeap->array[left]->freq < minHeap->array[smallest]->freq)
+            smallest = left;
+        if (right < (int)minHeap->size && minHeap->array[right]->freq < minHeap->array[smallest]->freq)
+            smallest = right;
+        if (smallest == idx)
+            return;
+        swapMinHeapNode(&minHeap->array[smallest], &minHeap->array[idx]);
+        idx = smallest;
+    }
+}
+
+// Check size = 1
+static inline int isSizeOne(struct MinHeap* minHeap) {
+    return (minHeap->size == 1);
+}
+
+// Extract minimum value node
+static inline struct MinHeapNode* extractMin(struct MinHeap* minHeap) {
+    struct MinHeapNode* temp = minHeap->array[0];
+    minHeap->array[0] = minHeap->array[minHeap->size - 1];
+    --minHeap->size;
+    minHeapify(minHeap, 0);
+    return temp;
+}
+
+// Insert node
+static inline void insertMinHeap(struct MinHeap* minHeap, struct MinHeapNode* minHeapNode) {
+    ++minHeap->size;
+    int i = minHeap->size - 1;
+
+    while (i && minHeapNode->freq < minHeap->array[(i - 1) / 2]->freq) {
+        minHeap->array[i] = minHeap->array[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+
+    minHeap->array[i] = minHeapNode;
+}
+
+// Build a min heap
+static inline void buildMinHeap(struct MinHeap* minHeap) {
+    int n = minHeap->size - 1;
+    for (int i = (n - 1) / 2; i >= 0; --i)
+        minHeapify(minHeap, i);
+}
+
+// Check leaf
+static inline int isLeaf(struct MinHeapNode* root) {
+    return !(root->left) && !(root->right);
+}
+
+// Create and build min heap
+static inline struct MinHeap* createAndBuildMinHeap(const unsigned char data[], const uint64_t freq[], int size) {
+    struct MinHeap* minHeap = createMinHeap(size);
+
+    for (int i = 0; i < size; ++i)
+        minHeap->array[i] = newNode(data[i], freq[i]);
+
+    minHeap->size = size;
+    buildMinHeap(minHeap);
+
+    return minHeap;
+}
+
+// Build Huffman Tree over size >= 1 symbols
+static inline struct MinHeapNode* buildHuffmanTree(const unsigned char data[], const uint64_t freq[], int size) {
+    struct MinHeapNode *left, *right, *top;
+
+    struct MinHeap* minHeap = createAndBuildMinHeap(data, freq, size);
+
+    while (!isSizeOne(minHeap)) {
+        left = extractMin(minHeap);
+        right = extractMin(minHeap);
+
+        top = newNode('$', left->freq + right->freq);
+        top->left = left;
+        top->right = right;
+
+        insertMinHeap(minHeap, top);
+    }
+
+    struct MinHeapNode* root = extractMin(minHeap);
+    freeMinHeap(minHeap);
+    return root;
+}
+
+static inline void freeHuffmanTree(struct MinHeapNode* root) {
+    if (root == NULL)
+        return;
+    freeHuffmanTree(root->left);
+    freeHuffmanTree(root->right);
+    free(root);
+}
+
+// Leaf depths; the tree has at most 256 leaves, so depth < 256
+static inline void huffmanTreeDepths(const struct MinHeapNode* root, int depth, int lengths[]) {
+    if (!root->left && !root->right) {
+        lengths[root->data] = depth;
+        return;
+    }
+    huffmanTreeDepths(root->left, depth + 1, lengths);
+    huffmanTreeDepths(root->right, depth + 1, lengths);
+}
+
+// ---------- Code lengths ----------
+// Package-merge for the m used symbols sym[] sorted by ascending freq
+static inline void huffmanLimitedLengths(const uint64_t freq[], const int sym[], int m, int maxBits, int lengths[]) {
+    // One list per level, each at most 2m - 1 items long; isLeaf marks
+    // which items are leaves (the rest are packages of the level below)
+    uint64_t* weight[HUFFMAN_MAX_BITS + 1];
+    unsigned char* isLeaf[HUFFMAN_MAX_BITS + 1];
+    int size[HUFFMAN_MAX_BITS + 1];
+    for (int l = 1; l <= maxBits; l++) {
+        weight[l] = (uint64_t*)huffmanAlloc(2 * m * sizeof(uint64_t));
+        isLeaf[l] = (unsigned char*)huffmanAlloc(2 * m);
+    }
+
+    for (int l = maxBits; l >= 1; l--) {
+        int a = 0, b = 0, k = 0, packages = l == maxBits ? 0 : size[l + 1] / 2;
+        while (a < m || b < packages) {
+            uint64_t leaf = a < m ? freq[sym[a]] : UINT64_MAX;
+            uint64_t pack = b < packages ? weight[l + 1][2 * b] + weight[l + 1][2 * b + 1] : UINT64_MAX;
+            if (a < m && leaf <= pack) {
+                weight[l][k] = leaf;
+                isLeaf[l][k++] = 1;
+                a++;
+            } else {
+                weight[l][k] = pack;
+                isLeaf[l][k++] = 0;
+                b++;
+            }
+        }
+        size[l] = k;
+    }
+
+    // The first 2m - 2 items of level 1 form the solution. Every leaf
+    // taken at a level adds one bit to its symbol; every package taken
+    // brings in two items of the next level.
+    for (int i = 0; i < m; i++)
+        lengths[sym[i]] = 0;
+    int take = 2 * m - 2;
+    for (int l = 1; l <= maxBits && take > 0; l++) {
+        int leaves = 0;
+        for (int k = 0; k < take; k++)
+            leaves += isLeaf[l][k];
+        // Leaves appear in list order, which is ascending frequency
+        for (int i = 0; i < leaves; i++)
+            lengths[sym[i]]++;
+        take = 2 * (take - leaves);
+    }
+
+    for (int l = 1; l <= maxBits; l++) {
+        free(weight[l]);
+        free(isLeaf[l]);
+    }
+}
+
+static inline int huffmanCompareFreq(const uint64_t* freq, int a, int b) {
+    return freq[a] != freq[b] ? (freq[a] < freq[b] ? -1 : 1) : a - b;
+}
+
+// Code lengths for the byte frequencies freq[]: Huffman tree depths, or
+// package-merge when the tree is deeper than HUFFMAN_MAX_BITS. Unused
+// bytes get length 0; a lone used byte gets length 1.
+static inline void huffmanCodeLengths(const uint64_t freq[], int lengths[]) {
+    unsigned char data[HUFFMAN_SYMBOLS];
+    uint64_t f[HUFFMAN_SYMBOLS];
+    int sym[HUFFMAN_SYMBOLS], m = 0;
+    for (int i = 0; i < HUFFMAN_SYMBOLS; i++) {
+        lengths[i] = 0;
+        if (freq[i] > 0) {
+            data[m] = (unsigned char)i;
+            f[m] = freq[i];
+            sym[m++] = i;
+        }
+    }
+    if (m == 0)
+        return;
+    if (m == 1) {
+        lengths[sym[0]] = 1;
+        return;
+    }
+
+    struct MinHeapNode* root = buildHuffmanTree(data, f, m);
+    huffmanTreeDepths(root, 0, lengths);
+    freeHuffmanTree(root);
+
+    int deepest = 0;
+    for (int i = 0; i < m; i++)
+        deepest = lengths[sym[i]] > deepest ? lengths[sym[i]] : deepest;
+    if (deepest <= HUFFMAN_MAX_BITS)
+        return;
+
+    // Insertion sort by frequency, at most 256 symbols
+    for (int i = 1; i < m; i++) {
+        int s = sym[i], j = i;
+        for (; j > 0 && huffmanCompareFreq(freq, s, sym[j - 1]) < 0; j--)
+            sym[j] = sym[j - 1];
+        sym[j] = s;
+    }
+    huffmanLimitedLengths(freq, sym, m, HUFFMAN_MAX_BITS, lengths);
+}
+
+// ---------- Canonical codes ----------
+struct HuffmanCode {
+    uint16_t code[HUFFMAN_SYMBOLS];   // bit-reversed canonical code
+    uint8_t length[HUFFMAN_SYMBOLS];  // 0 for unused bytes
+};
+
+static inline unsigned huffmanReverse(unsigned code, int length) {
+    unsigned r = 0;
+    for (int i = 0; i < length; i++)
+        r |= ((code >> i) & 1) << (length - 1 - i);
+    return r;
+}
+
+// Assigns canonical codes. Returns 0 unless the lengths form a complete
+// prefix code (or a single 1-bit code) within HUFFMAN_MAX_BITS.
+static inline int huffmanCanonicalCodes(const int lengths[], struct HuffmanCode* c) {
+    int count[HUFFMAN_MAX_BITS + 1] = {0}, used = 0;
+    for (int s = 0; s < HUFFMAN_SYMBOLS; s++) {
+        if (lengths[s] < 0 || lengths[s] > HUFFMAN_MAX_BITS)
+            return 0;
+        count[lengths[s]]++;
+        used += lengths[s] > 0;
+    }
+    // Kraft sum in units of 2^-HUFFMAN_MAX_BITS
+    long kraft = 0;
+    for (int l = 1; l <= HUFFMAN_MAX_BITS; l++)
+        kraft += (long)count[l] << (HUFFMAN_MAX_BITS - l);
+    if (!(kraft == HUFFMAN_TABLE_SIZE || (used == 1 && count[1] == 1)))
+        return 0;
+
+    unsigned next[HUFFMAN_MAX_BITS + 2];
+    next[1] = 0;
+    for (int l = 1; l <= HUFFMAN_MAX_BITS; l++)
+        next[l + 1] = (next[l] + count[l]) << 1;
+    for (int s = 0; s < HUFFMAN_SYMBOLS; s++) {
+        c->length[s] = (uint8_t)lengths[s];
+        c->code[s] = lengths[s] ? (uint16_t)huffmanReverse(next[lengths[s]]++, lengths[s]) : 0;
+    }
+    return 1;
+}
+
+static inline void huffmanPackLengths(const struct HuffmanCode* c, unsigned char* out) {
+    for (int s = 0; s < HUFFMAN_SYMBOLS; s += 2)
+        out[s / 2] = (unsigned char)(c->length[s] | c->length[s + 1] << 4);
+}
+
+static inline void huffmanUnpackLengths(const unsigned char* in, int lengths[]) {
+    for (int s = 0; s < HUFFMAN_SYMBOLS; s += 2) {
+        lengths[s] = in[s / 2] & 15;
+        lengths[s + 1] = in[s / 2] >> 4;
+    }
+}
+
+// ---------- Little-endian words ----------
+static inline uint64_t huffmanLoad64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline void huffmanStore64(unsigned char* p, uint64_t v) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    memcpy(p, &v, 8);
+}
+
+static inline void huffmanStore32(unsigned char* p, uint32_t v) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    memcpy(p, &v, 4);
+}
+
+static inline void huffmanPutLE(unsigned char* p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++)
+        p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static inline uint64_t huffmanGetLE(const unsigned char* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++)
+        v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+// ---------- Encoder ----------
+// Largest possible encoded block for n input bytes: lengths, stream sizes,
+// a partial last byte per stream, and the 8 bytes of slack the bit
+// writer's full-word stores need
+static inline size_t huffmanMaxBlockSize(size_t n) {
+    return HUFFMAN_LENGTHS_BYTES + 4 * (HUFFMAN_STREAMS - 1) + n * HUFFMAN_MAX_BITS / 8 + HUFFMAN_STREAMS + 8;
+}
+
+static inline void huffmanCountBytes(const unsigned char* src, size_t n, uint64_t freq[]) {
+    // Four tables so that runs of one byte do not serialise on one counter
+    uint64_t f[4][HUFFMAN_SYMBOLS];
+    memset(f, 0, sizeof(f));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        f[0][src[i]]++;
+        f[1][src[i + 1]]++;
+        f[2][src[i + 2]]++;
+        f[3][src[i + 3]]++;
+    }
+    for (; i < n; i++)
+        f[0][src[i]]++;
+    for (int s = 0; s < HUFFMAN_SYMBOLS; s++)
+        freq[s] = f[0][s] + f[1][s] + f[2][s] + f[3][s];
+}
+
+// Codes for the bytes of src
+static inline void huffmanBuildCode(const unsigned char* src, size_t n, struct HuffmanCode* c) {
+    uint64_t freq[HUFFMAN_SYMBOLS];
+    int lengths[HUFFMAN_SYMBOLS];
+    huffmanCountBytes(src, n, freq);
+    huffmanCodeLengths(freq, lengths);
+    huffmanCanonicalCodes(lengths, c);
+}
+
+// Writes the bit stream of src to dst; returns its size in bytes. dst
+// needs (n * HUFFMAN_MAX_BITS + 7) / 8 + 8 bytes.
+static inline size_t huffmanEncodeBits(const struct HuffmanCode* c, const unsigned char* src, size_t n,
+                                       unsigned char* dst) {
+    unsigned char* out = dst;
+    uint64_t bits = 0;
+    unsigned count = 0;
+    size_t i = 0;
+
+#define HUFFMAN_PUT(s) (bits |= (uint64_t)c->code[s] << count, count += c->length[s])
+    // count < 8 on entry, plus at most 4 * 12 bits
+    for (; i + 4 <= n; i += 4) {
+        HUFFMAN_PUT(src[i]);
+        HUFFMAN_PUT(src[i + 1]);
+        HUFFMAN_PUT(src[i + 2]);
+        HUFFMAN_PUT(src[i + 3]);
+        huffmanStore64(out, bits);
+        out += count >> 3;
+        bits >>= count & ~7u;
+        count &= 7;
+    }
+    for (; i < n; i++) {
+        HUFFMAN_PUT(src[i]);
+        huffmanStore64(out, bits);
+        out += count >> 3;
+        bits >>= count & ~7u;
+        count &= 7;
+    }
+#undef HUFFMAN_PUT
+    if (count > 0)
+        *out++ = (unsigned char)bits;
+    return out - dst;
+}
+
+// Bytes [begin, end) of src go to stream j of streams contiguous segments
+static inline void huffmanSegment(size_t n, int streams, int j, size_t* begin, size_t* end) {
+    size_t q = (n + streams - 1) / streams;
+    *begin = j * q < n ? j * q : n;
+    *end = (j + 1) * q < n ? (j + 1) * q : n;
+}
+
+// Encodes src as one block of 1 or HUFFMAN_STREAMS streams; returns its
+// size. Multi-stream blocks store the sizes of all streams but the last
+// (4 bytes each) between the lengths and the streams.
+static inline size_t huffmanEncodeBlock(const unsigned char* src, size_t n, unsigned char* dst, int streams) {
+    struct HuffmanCode c;
+    huffmanBuildCode(src, n, &c);
+    huffmanPackLengths(&c, dst);
+    if (streams == 1)
+        return HUFFMAN_LENGTHS_BYTES + huffmanEncodeBits(&c, src, n, dst + HUFFMAN_LENGTHS_BYTES);
+
+    unsigned char* sizes = dst + HUFFMAN_LENGTHS_BYTES;
+    unsigned char* out = sizes + 4 * (HUFFMAN_STREAMS - 1);
+    for (int j = 0; j < HUFFMAN_STREAMS; j++) {
+        size_t begin, end;
+        huffmanSegment(n, HUFFMAN_STREAMS, j, &begin, &end);
+        // Stream j + 1 overwrites the slack bytes of stream j
+        size_t len = huffmanEncodeBits(&c, src + begin, end - begin, out);
+        if (j < HUFFMAN_STREAMS - 1)
+            huffmanPutLE(sizes + 4 * j, len, 4);
+        out += len;
+    }
+    return out - dst;
+}
+
+// ---------- Decoder ----------
+struct HuffmanDecoder {
+    uint64_t entry[HUFFMAN_TABLE_SIZE];
+};
+
+#define HUFFMAN_ENTRY_BITS(e) ((unsigned)((e) >> 32) & 31)
+#define HUFFMAN_ENTRY_COUNT(e) ((unsigned)((e) >> 40) & 7)
+#define HUFFMAN_ENTRY_FIRST(e) ((unsigned)((e) >> 48) & 31)
+
+// Builds the table for the code c. Returns 0 if c is not a valid code.
+static inline int huffmanBuildDecoder(const int lengths[], struct HuffmanDecoder* d) {
+    struct HuffmanCode c;
+    if (!huffmanCanonicalCodes(lengths, &c))
+        return 0;
+
+    // Single-code table first: symbol and length for every window
+    uint16_t single[HUFFMAN_TABLE_SIZE];
+    memset(single, 0, sizeof(single));
+    for (int s = 0; s < HUFFMAN_SYMBOLS; s++)
+        for (unsigned w = c.code[s]; c.length[s] && w < HUFFMAN_TABLE_SIZE; w += 1u << c.length[s])
+            single[w] = (uint16_t)(s | c.length[s] << 8);
+
+    for (unsigned w = 0; w < HUFFMAN_TABLE_SIZE; w++) {
+        uint64_t symbols = 0;
+        unsigned used = 0, count = 0;
+        while (count < 4) {
+            uint16_t e = single[(w >> used) & (HUFFMAN_TABLE_SIZE - 1)];
+            unsigned len = e >> 8;
+            if (len == 0 || used + len > HUFFMAN_MAX_BITS)
+                break;
+            symbols |= (uint64_t)(e & 255) << (8 * count++);
+            used += len;
+        }
+        unsigned first = single[w] >> 8;
+        // A window without a valid code consumes a full window, so a
+        // corrupt stream still makes progress in the fast loop
+        d->entry[w] = symbols | (uint64_t)(count ? used : HUFFMAN_MAX_BITS) << 32 | (uint64_t)count << 40 |
+                      (uint64_t)first << 48;
+    }
+    return 1;
+}
+
+struct HuffmanBitReader {
+    const unsigned char *in, *end;
+    uint64_t bits;   // next bits of the stream, first bit lowest
+    unsigned count;  // valid bits in bits
+};
+
+static inline void huffmanInitReader(struct HuffmanBitReader* r, const unsigned char* src, size_t len) {
+    r->in = src;
+    r->end = src + len;
+    r->bits = 0;
+    r->count = 0;
+}
+
+// Tops bits up to at least 56 with one unaligned load; needs 8 input bytes
+static inline void huffmanRefill(struct HuffmanBitReader* r) {
+    r->bits |= huffmanLoad64(r->in) << r->count;
+    r->in += (63 - r->count) >> 3;
+    r->count |= 56;
+}
+
+// One lookup: stores four bytes and keeps as many as were decoded
+static inline unsigned char* huffmanDecodeStep(const struct HuffmanDecoder* d, struct HuffmanBitReader* r,
+                                               unsigned char* out) {
+    uint64_t e = d->entry[r->bits & (HUFFMAN_TABLE_SIZE - 1)];
+    huffmanStore32(out, (uint32_t)e);
+    r->bits >>= HUFFMAN_ENTRY_BITS(e);
+    r->count -= HUFFMAN_ENTRY_BITS(e);
+    return out + HUFFMAN_ENTRY_COUNT(e);
+}
+
+// Decodes the last symbols one at a time, checking every bound. Bits
+// above count are the stream's next bits or zero, so refilling byte by
+// byte is consistent with huffmanRefill.
+static inline int huffmanDecodeTail(const struct HuffmanDecoder* d, struct HuffmanBitReader* r, unsigned char* out,
+                                    unsigned char* outEnd) {
+    while (out < outEnd) {
+        while (r->count <= 56 && r->in < r->end) {
+            r->bits |= (uint64_t)*r->in++ << r->count;
+            r->count += 8;
+        }
+        uint64_t e = d->entry[r->bits & (HUFFMAN_TABLE_SIZE - 1)];
+        unsigned first = HUFFMAN_ENTRY_FIRST(e);
+        if (first == 0 || first > r->count)
+            return -1;
+        *out++ = (unsigned char)e;
+        r->bits >>= first;
+        r->count -= first;
+    }
+    return 0;
+}
+
+// Decodes n bytes from the bit stream src[0 .. len) into dst. Returns 0,
+// or -1 if the stream is corrupt or too short.
+static inline int huffmanDecodeBits(const struct HuffmanDecoder* d, const unsigned char* src, size_t len,
+                                    unsigned char* dst, size_t n) {
+    struct HuffmanBitReader r;
+    huffmanInitReader(&r, src, len);
+    unsigned char* out = dst;
+    unsigned char* outEnd = dst + n;
+
+    // Four lookups may write 16 bytes and need 48 bits
+    while (outEnd - out >= 16 && r.end - r.in >= 8) {
+        huffmanRefill(&r);
+        for (int k = 0; k < 4; k++)
+            out = huffmanDecodeStep(d, &r, out);
+    }
+    return huffmanDecodeTail(d, &r, out, outEnd);
+}
+
+// Decodes the HUFFMAN_STREAMS streams src[j][0 .. len[j]) into the
+// segments of dst, interleaving their lookups
+static inline int huffmanDecodeBits4(const struct HuffmanDecoder* d, const unsigned char* const src[],
+                                     const size_t len[], unsigned char* dst, size_t n) {
+    struct HuffmanBitReader r[HUFFMAN_STREAMS];
+    unsigned char *out[HUFFMAN_STREAMS], *outEnd[HUFFMAN_STREAMS];
+    for (int j = 0; j < HUFFMAN_STREAMS; j++) {
+        size_t begin, end;
+        huffmanSegment(n, HUFFMAN_STREAMS, j, &begin, &end);
+        huffmanInitReader(&r[j], src[j], len[j]);
+        out[j] = dst + begin;
+        outEnd[j] = dst + end;
+    }
+
+    for (;;) {
+        int room = 1;
+        for (int j = 0; j < HUFFMAN_STREAMS; j++)
+            room &= (outEnd[j] - out[j] >= 16) & (r[j].end - r[j].in >= 8);
+        if (!room)
+            break;
+        for (int j = 0; j < HUFFMAN_STREAMS; j++)
+            huffmanRefill(&r[j]);
+        for (int k = 0; k < 4; k++)
+            for (int j = 0; j < HUFFMAN_STREAMS; j++)
+                out[j] = huffmanDecodeStep(d, &r[j], out[j]);
+    }
+    for (int j = 0; j < HUFFMAN_STREAMS; j++)
+        if (huffmanDecodeTail(d, &r[j], out[j], outEnd[j]) != 0)
+            return -1;
+    return 0;
+}
+
+// Locates the bit streams of a block of len bytes; returns 0 or -1
+static inline int huffmanBlockStreams(const unsigned char* src, size_t len, int streams, const unsigned char* start[],
+                                      size_t size[]) {
+    size_t header = HUFFMAN_LENGTHS_BYTES + 4 * (streams - 1);
+    if (len < header)
+        return -1;
+    size_t left = len - header;
+    const unsigned char* p = src + header;
+    for (int j = 0; j < streams; j++) {
+        size[j] = j < streams - 1 ? (size_t)huffmanGetLE(src + HUFFMAN_LENGTHS_BYTES + 4 * j, 4) : left;
+        if (size[j] > left)
+            return -1;
+        start[j] = p;
+        p += size[j];
+        left -= size[j];
+    }
+    return 0;
+}
+
+// Decodes a block of len bytes into n bytes of dst; returns 0 or -1
+static inline int huffmanDecodeBlock(const unsigned char* src, size_t len, unsigned char* dst, size_t n, int streams) {
+    if (n == 0)
+        return 0;
+    const unsigned char* start[HUFFMAN_STREAMS];
+    size_t size[HUFFMAN_STREAMS];
+    if (huffmanBlockStreams(src, len, streams, start, size) != 0)
+        return -1;
+    int lengths[HUFFMAN_SYMBOLS];
+    huffmanUnpackLengths(src, lengths);
+    struct HuffmanDecoder* d = (struct HuffmanDecoder*)huffmanAlloc(sizeof(struct HuffmanDecoder));
+    int ok = huffmanBuildDecoder(lengths, d) && (streams == 1 ? huffmanDecodeBits(d, start[0], size[0], dst, n)
+                                                              : huffmanDecodeBits4(d, start, size, dst, n)) == 0;
+    free(d);
+    return ok ? 0 : -1;
+}
+
+// ---------- Block container ----------
+#define HUFFMAN_MAGIC "HUFB"
+#define HUFFMAN_HEADER_BYTES 20
+
+// Default block size: large enough to amortise the 128-byte table, small
+// enough for the frequencies to follow local statistics
+#define HUFFMAN_BLOCK_SIZE (256 * 1024)
+
+static inline size_t huffmanBlockCount(size_t n, size_t blockSize) {
+    return (n + blockSize - 1) / blockSize;
+}
+
+static inline size_t huffmanCompressBound(size_t n, size_t blockSize) {
+    size_t blocks = huffmanBlockCount(n, blockSize);
+    return HUFFMAN_HEADER_BYTES + 8 * blocks + blocks * huffmanMaxBlockSize(blockSize);
+}
+
+// Compresses src into dst (huffmanCompressBound bytes); returns the size
+static inline size_t huffmanCompress(const unsigned char* src, size_t n, size_t blockSize, int streams,
+                                     unsigned char* dst) {
+    size_t blocks = huffmanBlockCount(n, blockSize);
+    memcpy(dst, HUFFMAN_MAGIC, 4);
+    huffmanPutLE(dst + 4, n, 8);
+    huffmanPutLE(dst + 12, blockSize, 4);
+    huffmanPutLE(dst + 16, streams, 4);
+    unsigned char* index = dst + HUFFMAN_HEADER_BYTES;
+    unsigned char* data = index + 8 * blocks;
+
+    // Each block is coded into its own worst-case slot, then slid down
+    size_t slot = huffmanMaxBlockSize(blockSize);
+    unsigned char* scratch = (unsigned char*)huffmanAlloc(blocks * slot);
+    size_t* size = (size_t*)huffmanAlloc(blocks * sizeof(size_t));
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < blocks; b++) {
+        size_t len = b + 1 < blocks ? blockSize : n - b * blockSize;
+        size[b] = huffmanEncodeBlock(src + b * blockSize, len, scratch + b * slot, streams);
+    }
+
+    size_t end = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        end += size[b];
+        huffmanPutLE(index + 8 * b, end, 8);
+    }
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < blocks; b++)
+        memcpy(data + huffmanGetLE(index + 8 * b, 8) - size[b], scratch + b * slot, size[b]);
+
+    free(scratch);
+    free(size);
+    return data + end - dst;
+}
+
+struct HuffmanContainer {
+    size_t n, blockSize, blocks;
+    int streams;
+    const unsigned char* index;  // block ends
+    const unsigned char* data;   // first block
+};
+
+// Parses and validates the header and index; returns 0 or -1
+static inline int huffmanOpenContainer(const unsigned char* src, size_t len, struct HuffmanContainer* c) {
+    if (len < HUFFMAN_HEADER_BYTES || memcmp(src, HUFFMAN_MAGIC, 4) != 0)
+        return -1;
+    uint64_t n = huffmanGetLE(src + 4, 8);
+    c->blockSize = (size_t)huffmanGetLE(src + 12, 4);
+    c->streams = (int)huffmanGetLE(src + 16, 4);
+    if (c->blockSize == 0 || n / 8 > len)  // every byte takes at least one bit
+        return -1;
+    if (c->streams != 1 && c->streams != HUFFMAN_STREAMS)
+        return -1;
+    c->n = (size_t)n;
+    c->blocks = huffmanBlockCount(c->n, c->blockSize);
+    if (c->blocks > (len - HUFFMAN_HEADER_BYTES) / 8)
+        return -1;
+    c->index = src + HUFFMAN_HEADER_BYTES;
+    c->data = c->index + 8 * c->blocks;
+
+    uint64_t previous = 0, room = src + len - c->data;
+    for (size_t b = 0; b < c->blocks; b++) {
+        uint64_t end = huffmanGetLE(c->index + 8 * b, 8);
+        if (end < previous || end > room)
+            return -1;
+        previous = end;
+    }
+    return 0;
+}
+
+// Decodes block b of c into dst
+static inline int huffmanDecodeContainerBlock(const struct HuffmanContainer* c, size_t b, unsigned char* dst) {
+    size_t begin = b ? (size_t)huffmanGetLE(c->index + 8 * (b - 1), 8) : 0;
+    size_t end = (size_t)huffmanGetLE(c->index + 8 * b, 8);
+    size_t len = b + 1 < c->blocks ? c->blockSize : c->n - b * c->blockSize;
+    return huffmanDecodeBlock(c->data + begin, end - begin, dst, len, c->streams);
+}
+
+// Decompressed size, or -1 if src is not a valid container
+static inline long long huffmanDecompressedSize(const unsigned char* src, size_t len) {
+    struct HuffmanContainer c;
+    return huffmanOpenContainer(src, len, &c) == 0 ? (long long)c.n : -1;
+}
+
+// Decompresses all n bytes in parallel; returns 0 or -1
+static inline int huffmanDecompress(const unsigned char* src, size_t len, unsigned char* dst) {
+    struct HuffmanContainer c;
+    if (huffmanOpenContainer(src, len, &c) != 0)
+        return -1;
+    int failed = 0;
+    #pragma omp parallel for schedule(dynamic) reduction(|:failed)
+    for (size_t b = 0; b < c.blocks; b++)
+        failed |= huffmanDecodeContainerBlock(&c, b, dst + b * c.blockSize) != 0;
+    return failed ? -1 : 0;
+}
+
+// Decodes bytes [offset, offset + count) from only the blocks covering
+// them; returns 0, or -1 if the range is outside the data or src is corrupt
+static inline int huffmanDecompressRange(const unsigned char* src, size_t len, size_t offset, size_t count,
+                                         unsigned char* dst) {
+    struct HuffmanContainer c;
+    if (huffmanOpenContainer(src, len, &c) != 0 || offset > c.n || count > c.n - offset)
+        return -1;
+    if (count == 0)
+        return 0;
+    size_t first = offset / c.blockSize, last = (offset + count - 1) / c.blockSize;
+    int failed = 0;
+    #pragma omp parallel for schedule(dynamic) reduction(|:failed)
+    for (size_t b = first; b <= last; b++) {
+        unsigned char* block = (unsigned char*)huffmanAlloc(c.blockSize);
+        failed |= huffmanDecodeContainerBlock(&c, b, block) != 0;
+        size_t from = b * c.blockSize, to = from + c.blockSize;
+        size_t lo = offset > from ? offset : from, hi = offset + count < to ? offset + count : to;
+        memcpy(dst + (lo - offset), block + (lo - from), hi - lo);
+        free(block);
+    }
+    return failed ? -1 : 0;
+}
+
+#endif // HUFFMAN_H
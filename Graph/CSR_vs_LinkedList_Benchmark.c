@@ -0,0 +1,238 @@
+/* Benchmark: linked-list adjacency vs. CSR adjacency
+
+Builds the same random sparse graph twice, once as the old per-file layout
+(array of struct Edge* lists, one malloc per addEdge) and once with the shared
+CSR core in csr_graph.h, then measures edges relaxed per second for
+  1. a Bellman-Ford style sweep over every edge, and
+  2. Dijkstra from vertex 0 with the same lazy binary heap on both layouts.
+
+Edges are inserted in random source order, which is what happens when a graph
+is read from an unsorted edge list, so the list nodes end up scattered.
+
+gcc -O2 CSR_vs_LinkedList_Benchmark.c -o csr_bench
+./csr_bench [V] [avg_degree] [sweeps]        (default 1000000 8 5) */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+
+#include "csr_graph.h"
+#include "graph_generator.h"
+
+#define INF INT_MAX
+
+// ---------- Old layout (as in the original Dijkstra / DAG programs) ----------
+struct Edge {
+    int dest, weight;
+    struct Edge* next;
+};
+
+struct Graph {
+    int V;
+    struct Edge** adj;
+};
+
+struct Graph* createGraph(int V) {
+    struct Graph* graph = (struct Graph*)malloc(sizeof(struct Graph));
+    graph->V = V;
+    graph->adj = (struct Edge**)malloc(V * sizeof(struct Edge*));
+    for (int i = 0; i < V; i++)
+        graph->adj[i] = NULL;
+    return graph;
+}
+
+void addEdge(struct Graph* graph, int src, int dest, int weight) {
+    struct Edge* e = (struct Edge*)malloc(sizeof(struct Edge));
+    e->dest = dest;
+    e->weight = weight;
+    e->next = graph->adj[src];
+    graph->adj[src] = e;
+}
+
+void freeGraph(struct Graph* graph) {
+    for (int i = 0; i < graph->V; i++) {
+        struct Edge* e = graph->adj[i];
+        while (e) {
+            struct Edge* next = e->next;
+            free(e);
+            e = next;
+        }
+    }
+    free(graph->adj);
+    free(graph);
+}
+
+// ---------- Lazy binary heap shared by both Dijkstra runs ----------
+struct HeapItem {
+    int dist, v;
+};
+
+struct Heap {
+    int size, capacity;
+    struct HeapItem* a;
+};
+
+void heapPush(struct Heap* h, int dist, int v) {
+    if (h->size == h->capacity) {
+        h->capacity = h->capacity ? 2 * h->capacity : 1024;
+        h->a = (struct HeapItem*)realloc(h->a, h->capacity * sizeof(struct HeapItem));
+    }
+    int i = h->size++;
+    while (i > 0 && h->a[(i - 1) / 2].dist > dist) {
+        h->a[i] = h->a[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->a[i] = (struct HeapItem){dist, v};
+}
+
+struct HeapItem heapPop(struct Heap* h) {
+    struct HeapItem top = h->a[0];
+    struct HeapItem last = h->a[--h->size];
+    int i = 0;
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= h->size)
+            break;
+        if (c + 1 < h->size && h->a[c + 1].dist < h->a[c].dist)
+            c++;
+        if (h->a[c].dist >= last.dist)
+            break;
+        h->a[i] = h->a[c];
+        i = c;
+    }
+    h->a[i] = last;
+    return top;
+}
+
+// ---------- Kernels ----------
+long long sweepList(const struct Graph* g, int* dist) {
+    long long relaxed = 0;
+    for (int u = 0; u < g->V; u++) {
+        int du = dist[u];
+        for (struct Edge* e = g->adj[u]; e; e = e->next) {
+            if (du != INF && du + e->weight < dist[e->dest])
+                dist[e->dest] = du + e->weight;
+            relaxed++;
+        }
+    }
+    return relaxed;
+}
+
+long long sweepCSR(const struct CSRGraph* g, int* dist) {
+    for (int u = 0; u < g->V; u++) {
+        int du = dist[u];
+        for (long long i = g->offset[u]; i < g->offset[u + 1]; i++)
+            if (du != INF && du + g->weight[i] < dist[g->dest[i]])
+                dist[g->dest[i]] = du + g->weight[i];
+    }
+    return g->E;
+}
+
+long long dijkstraList(const struct Graph* g, int src, int* dist, struct Heap* h) {
+    long long relaxed = 0;
+    for (int i = 0; i < g->V; i++)
+        dist[i] = INF;
+    dist[src] = 0;
+    h->size = 0;
+    heapPush(h, 0, src);
+    while (h->size) {
+        struct HeapItem it = heapPop(h);
+        if (it.dist != dist[it.v])
+            continue;
+        for (struct Edge* e = g->adj[it.v]; e; e = e->next) {
+            relaxed++;
+            if (it.dist + e->weight < dist[e->dest]) {
+                dist[e->dest] = it.dist + e->weight;
+                heapPush(h, dist[e->dest], e->dest);
+            }
+        }
+    }
+    return relaxed;
+}
+
+long long dijkstraCSR(const struct CSRGraph* g, int src, int* dist, struct Heap* h) {
+    long long relaxed = 0;
+    for (int i = 0; i < g->V; i++)
+        dist[i] = INF;
+    dist[src] = 0;
+    h->size = 0;
+    heapPush(h, 0, src);
+    while (h->size) {
+        struct HeapItem it = heapPop(h);
+        if (it.dist != dist[it.v])
+            continue;
+        long long end = g->offset[it.v + 1];
+        relaxed += end - g->offset[it.v];
+        for (long long i = g->offset[it.v]; i < end; i++) {
+            int v = g->dest[i];
+            if (it.dist + g->weight[i] < dist[v]) {
+                dist[v] = it.dist + g->weight[i];
+                heapPush(h, dist[v], v);
+            }
+        }
+    }
+    return relaxed;
+}
+
+// ---------- Utility ----------
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char* argv[]) {
+    int V = argc > 1 ? atoi(argv[1]) : 1000000;
+    int degree = argc > 2 ? atoi(argv[2]) : 8;
+    int sweeps = argc > 3 ? atoi(argv[3]) : 5;
+    long long E = (long long)V * degree;
+
+    printf("Random graph: V = %d, E = %lld\n", V, E);
+    struct CSREdge* edges = generateRandomEdges(V, E, 100);
+
+    double t = now();
+    struct Graph* list = createGraph(V);
+    for (long long i = 0; i < E; i++)
+        addEdge(list, edges[i].src, edges[i].dest, edges[i].weight);
+    double buildList = now() - t;
+
+    t = now();
+    struct CSRGraph* csr = buildCSRGraph(V, edges, E);
+    double buildCSR = now() - t;
+    free(edges);
+
+    printf("Build time: linked list %.3f s, CSR %.3f s\n\n", buildList, buildCSR);
+
+    int* dist = (int*)csrAlloc(V * sizeof(int));
+    struct Heap heap = {0, 0, NULL};
+    long long relaxed;
+
+    // Sweep: start from a finite random labelling so every edge is live
+    printf("%-22s %12s %16s\n", "kernel", "time (s)", "edges/s");
+    for (int layout = 0; layout < 2; layout++) {
+        for (int i = 0; i < V; i++)
+            dist[i] = (int)(xorshift64() % 1000000);
+        relaxed = 0;
+        t = now();
+        for (int s = 0; s < sweeps; s++)
+            relaxed += layout == 0 ? sweepList(list, dist) : sweepCSR(csr, dist);
+        t = now() - t;
+        printf("%-22s %12.3f %16.3e\n", layout == 0 ? "sweep / linked list" : "sweep / CSR",
+               t, relaxed / t);
+    }
+
+    for (int layout = 0; layout < 2; layout++) {
+        t = now();
+        relaxed = layout == 0 ? dijkstraList(list, 0, dist, &heap) : dijkstraCSR(csr, 0, dist, &heap);
+        t = now() - t;
+        printf("%-22s %12.3f %16.3e\n", layout == 0 ? "dijkstra / linked list" : "dijkstra / CSR",
+               t, relaxed / t);
+    }
+
+    free(heap.a);
+    free(dist);
+    freeGraph(list);
+    freeCSRGraph(csr);
+    return 0;
+}
@@ -0,0 +1,178 @@
+/* Connected components with the lock-free union-find
+
+Edge directions are ignored, so on a directed graph these are the weakly
+connected components. Edges are fed to ufUnionBatch (union_find.h) in
+chunks, every vertex is labelled with its root by ufFindBatch, and the
+sequential ufUnion variant is run on the same edges as a cross-check; the
+exit status is 1 if the two disagree.
+
+An optional query file holds one "u v" pair per line; each pair is answered
+with ufConnectedBatch.
+
+gcc -O2 -fopenmp Connected_Components.c -o connected_components
+./connected_components                                   small example
+OMP_NUM_THREADS=64 ./connected_components graph.csr [queries.txt]
+OMP_NUM_THREADS=64 ./connected_components random [V] [E] [queries.txt] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#include "csr_graph_file.h"
+#include "union_find.h"
+#include "graph_generator.h"
+
+// Edges handed to one ufUnionBatch call
+#define UNION_CHUNK (1 << 20)
+
+// Union every CSR edge, a chunk at a time. Returns the number of merges.
+long long unionAllEdges(const struct CSRGraph* g, struct UnionFind* uf) {
+    int* src = (int*)csrAlloc(UNION_CHUNK * sizeof(int));
+    long long merged = 0;
+    int u = 0;
+    for (long long start = 0; start < g->E; start += UNION_CHUNK) {
+        long long len = g->E - start < UNION_CHUNK ? g->E - start : UNION_CHUNK;
+        for (long long i = 0; i < len; i++) {
+            while (g->offset[u + 1] <= start + i)
+                u++;
+            src[i] = u;
+        }
+        merged += ufUnionBatch(uf, src, g->dest + start, len);
+    }
+    free(src);
+    return merged;
+}
+
+// Reads "u v" pairs; returns how many, with the arrays in *xs and *ys
+long long readQueries(const char* filename, int V, int** xs, int** ys) {
+    FILE* f = fopen(filename, "r");
+    if (!f) {
+        perror(filename);
+        exit(1);
+    }
+    long long n = 0, cap = 1024;
+    *xs = (int*)csrAlloc(cap * sizeof(int));
+    *ys = (int*)csrAlloc(cap * sizeof(int));
+    int x, y;
+    while (fscanf(f, "%d %d", &x, &y) == 2) {
+        if (x < 0 || x >= V || y < 0 || y >= V) {
+            fprintf(stderr, "%s: vertex out of range in query %d %d\n", filename, x, y);
+            exit(1);
+        }
+        if (n == cap) {
+            cap *= 2;
+            *xs = (int*)realloc(*xs, cap * sizeof(int));
+            *ys = (int*)realloc(*ys, cap * sizeof(int));
+            if (!*xs || !*ys) {
+                perror("realloc failed");
+                exit(1);
+            }
+        }
+        (*xs)[n] = x;
+        (*ys)[n] = y;
+        n++;
+    }
+    fclose(f);
+    return n;
+}
+
+int main(int argc, char* argv[]) {
+    struct CSRGraph* g;
+    const char* queryFile = NULL;
+
+    if (argc > 1 && strcmp(argv[1], "random") == 0) {
+        int V = argc > 2 ? atoi(argv[2]) : 10000000;
+        long long E = argc > 3 ? atoll(argv[3]) : 8000000LL;
+        queryFile = argc > 4 ? argv[4] : NULL;
+        struct CSREdge* edges = generateRandomEdges(V, E, 1);
+        g = buildCSRGraph(V, edges, E);
+        free(edges);
+    } else if (argc > 1) {
+        g = loadCSRGraphFile(argv[1]);
+        if (!g)
+            return 1;
+        queryFile = argc > 2 ? argv[2] : NULL;
+    } else {
+        // Three components: {0, 1, 2, 3}, {4, 5} and {6}
+        struct CSREdge edges[] = {
+            {0, 1, 1}, {1, 2, 1}, {3, 2, 1}, {5, 4, 1}
+        };
+        g = buildCSRGraph(7, edges, 4);
+    }
+
+    int V = g->V;
+    printf("V = %d, E = %lld, %d threads\n", V, g->E, omp_get_max_threads());
+
+    // Concurrent unions, then one root per vertex
+    struct UnionFind* uf = createUnionFind(V);
+    double t = omp_get_wtime();
+    long long merged = unionAllEdges(g, uf);
+    double unionTime = omp_get_wtime() - t;
+
+    int* ids = (int*)csrAlloc(V * sizeof(int));
+    int* label = (int*)csrAlloc(V * sizeof(int));
+    for (int v = 0; v < V; v++)
+        ids[v] = v;
+    t = omp_get_wtime();
+    ufFindBatch(uf, ids, label, V);
+    double labelTime = omp_get_wtime() - t;
+
+    // Sequential cross-check
+    struct UnionFind* seq = createUnionFind(V);
+    t = omp_get_wtime();
+    long long seqMerged = 0;
+    for (int u = 0; u < V; u++)
+        for (long long i = g->offset[u]; i < g->offset[u + 1]; i++)
+            seqMerged += ufUnion(seq, u, g->dest[i]);
+    double seqTime = omp_get_wtime() - t;
+
+    int components = V - (int)merged;
+    printf("Components: %d (sequential union-find: %lld)%s\n", components, V - seqMerged,
+           merged == seqMerged ? "" : "  MISMATCH");
+    printf("Concurrent unions %.3f s, labelling %.3f s, sequential unions %.3f s\n",
+           unionTime, labelTime, seqTime);
+
+    // Component sizes; every root is the smallest vertex of its component
+    int* size = (int*)calloc(V ? V : 1, sizeof(int));
+    if (!size) {
+        perror("calloc failed");
+        return 1;
+    }
+    for (int v = 0; v < V; v++)
+        size[label[v]]++;
+    int largest = 0, largestRoot = 0, singletons = 0;
+    for (int v = 0; v < V; v++) {
+        if (size[v] > largest) {
+            largest = size[v];
+            largestRoot = v;
+        }
+        singletons += size[v] == 1;
+    }
+    printf("Largest component: %d vertices (contains %d), singletons: %d\n",
+           largest, largestRoot, singletons);
+
+    if (V <= 20)
+        for (int v = 0; v < V; v++)
+            printf("vertex %d -> component %d\n", v, label[v]);
+
+    if (queryFile) {
+        int *xs, *ys;
+        long long n = readQueries(queryFile, V, &xs, &ys);
+        unsigned char* same = (unsigned char*)csrAlloc(n ? n : 1);
+        ufConnectedBatch(uf, xs, ys, same, n);
+        for (long long i = 0; i < n; i++)
+            printf("%d %d %s\n", xs[i], ys[i], same[i] ? "connected" : "not connected");
+        free(same);
+        free(ys);
+        free(xs);
+    }
+
+    free(size);
+    free(label);
+    free(ids);
+    freeUnionFind(seq);
+    freeUnionFind(uf);
+    freeCSRGraph(g);
+    return merged != seqMerged;
+}
@@ -1,84 +1,158 @@
 /* Longest Path in a DAG (using Topological Sort)
 Given a Directed Acyclic Graph (DAG) with weighted edges, find the longest path from a given source vertex.
 Unlike general graphs, the longest paths problem is NP-hard; however, in a DAG, it can be solved in O(V + E) using topological sorting.
-From CLRS Chapter 24.2 */
+From CLRS Chapter 24.2
+
+The engine is in dag_longest_path.h: iterative Kahn ordering by levels, so
+million-vertex dependency chains cannot overflow the stack, with large
+levels processed in parallel. Besides the distances from one source it
+reports the critical path, the longest path starting anywhere.
+
+gcc -O2 -fopenmp DAG_Longest_Path.c -o dag_longest_path
+./dag_longest_path                             CLRS example
+./dag_longest_path graph.csr [src]             critical path, plus distances from src
+./dag_longest_path random [V] [E] [max_weight] random DAG with a V-vertex chain */
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
-
-#define INF INT_MIN  // For longest path (negative infinity)
-
-struct Edge {
-    int dest;
-    int weight;
-    struct Edge* next;
-};
-
-struct Graph {
-    int V;
-    struct Edge** adj;
-};
-
-// Create a new edge:
-struct Edge* newEdge(int dest, int weight) {
-    struct Edge* edge = (struct Edge*)malloc(sizeof(struct Edge));
-    edge->dest = dest;
-    edge->weight = weight;
-    edge->next = NULL;
-    return edge;
-}
+#include <string.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-// Create a new graph
-struct Graph* createGraph(int V) {
-    struct Graph* graph = (struct Graph*)malloc(sizeof(struct Graph));
-    graph->V = V;
-    graph->adj = (struct Edge**)malloc(V * sizeof(struct Edge*));
-    for (int i = 0; i < V; i++)
-        graph->adj[i] = NULL;
-    return graph;
-}
+#include "csr_graph_file.h"
+#include "dag_longest_path.h"
+#include "graph_generator.h"
+
+// Print at most this many distances / path vertices
+#define MAX_PRINTED 20
 
-// Add a directed edge u -> v with weight w
-void addEdge(struct Graph* graph, int u, int v, int w) {
-    struct Edge* edge = newEdge(v, w);
-    edge->next = graph->adj[u];
-    graph->adj[u] = edge;
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
-// Topological Sort (DFS-based)
-void topologicalSortUtil(struct Graph* graph, int v, int visited[], int stack[], int* top) {
-    visited[v] = 1;
+// Function to find the longest path from source
+void longestPath(const struct CSRGraph* graph, int src) {
+    int V = graph->V;
+    long long* dist = (long long*)csrAlloc(V * sizeof(long long));
+    int* parent = (int*)csrAlloc(V * sizeof(int));
 
-    struct Edge* temp = graph->adj[v];
-    while (temp) {
-        if (!visited[temp->dest])
-            topologicalSortUtil(graph, temp->dest, visited, stack, top);
-        temp = temp->next;
+    if (!dagLongestPaths(graph, src, dist, parent)) {
+        printf("Graph has a cycle\n");
+    } else {
+        printf("Longest distances from source %d:\n", src);
+        for (int i = 0; i < V && i < MAX_PRINTED; i++) {
+            if (dist[i] == DAG_NEG_INF)
+                printf("%d\t-INF\n", i);
+            else
+                printf("%d\t%lld\n", i, dist[i]);
+        }
+        if (V > MAX_PRINTED)
+            printf("... (%d more)\n", V - MAX_PRINTED);
     }
 
-    stack[(*top)++] = v;  // push to stack
+    free(parent);
+    free(dist);
 }
 
-// Function to find the longest path from source
-void longestPath(struct Graph* graph, int src) {
-    int V = graph->V;
-    int visited[V];
-    int stack[V];
-    int top = 0;
+// Critical path: the longest path anywhere in the DAG
+void criticalPath(const struct CSRGraph* graph) {
+    int* path = (int*)csrAlloc(graph->V * sizeof(int));
+    int len;
 
-    for (int i = 0; i < V; i++)
-        visited[i] = 0;
+    double t = now();
+    long long length = dagCriticalPath(graph, path, &len);
+    t = now() - t;
 
-    // 1. Perform topological sort
-    for (int i = 0; i < V; i++)
-        if (!visited[i])
-            topologicalSortUtil(graph, i, visited, stack, &top);
+    if (len < 0) {
+        printf("Graph has a cycle\n");
+    } else {
+        printf("Critical path: length %lld, %d vertices (%.3f s)\n", length, len, t);
+        for (int i = 0; i < len; i++) {
+            if (i == MAX_PRINTED / 2 && len > MAX_PRINTED) {
+                printf(" ...");
+                i = len - MAX_PRINTED / 2;
+            }
+            printf(i ? " -> %d" : "%d", path[i]);
+        }
+        printf("\n");
+    }
+    free(path);
+}
 
-    // 2. Initialize distances to -INF
-    int dist[V];
-    for (int i = 0; i < V; i++)
-        dist[i] = INF;
-    dist[src] = 0;
+// Random DAG: the chain 0 -> 1 -> ... -> V-1 plus E - (V - 1) edges from a
+// lower to a higher vertex id
+struct CSRGraph* randomDAG(int V, long long E, int maxWeight) {
+    if (E < V - 1)
+        E = V - 1;
+    struct CSREdge* edges = generateRandomEdges(V, E, maxWeight);
+    for (int i = 0; i + 1 < V; i++) {
+        edges[i].src = i;
+        edges[i].dest = i + 1;
+    }
+    long long k = V > 0 ? V - 1 : 0;
+    for (long long i = k; i < E; i++) {
+        int a = edges[i].src, b = edges[i].dest;
+        if (a == b)
+            continue;
+        edges[k].src = a < b ? a : b;
+        edges[k].dest = a < b ? b : a;
+        edges[k++].weight = edges[i].weight;
+    }
+    struct CSRGraph* g = buildCSRGraph(V, edges, k);
+    free(edges);
+    return g;
+}
 
-    // 3. Process
+// Example from CLRS Figure 24.5
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        struct CSRGraph* graph;
+        int src = 0;
+        if (strcmp(argv[1], "random") == 0) {
+            int V = argc > 2 ? atoi(argv[2]) : 5000000;
+            long long E = argc > 3 ? atoll(argv[3]) : 4LL * V;
+            int maxWeight = argc > 4 ? atoi(argv[4]) : 100;
+            graph = randomDAG(V, E, maxWeight);
+        } else {
+            graph = loadCSRGraphFile(argv[1]);
+            if (!graph)
+                return 1;
+            src = argc > 2 ? atoi(argv[2]) : 0;
+            if (argc > 2 && (src < 0 || src >= graph->V)) {
+                printf("Source vertex %d is out of range [0, %d).\n", src, graph->V);
+                freeCSRGraph(graph);
+                return 1;
+            }
+        }
+        int threads = 1;
+#ifdef _OPENMP
+        threads = omp_get_max_threads();
+#endif
+        printf("V = %d, E = %lld, %d threads\n", graph->V, graph->E, threads);
+        criticalPath(graph);
+        if (graph->V > 0)
+            longestPath(graph, src);
+        freeCSRGraph(graph);
+        return 0;
+    }
+
+    int V = 6;
+    struct CSREdge edges[] = {
+        {0, 1, 5}, {0, 2, 3},
+        {1, 3, 6}, {1, 2, 2},
+        {2, 4, 4}, {2, 5, 2}, {2, 3, 7},
+        {3, 5, 1}, {3, 4, -1},
+        {4, 5, -2}
+    };
+    struct CSRGraph* graph = buildCSRGraph(V, edges, sizeof(edges) / sizeof(edges[0]));
+
+    longestPath(graph, 1);
+    criticalPath(graph);
+
+    freeCSRGraph(graph);
+    return 0;
+}
@@ -0,0 +1,137 @@
+/* Convert a text graph into the binary CSR format of csr_graph_file.h
+
+Input formats:
+  edgelist   one edge per line "u v [w]", 0-based ids, weight defaults to 1;
+             lines starting with '#' or '%' are comments. V = max id + 1.
+  dimacs     9th DIMACS challenge .gr ("p sp n m", "a u v w", 1-based ids),
+             also accepts "p edge n m" / "e u v" with weight 1.
+
+gcc -O2 Graph_Converter.c -o graph_convert
+./graph_convert edgelist roads.txt roads.csr [-u]
+./graph_convert dimacs USA-road-d.NY.gr ny.csr
+
+-u adds the reverse of every edge (undirected input). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "csr_graph_file.h"
+
+struct EdgeBuffer {
+    long long size, capacity;
+    struct CSREdge* e;
+};
+
+void pushEdge(struct EdgeBuffer* b, int u, int v, int w) {
+    if (b->size == b->capacity) {
+        b->capacity = b->capacity ? 2 * b->capacity : 1 << 16;
+        b->e = (struct CSREdge*)realloc(b->e, b->capacity * sizeof(struct CSREdge));
+        if (b->e == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    b->e[b->size++] = (struct CSREdge){u, v, w};
+}
+
+// Parse up to 3 integers after position p; returns how many were read
+int parseInts(const char* p, long long out[3]) {
+    int n = 0;
+    char* end;
+    while (n < 3) {
+        long long x = strtoll(p, &end, 10);
+        if (end == p)
+            break;
+        out[n++] = x;
+        p = end;
+    }
+    return n;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printf("Usage: %s edgelist|dimacs input.txt output.csr [-u]\n", argv[0]);
+        return 1;
+    }
+    int dimacs = strcmp(argv[1], "dimacs") == 0;
+    if (!dimacs && strcmp(argv[1], "edgelist") != 0) {
+        fprintf(stderr, "Unknown input format '%s'\n", argv[1]);
+        return 1;
+    }
+    int undirected = argc > 4 && strcmp(argv[4], "-u") == 0;
+
+    FILE* f = fopen(argv[2], "r");
+    if (!f) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    struct EdgeBuffer edges = {0, 0, NULL};
+    long long V = 0, line = 0, x[3];
+    char buf[512];
+
+    while (fgets(buf, sizeof(buf), f)) {
+        line++;
+        const char* p = buf;
+        while (isspace((unsigned char)*p))
+            p++;
+        if (*p == '\0' || *p == '#' || *p == '%' || (dimacs && *p == 'c'))
+            continue;
+
+        long long u, v, w = 1;
+        if (dimacs) {
+            if (*p == 'p') {
+                // "p sp n m" or "p edge n m": skip the problem name
+                p++;
+                while (isspace((unsigned char)*p)) p++;
+                while (*p && !isspace((unsigned char)*p)) p++;
+                if (parseInts(p, x) >= 1 && x[0] > V)
+                    V = x[0];
+                continue;
+            }
+            if ((*p != 'a' && *p != 'e') || parseInts(p + 1, x) < 2) {
+                fprintf(stderr, "%s:%lld: malformed line\n", argv[2], line);
+                return 1;
+            }
+            u = x[0] - 1;
+            v = x[1] - 1;
+            if (*p == 'a' && parseInts(p + 1, x) == 3)
+                w = x[2];
+        } else {
+            int n = parseInts(p, x);
+            if (n < 2) {
+                fprintf(stderr, "%s:%lld: malformed line\n", argv[2], line);
+                return 1;
+            }
+            u = x[0];
+            v = x[1];
+            if (n == 3)
+                w = x[2];
+        }
+
+        if (u < 0 || v < 0 || u >= INT32_MAX || v >= INT32_MAX || w < INT32_MIN || w > INT32_MAX) {
+            fprintf(stderr, "%s:%lld: vertex id or weight out of range\n", argv[2], line);
+            return 1;
+        }
+        if (u >= V) V = u + 1;
+        if (v >= V) V = v + 1;
+        pushEdge(&edges, (int)u, (int)v, (int)w);
+        if (undirected && u != v)
+            pushEdge(&edges, (int)v, (int)u, (int)w);
+    }
+    fclose(f);
+
+    struct CSRGraph* g = buildCSRGraph((int)V, edges.e, edges.size);
+    free(edges.e);
+
+    if (!writeCSRGraphFile(argv[3], g)) {
+        perror(argv[3]);
+        return 1;
+    }
+    printf("Wrote %s: V = %d, E = %lld\n", argv[3], g->V, g->E);
+
+    freeCSRGraph(g);
+    return 0;
+}
@@ -1,170 +1,288 @@
 // Johnson's Algorithm for All-Pairs Shortest Paths
 // Based on CLRS Book - Chapter 25.2
+//
+// Works on the CSR graph core: the reweighted graph shares offset[] and
+// dest[] with the input and only gets a new weight[] array, so memory stays
+// O(V + E). One heap-based Dijkstra per source runs on an OpenMP thread
+// pool, and finished rows are streamed to disk with pwrite in any order.
+//
+// gcc -O2 -fopenmp "Johnson's_Algorithm.c" -o johnson
+// ./johnson                                 built-in example, printed
+// ./johnson graph.csr                       print every distance
+// ./johnson graph.csr -o dist.bin           full V x V matrix (binary)
+// ./johnson graph.csr -o near.bin -k 16     16 nearest targets per source
+// -b early|spfa|parallel picks the Bellman-Ford mode for reweighting (spfa)
+//
+// Output files start with a 24-byte header:
+//   char magic[8]  "APSPDIST" (matrix) or "APSPTOPK" (top-k)
+//   uint32 version (1), uint32 k (0 for the matrix), uint64 V
+// followed by one fixed-size row per source, in source order:
+//   matrix  V x int32 distance, INT32_MAX when unreachable
+//   top-k   k x (int32 target, int32 distance), ascending by distance,
+//           padded with (-1, INT32_MAX) when fewer than k are reachable
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-#define INF INT_MAX
+#include "csr_graph_file.h"
+#include "sssp.h"
+#include "bellman_ford.h"
 
-struct Edge {
-    int src, dest, weight;
-};
+#define INF INT_MAX
 
-struct Graph {
-    int V, E;
-    struct Edge* edges;
+struct APSPFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t k;
+    uint64_t V;
 };
 
-// ---------- Utility ----------
-struct Graph* createGraph(int V, int E) {
-    struct Graph* graph = (struct Graph*)malloc(sizeof(struct Graph));
-    graph->V = V;
-    graph->E = E;
-    graph->edges = (struct Edge*)malloc(E * sizeof(struct Edge));
-    return graph;
+double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
 }
 
 // ---------- Bellman–Ford ----------
-int bellmanFord(struct Graph* graph, int src, int* dist) {
-    int V = graph->V;
-    int E = graph->E;
-
-    for (int i = 0; i < V; i++)
-        dist[i] = INF;
-    dist[src] = 0;
-
-    for (int i = 1; i <= V - 1; i++) {
-        for (int j = 0; j < E; j++) {
-            int u = graph->edges[j].src;
-            int v = graph->edges[j].dest;
-            int w = graph->edges[j].weight;
-            if (dist[u] != INF && dist[u] + w < dist[v])
-                dist[v] = dist[u] + w;
-        }
-    }
+// Shortest distances from the virtual vertex q, which has a 0-weight edge
+// to every vertex, so h[] starts at 0 everywhere instead of adding q to the
+// graph. Returns 0 if a negative-weight cycle exists.
+int bellmanFord(const struct CSRGraph* graph, int* h, enum BFMode mode) {
+    for (int i = 0; i < graph->V; i++)
+        h[i] = 0;
 
-    // Checking for negative cycles
-    for (int j = 0; j < E; j++) {
-        int u = graph->edges[j].src;
-        int v = graph->edges[j].dest;
-        int w = graph->edges[j].weight;
-        if (dist[u] != INF && dist[u] + w < dist[v]) {
-            printf("Graph contains negative weight cycle!\n");
-            return 0;
-        }
+    struct BFStats stats;
+    double start = now();
+    int ok = bellmanFordSSSP(graph, h, mode, &stats);
+    fprintf(stderr, "Reweighting: %lld passes, %lld edge relaxations, %.3f s\n",
+            stats.passes, stats.relaxations, now() - start);
+    if (!ok) {
+        printf("Graph contains negative weight cycle!\n");
+        return 0;
     }
     return 1;
 }
 
-// ---------- Dijkstra (Min-Heap Implementation) ----------
-int minDistance(int dist[], int visited[], int V) {
-    int min = INF, min_index = -1;
-    for (int v = 0; v < V; v++)
-        if (!visited[v] && dist[v] <= min) {
-            min = dist[v];
-            min_index = v;
-        }
-    return min_index;
+// ---------- Top-k selection ----------
+struct Target {
+    int v, dist;
+};
+
+// Order by distance, then by vertex id, so ties are resolved the same way
+// regardless of thread scheduling
+int targetBefore(struct Target a, struct Target b) {
+    return a.dist < b.dist || (a.dist == b.dist && a.v < b.v);
 }
 
-void dijkstra(int** adj, int V, int src, int* result) {
-    int dist[V];
-    int visited[V];
-    for (int i = 0; i < V; i++) {
-        dist[i] = INF;
-        visited[i] = 0;
+// Max-heap (in targetBefore order) keeps the k nearest targets seen so far
+void keepNearest(struct Target* heap, int* size, int k, struct Target t) {
+    if (*size == k) {
+        if (!targetBefore(t, heap[0]))
+            return;
+        int i = 0;
+        for (;;) {
+            int c = 2 * i + 1;
+            if (c >= k)
+                break;
+            if (c + 1 < k && targetBefore(heap[c], heap[c + 1]))
+                c++;
+            if (!targetBefore(t, heap[c]))
+                break;
+            heap[i] = heap[c];
+            i = c;
+        }
+        heap[i] = t;
+        return;
     }
-    dist[src] = 0;
-
-    for (int count = 0; count < V - 1; count++) {
-        int u = minDistance(dist, visited, V);
-        if (u == -1) break;
-        visited[u] = 1;
-        for (int v = 0; v < V; v++)
-            if (!visited[v] && adj[u][v] != INF && dist[u] != INF
-                && dist[u] + adj[u][v] < dist[v])
-                dist[v] = dist[u] + adj[u][v];
+    int i = (*size)++;
+    while (i > 0 && targetBefore(heap[(i - 1) / 2], t)) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
     }
+    heap[i] = t;
+}
 
-    for (int i = 0; i < V; i++)
-        result[i] = dist[i];
+int compareTargets(const void* a, const void* b) {
+    const struct Target* x = (const struct Target*)a;
+    const struct Target* y = (const struct Target*)b;
+    return targetBefore(*x, *y) ? -1 : targetBefore(*y, *x);
 }
 
 // ---------- Johnson’s Algorithm ----------
-void johnson(struct Graph* graph) {
+// out == NULL prints the distances; otherwise they are written to out as a
+// full matrix (k == 0) or as the k nearest targets of every source.
+int johnson(const struct CSRGraph* graph, const char* out, int k, enum BFMode mode) {
     int V = graph->V;
 
-    // Step 1: Add new vertex q
-    struct Graph* g2 = createGraph(V + 1, graph->E + V);
-    for (int i = 0; i < graph->E; i++)
-        g2->edges[i] = graph->edges[i];
-    for (int i = 0; i < V; i++) {
-        g2->edges[graph->E + i].src = V;
-        g2->edges[graph->E + i].dest = i;
-        g2->edges[graph->E + i].weight = 0;
-    }
-
-    // Step 2: Run Bellman–Ford from q
-    int* h = (int*)malloc((V + 1) * sizeof(int));
-    if (!bellmanFord(g2, V, h)) {
+    // Step 1 + 2: Bellman–Ford from the virtual vertex q
+    int* h = (int*)csrAlloc(V * sizeof(int));
+    if (!bellmanFord(graph, h, mode)) {
         free(h);
-        return;
+        return 0;
     }
 
-    // Step 3: Reweight edges
-    int** adj = (int**)malloc(V * sizeof(int*));
-    for (int i = 0; i < V; i++) {
-        adj[i] = (int*)malloc(V * sizeof(int));
-        for (int j = 0; j < V; j++)
-            adj[i][j] = INF;
-    }
+    // Step 3: Reweight edges; only weight[] is new
+    struct CSRGraph rw = *graph;
+    rw.mapping = NULL;
+    rw.weight = (int*)csrAlloc(graph->E * sizeof(int));
+    // w + h(u) - h(v) is non-negative but may not fit in an int
+    int maxW = 0;
+    for (int u = 0; u < V; u++)
+        for (long long i = graph->offset[u]; i < graph->offset[u + 1]; i++) {
+            long long w = (long long)graph->weight[i] + h[u] - h[graph->dest[i]];
+            if (w > INT_MAX) {
+                printf("Reweighted edge %d -> %d does not fit in an int.\n", u, graph->dest[i]);
+                free(rw.weight);
+                free(h);
+                return 0;
+            }
+            rw.weight[i] = (int)w;
+            if (rw.weight[i] > maxW)
+                maxW = rw.weight[i];
+        }
 
-    for (int i = 0; i < graph->E; i++) {
-        int u = graph->edges[i].src;
-        int v = graph->edges[i].dest;
-        int w = graph->edges[i].weight;
-        adj[u][v] = w + h[u] - h[v];
+    int fd = -1;
+    off_t rowBytes = k > 0 ? (off_t)k * sizeof(struct Target) : (off_t)V * sizeof(int32_t);
+    if (out) {
+        fd = open(out, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        struct APSPFileHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, k > 0 ? "APSPTOPK" : "APSPDIST", 8);
+        hdr.version = 1;
+        hdr.k = (uint32_t)k;
+        hdr.V = (uint64_t)V;
+        if (fd < 0 || pwrite(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)) {
+            perror(out);
+            free(rw.weight);
+            free(h);
+            if (fd >= 0)
+                close(fd);
+            return 0;
+        }
+    } else {
+        printf("All-Pairs Shortest Paths (Johnson's Algorithm):\n");
     }
 
     // Step 4: Run Dijkstra from each vertex:
-    printf("All-Pairs Shortest Paths (Johnson's Algorithm):\n");
-    for (int u = 0; u < V; u++) {
-        int* dist = (int*)malloc(V * sizeof(int));
-        dijkstra(adj, V, u, dist);
-
-        printf("From vertex %d:\n", u);
-        for (int v = 0; v < V; v++) {
-            if (dist[v] == INF)
-                printf("  to %d: INF\n", v);
-            else
-                printf("  to %d: %d\n", v, dist[v] - h[u] + h[v]);
+    int failed = 0;
+    double start = now();
+    #pragma omp parallel if (out != NULL)
+    {
+        int* dist = (int*)csrAlloc(V * sizeof(int));
+        struct Target* row = k > 0 ? (struct Target*)csrAlloc(k * sizeof(struct Target)) : NULL;
+        struct PriorityQueue q;
+        pqInit(&q, PQ_DARY_HEAP, maxW);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int u = 0; u < V; u++) {
+            dijkstraSSSP(&rw, u, dist, NULL, &q);
+            for (int v = 0; v < V; v++)
+                if (dist[v] != INF)
+                    dist[v] = dist[v] - h[u] + h[v];
+
+            if (!out) {
+                #pragma omp critical
+                {
+                    printf("From vertex %d:\n", u);
+                    for (int v = 0; v < V; v++) {
+                        if (dist[v] == INF)
+                            printf("  to %d: INF\n", v);
+                        else
+                            printf("  to %d: %d\n", v, dist[v]);
+                    }
+                    printf("\n");
+                }
+                continue;
+            }
+
+            const void* data = dist;
+            if (k > 0) {
+                int n = 0;
+                for (int v = 0; v < V; v++)
+                    if (v != u && dist[v] != INF)
+                        keepNearest(row, &n, k, (struct Target){v, dist[v]});
+                qsort(row, n, sizeof(struct Target), compareTargets);
+                for (int i = n; i < k; i++)
+                    row[i] = (struct Target){-1, INF};
+                data = row;
+            }
+            off_t at = (off_t)sizeof(struct APSPFileHeader) + (off_t)u * rowBytes;
+            if (pwrite(fd, data, rowBytes, at) != (ssize_t)rowBytes) {
+                #pragma omp atomic write
+                failed = 1;
+            }
         }
-        printf("\n");
+
+        pqFree(&q);
+        free(row);
         free(dist);
     }
+    double elapsed = now() - start;
 
+    if (out) {
+        if (close(fd) != 0)
+            failed = 1;
+        if (failed)
+            perror(out);
+        else {
+            int threads = 1;
+#ifdef _OPENMP
+            threads = omp_get_max_threads();
+#endif
+            printf("Wrote %s: %d sources in %.3f s (%.1f sources/s, %d threads)\n",
+                   out, V, elapsed, V / elapsed, threads);
+        }
+    }
+
+    free(rw.weight);
     free(h);
-    for (int i = 0; i < V; i++)
-        free(adj[i]);
-    free(adj);
+    return !failed;
 }
 
 // ---------- Example ----------
-int main() {
-    int V = 5;
-    int E = 8;
-    struct Graph* graph = createGraph(V, E);
-
-    graph->edges[0] = (struct Edge){0, 1, -1};
-    graph->edges[1] = (struct Edge){0, 2, 4};
-    graph->edges[2] = (struct Edge){1, 2, 3};
-    graph->edges[3] = (struct Edge){1, 3, 2};
-    graph->edges[4] = (struct Edge){1, 4, 2};
-    graph->edges[5] = (struct Edge){3, 2, 5};
-    graph->edges[6] = (struct Edge){3, 1, 1};
-    graph->edges[7] = (struct Edge){4, 3, -3};
-
-    johnson(graph);
-    return 0;
+int main(int argc, char* argv[]) {
+    struct CSRGraph* graph;
+    const char* out = NULL;
+    int k = 0;
+    enum BFMode mode = BF_SPFA;
+
+    if (argc > 1) {
+        for (int i = 2; i < argc; i++) {
+            if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+                out = argv[++i];
+            else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc)
+                k = atoi(argv[++i]);
+            else if (!(strcmp(argv[i], "-b") == 0 && i + 1 < argc && parseBFMode(argv[++i], &mode))) {
+                printf("Usage: %s [graph.csr [-o out.bin] [-k K] [-b early|spfa|parallel]]\n", argv[0]);
+                return 1;
+            }
+        }
+        if (k > 0 && !out) {
+            printf("-k needs an output file (-o)\n");
+            return 1;
+        }
+        graph = loadCSRGraphFile(argv[1]);
+        if (!graph)
+            return 1;
+    } else {
+        int V = 5;
+        struct CSREdge edges[] = {
+            {0, 1, -1}, {0, 2, 4},
+            {1, 2, 3}, {1, 3, 2}, {1, 4, 2},
+            {3, 2, 5}, {3, 1, 1},
+            {4, 3, -3}
+        };
+        graph = buildCSRGraph(V, edges, sizeof(edges) / sizeof(edges[0]));
+    }
+
+    int ok = johnson(graph, out, k, mode);
+    freeCSRGraph(graph);
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,101 @@
+/* Benchmark: MST engines of mst.h against the original qsort Kruskal
+
+Generates a random undirected graph (a random spanning path keeps it
+connected, the remaining edges have uniform random endpoints), then runs
+
+  qsort-kruskal   qsort of every edge + union-find scan,
+                  i.e. the original program with its comparator fixed
+  kruskal         radix-sorted Kruskal
+  filter-kruskal  filter-Kruskal
+  boruvka         parallel Boruvka on the lock-free union-find
+
+on a fresh copy of the edges each, checks that all totals agree and prints
+edges processed per second. The exit status is 1 if any total differs.
+
+gcc -O2 -fopenmp MST_Benchmark.c -o mst_bench
+OMP_NUM_THREADS=64 ./mst_bench [V] [E] [max_weight]   (default 10000000 100000000 1000000)
+
+100M edges take 1.2 GB per copy; the benchmark holds two copies plus the
+radix sort scratch. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#include "mst.h"
+#include "graph_generator.h"
+
+int compareEdgeWeights(const void* a, const void* b) {
+    int x = ((const struct CSREdge*)a)->weight;
+    int y = ((const struct CSREdge*)b)->weight;
+    return (x > y) - (x < y);
+}
+
+long long qsortKruskal(struct CSREdge* edges, long long E, int V, struct CSREdge* out) {
+    qsort(edges, E, sizeof(struct CSREdge), compareEdgeWeights);
+    struct UnionFind* uf = createUnionFind(V);
+    int count = 0;
+    mstScan(edges, E, uf, V, out, &count);
+    freeUnionFind(uf);
+    long long total = 0;
+    for (int i = 0; i < count; i++)
+        total += out[i].weight;
+    return total;
+}
+
+int main(int argc, char* argv[]) {
+    int V = argc > 1 ? atoi(argv[1]) : 10000000;
+    long long E = argc > 2 ? atoll(argv[2]) : 100000000LL;
+    int maxWeight = argc > 3 ? atoi(argv[3]) : 1000000;
+    if (E < V - 1)
+        E = V - 1;
+
+    printf("Random connected graph: V = %d, E = %lld, weights in [1, %d], %d threads\n\n",
+           V, E, maxWeight, omp_get_max_threads());
+
+    struct CSREdge* original = generateRandomEdges(V, E, maxWeight);
+    // Overwrite the first V - 1 edges with a random spanning path
+    int* perm = (int*)csrAlloc(V * sizeof(int));
+    for (int i = 0; i < V; i++)
+        perm[i] = i;
+    for (int i = V - 1; i > 0; i--) {
+        int j = (int)(xorshift64() % (i + 1));
+        int t = perm[i];
+        perm[i] = perm[j];
+        perm[j] = t;
+    }
+    for (int i = 0; i + 1 < V; i++) {
+        original[i].src = perm[i];
+        original[i].dest = perm[i + 1];
+    }
+    free(perm);
+
+    struct CSREdge* edges = (struct CSREdge*)csrAlloc(E * sizeof(struct CSREdge));
+    struct CSREdge* out = (struct CSREdge*)csrAlloc(V * sizeof(struct CSREdge));
+    long long reference = 0;
+    int mismatch = 0;
+
+    printf("%-16s %10s %16s %20s\n", "engine", "time (s)", "edges/s", "total weight");
+    for (int m = -1; m <= MST_BORUVKA; m++) {
+        memcpy(edges, original, E * sizeof(struct CSREdge));
+        long long total;
+        double t = omp_get_wtime();
+        if (m < 0)
+            total = qsortKruskal(edges, E, V, out);
+        else
+            minimumSpanningForest(edges, E, V, (enum MSTMode)m, out, &total);
+        t = omp_get_wtime() - t;
+
+        if (m < 0)
+            reference = total;
+        mismatch |= total != reference;
+        printf("%-16s %10.3f %16.3e %20lld%s\n", m < 0 ? "qsort-kruskal" : mstModeName((enum MSTMode)m),
+               t, E / t, total, total == reference ? "" : "  MISMATCH");
+    }
+
+    free(out);
+    free(edges);
+    free(original);
+    return mismatch;
+}
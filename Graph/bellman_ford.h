@@ -0,0 +1,231 @@
+/* Bellman-Ford engine over the CSR graph core, three modes:
+
+  BF_EARLY_EXIT  classic passes over every edge, stopping at the first pass
+                 that changes nothing; a change in pass V means a negative
+                 cycle.
+  BF_SPFA        queue-based Bellman-Ford: only vertices whose distance just
+                 dropped are scanned again. cnt[v] counts the edges on v's
+                 current tentative path (one more than the relaxation that
+                 set it); reaching V proves a negative cycle.
+  BF_PARALLEL    early-exit passes where each OpenMP thread relaxes an equal
+                 slice of the edge array (not of the vertices, so high-degree
+                 vertices do not unbalance the threads), lowering dist[]
+                 with compare-and-swap.
+
+The caller initialises dist[]: dist[src] = 0 and BF_INF elsewhere for a
+single source, or 0 everywhere for the virtual source of Johnson's
+algorithm. Compile with -fopenmp for BF_PARALLEL to use more than one
+thread. */
+
+#ifndef BELLMAN_FORD_H
+#define BELLMAN_FORD_H
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "csr_graph.h"
+
+#define BF_INF INT_MAX
+
+enum BFMode {
+    BF_EARLY_EXIT,
+    BF_SPFA,
+    BF_PARALLEL
+};
+
+struct BFStats {
+    long long passes;       // full passes (queue rounds for SPFA)
+    long long relaxations;  // edges examined
+};
+
+static inline int parseBFMode(const char* name, enum BFMode* mode) {
+    if (strcmp(name, "early") == 0)
+        *mode = BF_EARLY_EXIT;
+    else if (strcmp(name, "spfa") == 0)
+        *mode = BF_SPFA;
+    else if (strcmp(name, "parallel") == 0)
+        *mode = BF_PARALLEL;
+    else
+        return 0;
+    return 1;
+}
+
+// ---------- Early-exit passes ----------
+static inline int bfEarlyExit(const struct CSRGraph* g, int* dist, struct BFStats* st) {
+    for (int pass = 1; pass <= g->V; pass++) {
+        int changed = 0;
+        st->passes++;
+        for (int u = 0; u < g->V; u++) {
+            int du = dist[u];
+            if (du == BF_INF)
+                continue;
+            st->relaxations += g->offset[u + 1] - g->offset[u];
+            for (long long i = g->offset[u]; i < g->offset[u + 1]; i++) {
+                if (du + g->weight[i] < dist[g->dest[i]]) {
+                    dist[g->dest[i]] = du + g->weight[i];
+                    changed = 1;
+                }
+            }
+        }
+        if (!changed)
+            return 1;
+    }
+    return 0;  // still changing after V passes
+}
+
+// ---------- SPFA ----------
+static inline int bfSPFA(const struct CSRGraph* g, int* dist, struct BFStats* st) {
+    int V = g->V;
+    int* queue = (int*)csrAlloc((V + 1) * sizeof(int));  // ring, never holds a vertex twice
+    int* cnt = (int*)csrAlloc(V * sizeof(int));
+    char* inQueue = (char*)csrAlloc(V);
+    int head = 0, tail = 0, size = 0, ok = 1;
+
+    for (int v = 0; v < V; v++) {
+        cnt[v] = 0;
+        inQueue[v] = dist[v] != BF_INF;
+        if (inQueue[v]) {
+            queue[tail++] = v;
+            size++;
+        }
+    }
+    tail %= V + 1;
+
+    // A "round" ends when every vertex queued before it has been scanned
+    int roundLeft = size;
+    while (size > 0 && ok) {
+        if (roundLeft == 0) {
+            roundLeft = size;
+            st->passes++;
+        }
+        int u = queue[head];
+        head = head == V ? 0 : head + 1;
+        size--;
+        roundLeft--;
+        inQueue[u] = 0;
+
+        int du = dist[u];
+        st->relaxations += g->offset[u + 1] - g->offset[u];
+        for (long long i = g->offset[u]; i < g->offset[u + 1]; i++) {
+            int v = g->dest[i];
+            if (du + g->weight[i] < dist[v]) {
+                dist[v] = du + g->weight[i];
+                cnt[v] = cnt[u] + 1;
+                if (cnt[v] >= V) {
+                    ok = 0;
+                    break;
+                }
+                if (!inQueue[v]) {
+                    inQueue[v] = 1;
+                    queue[tail] = v;
+                    tail = tail == V ? 0 : tail + 1;
+                    size++;
+                }
+            }
+        }
+    }
+    st->passes++;
+
+    free(inQueue);
+    free(cnt);
+    free(queue);
+    return ok;
+}
+
+// ---------- Parallel edge-partitioned passes ----------
+static inline int bfAtomicMin(int* dist, int v, int nd) {
+    int old = __atomic_load_n(&dist[v], __ATOMIC_RELAXED);
+    while (nd < old)
+        if (__atomic_compare_exchange_n(&dist[v], &old, nd, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return 1;
+    return 0;
+}
+
+// Vertex whose edge range contains edge e (offset[] is non-decreasing)
+static inline int bfSourceOfEdge(const struct CSRGraph* g, long long e) {
+    int lo = 0, hi = g->V - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (g->offset[mid] <= e)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return lo;
+}
+
+static inline int bfParallel(const struct CSRGraph* g, int* dist, struct BFStats* st) {
+    int changed = 1;
+    long long passes = 0, relaxations = 0;
+
+    #pragma omp parallel reduction(+:relaxations)
+    {
+        int nThreads = 1, t = 0;
+#ifdef _OPENMP
+        nThreads = omp_get_num_threads();
+        t = omp_get_thread_num();
+#endif
+        long long begin = g->E * t / nThreads;
+        long long end = g->E * (t + 1) / nThreads;
+        int firstU = begin < end ? bfSourceOfEdge(g, begin) : 0;
+
+        for (int pass = 1; pass <= g->V; pass++) {
+            #pragma omp barrier
+            #pragma omp single
+            {
+                changed = 0;
+                passes++;
+            }
+
+            int localChanged = 0;
+            for (int u = firstU; u < g->V && g->offset[u] < end; u++) {
+                long long lo = g->offset[u] > begin ? g->offset[u] : begin;
+                long long hi = g->offset[u + 1] < end ? g->offset[u + 1] : end;
+                int du = __atomic_load_n(&dist[u], __ATOMIC_RELAXED);
+                if (lo >= hi || du == BF_INF)
+                    continue;
+                relaxations += hi - lo;
+                for (long long i = lo; i < hi; i++)
+                    if (bfAtomicMin(dist, g->dest[i], du + g->weight[i]))
+                        localChanged = 1;
+            }
+            if (localChanged)
+                __atomic_store_n(&changed, 1, __ATOMIC_RELAXED);
+
+            #pragma omp barrier
+            if (!changed)
+                break;
+        }
+    }
+
+    st->passes += passes;
+    st->relaxations += relaxations;
+    return !changed;
+}
+
+// Runs to convergence from the caller-initialised dist[]. Returns 1 on
+// success, 0 if a negative-weight cycle is reachable. st may be NULL.
+static inline int bellmanFordSSSP(const struct CSRGraph* g, int* dist, enum BFMode mode, struct BFStats* st) {
+    struct BFStats local = {0, 0};
+    if (st == NULL)
+        st = &local;
+    st->passes = 0;
+    st->relaxations = 0;
+    if (g->V == 0)
+        return 1;
+
+    switch (mode) {
+    case BF_SPFA:
+        return bfSPFA(g, dist, st);
+    case BF_PARALLEL:
+        return bfParallel(g, dist, st);
+    default:
+        return bfEarlyExit(g, dist, st);
+    }
+}
+
+#endif // BELLMAN_FORD_H
@@ -0,0 +1,111 @@
+/* Compressed Sparse Row (CSR) graph core shared by the graph programs.
+
+The out-edges of vertex u live contiguously in dest[offset[u] .. offset[u+1])
+and weight[offset[u] .. offset[u+1]), so a relaxation loop walks two flat
+arrays instead of chasing one malloc'ed struct Edge per neighbour.
+
+Header-only on purpose: every program in this repo is still built as a single
+translation unit, e.g.  gcc -O2 Dijkstra.c -o dijkstra  */
+
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+// One input edge u -> v with weight w (the bulk builder's input format)
+struct CSREdge {
+    int src, dest, weight;
+};
+
+struct CSRGraph {
+    int V;
+    long long E;
+    long long* offset;  // V + 1 entries, offset[V] == E
+    int* dest;          // E entries
+    int* weight;        // E entries
+    void* mapping;      // non-NULL when the arrays point into an mmap'ed file
+    size_t mappingBytes;
+};
+
+static inline void* csrAlloc(size_t bytes) {
+    void* p = malloc(bytes ? bytes : 1);
+    if (p == NULL) {
+        perror("CSR allocation failed");
+        exit(1);
+    }
+    return p;
+}
+
+// ---------- Bulk builder ----------
+// Counting sort of the edge list by source vertex: one histogram pass, one
+// prefix sum and one scatter pass, O(V + E). The sort is stable, so edges of
+// the same source keep their input order.
+static inline struct CSRGraph* buildCSRGraph(int V, const struct CSREdge* edges, long long E) {
+    struct CSRGraph* g = (struct CSRGraph*)csrAlloc(sizeof(struct CSRGraph));
+    g->V = V;
+    g->E = E;
+    g->mapping = NULL;
+    g->mappingBytes = 0;
+    g->offset = (long long*)csrAlloc((V + 1) * sizeof(long long));
+    g->dest = (int*)csrAlloc(E * sizeof(int));
+    g->weight = (int*)csrAlloc(E * sizeof(int));
+
+    memset(g->offset, 0, (V + 1) * sizeof(long long));
+    for (long long i = 0; i < E; i++)
+        g->offset[edges[i].src + 1]++;
+    for (int u = 0; u < V; u++)
+        g->offset[u + 1] += g->offset[u];
+
+    long long* next = (long long*)csrAlloc(V * sizeof(long long));
+    memcpy(next, g->offset, V * sizeof(long long));
+    for (long long i = 0; i < E; i++) {
+        long long k = next[edges[i].src]++;
+        g->dest[k] = edges[i].dest;
+        g->weight[k] = edges[i].weight;
+    }
+    free(next);
+    return g;
+}
+
+static inline void freeCSRGraph(struct CSRGraph* g) {
+    if (g == NULL)
+        return;
+    if (g->mapping) {
+        munmap(g->mapping, g->mappingBytes);
+        free(g);
+        return;
+    }
+    free(g->offset);
+    free(g->dest);
+    free(g->weight);
+    free(g);
+}
+
+// Out-degree of u
+static inline long long csrDegree(const struct CSRGraph* g, int u) {
+    return g->offset[u + 1] - g->offset[u];
+}
+
+// Smallest and largest edge weight (0 for an edgeless graph)
+static inline void csrWeightRange(const struct CSRGraph* g, int* minW, int* maxW) {
+    int lo = g->E ? g->weight[0] : 0, hi = lo;
+    for (long long i = 1; i < g->E; i++) {
+        if (g->weight[i] < lo) lo = g->weight[i];
+        if (g->weight[i] > hi) hi = g->weight[i];
+    }
+    *minW = lo;
+    *maxW = hi;
+}
+
+// Index of the first edge u -> v, or -1 if there is none
+static inline long long csrFindEdge(const struct CSRGraph* g, int u, int v) {
+    for (long long i = g->offset[u]; i < g->offset[u + 1]; i++)
+        if (g->dest[i] == v)
+            return i;
+    return -1;
+}
+
+#endif // CSR_GRAPH_H
@@ -0,0 +1,171 @@
+/* Binary on-disk format for CSR graphs, loaded with a read-only mmap.
+
+Layout (little-endian, every section 8-byte aligned):
+
+    offset  size        field
+    0       8           magic "CSRGRAPH"
+    8       4           format version (CSR_FILE_VERSION)
+    12      4           flags (reserved, 0)
+    16      8           V
+    24      8           E
+    32      8           byte offset of offset[]  (int64, V + 1 entries)
+    40      8           byte offset of dest[]    (int32, E entries)
+    48      8           byte offset of weight[]  (int32, E entries)
+    56      8           total file size in bytes
+
+The arrays have exactly the in-memory types of struct CSRGraph, so loading
+is an mmap plus three pointer assignments: no parsing and no copies. Pages
+are faulted in lazily by whichever algorithm touches them first.
+
+Files are produced by Graph_Converter.c from edge-list or DIMACS text.
+Loading checks the header against the file size and makes one O(V + E)
+pass over offset[] and dest[], so a corrupt file is rejected instead of
+sending the algorithms out of bounds. The arrays are read in host byte
+order, so only little-endian hosts are supported. */
+
+#ifndef CSR_GRAPH_FILE_H
+#define CSR_GRAPH_FILE_H
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "csr_graph.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "csr_graph_file.h maps little-endian arrays in place and needs a little-endian host"
+#endif
+
+#define CSR_FILE_MAGIC "CSRGRAPH"
+#define CSR_FILE_VERSION 1
+
+struct CSRFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t V;
+    uint64_t E;
+    uint64_t offsetPos;
+    uint64_t destPos;
+    uint64_t weightPos;
+    uint64_t fileBytes;
+};
+
+static inline uint64_t csrAlign8(uint64_t x) {
+    return (x + 7) & ~(uint64_t)7;
+}
+
+// Does [pos, pos + count * size) fit in end bytes at an 8-byte aligned pos?
+// Compared by division so that no product can wrap.
+static inline int csrSectionFits(uint64_t pos, uint64_t count, uint64_t size, uint64_t end) {
+    return pos % 8 == 0 && pos <= end && count <= (end - pos) / size;
+}
+
+// Returns NULL if offset[] and dest[] describe a valid graph, else the problem
+static inline const char* validateCSRArrays(const int64_t* offset, const int32_t* dest, int64_t V, int64_t E) {
+    if (offset[0] != 0)
+        return "offset[0] is not 0";
+    if (offset[V] != E)
+        return "offset[V] does not match E";
+    for (int64_t u = 0; u < V; u++)
+        if (offset[u + 1] < offset[u])
+            return "offsets decrease";
+    for (int64_t i = 0; i < E; i++)
+        if (dest[i] < 0 || dest[i] >= V)
+            return "edge destination out of range";
+    return NULL;
+}
+
+// Write g to filename; returns 1 on success, 0 on failure (errno is set)
+static inline int writeCSRGraphFile(const char* filename, const struct CSRGraph* g) {
+    struct CSRFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CSR_FILE_MAGIC, 8);
+    h.version = CSR_FILE_VERSION;
+    h.V = (uint64_t)g->V;
+    h.E = (uint64_t)g->E;
+    h.offsetPos = csrAlign8(sizeof(h));
+    h.destPos = csrAlign8(h.offsetPos + (h.V + 1) * sizeof(int64_t));
+    h.weightPos = csrAlign8(h.destPos + h.E * sizeof(int32_t));
+    h.fileBytes = csrAlign8(h.weightPos + h.E * sizeof(int32_t));
+
+    FILE* f = fopen(filename, "wb");
+    if (!f)
+        return 0;
+
+    static const char zero[8] = {0};
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1;
+    ok = ok && fwrite(zero, 1, h.offsetPos - sizeof(h), f) == h.offsetPos - sizeof(h);
+    ok = ok && fwrite(g->offset, sizeof(int64_t), h.V + 1, f) == h.V + 1;
+    uint64_t pos = h.offsetPos + (h.V + 1) * sizeof(int64_t);
+    ok = ok && fwrite(zero, 1, h.destPos - pos, f) == h.destPos - pos;
+    ok = ok && fwrite(g->dest, sizeof(int32_t), h.E, f) == h.E;
+    pos = h.destPos + h.E * sizeof(int32_t);
+    ok = ok && fwrite(zero, 1, h.weightPos - pos, f) == h.weightPos - pos;
+    ok = ok && fwrite(g->weight, sizeof(int32_t), h.E, f) == h.E;
+    pos = h.weightPos + h.E * sizeof(int32_t);
+    ok = ok && fwrite(zero, 1, h.fileBytes - pos, f) == h.fileBytes - pos;
+
+    if (fclose(f) != 0)
+        ok = 0;
+    return ok;
+}
+
+// Map filename read-only. On error prints a message and returns NULL.
+// The result is released with freeCSRGraph like any other CSRGraph; its
+// arrays are read-only.
+static inline struct CSRGraph* loadCSRGraphFile(const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror(filename);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct CSRFileHeader)) {
+        fprintf(stderr, "%s: not a CSR graph file\n", filename);
+        close(fd);
+        return NULL;
+    }
+
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        perror("mmap");
+        return NULL;
+    }
+
+    const struct CSRFileHeader* h = (const struct CSRFileHeader*)base;
+    const char* err = NULL;
+    if (memcmp(h->magic, CSR_FILE_MAGIC, 8) != 0)
+        err = "bad magic";
+    else if (h->version != CSR_FILE_VERSION)
+        err = "unsupported format version";
+    else if (h->fileBytes != (uint64_t)st.st_size || h->V > INT32_MAX || h->E > INT64_MAX
+             || !csrSectionFits(h->offsetPos, h->V + 1, sizeof(int64_t), h->destPos)
+             || !csrSectionFits(h->destPos, h->E, sizeof(int32_t), h->weightPos)
+             || !csrSectionFits(h->weightPos, h->E, sizeof(int32_t), h->fileBytes)
+             || h->offsetPos < sizeof(struct CSRFileHeader))
+        err = "truncated or inconsistent header";
+    else
+        err = validateCSRArrays((const int64_t*)((const char*)base + h->offsetPos),
+                                (const int32_t*)((const char*)base + h->destPos), (int64_t)h->V, (int64_t)h->E);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", filename, err);
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+
+    struct CSRGraph* g = (struct CSRGraph*)csrAlloc(sizeof(struct CSRGraph));
+    g->V = (int)h->V;
+    g->E = (long long)h->E;
+    g->offset = (long long*)((char*)base + h->offsetPos);
+    g->dest = (int*)((char*)base + h->destPos);
+    g->weight = (int*)((char*)base + h->weightPos);
+    g->mapping = base;
+    g->mappingBytes = (size_t)st.st_size;
+    return g;
+}
+
+#endif // CSR_GRAPH_FILE_H
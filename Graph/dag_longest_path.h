@@ -0,0 +1,230 @@
+/* Longest paths in a DAG over the CSR graph core, without recursion.
+
+  dagTopologicalLevels  Kahn's algorithm, level by level: level 0 holds the
+                        vertices without incoming edges, level k + 1 those
+                        whose last predecessor sits in level k. No edge runs
+                        inside a level, so a whole level can be processed
+                        in parallel.
+  dagLongestPaths       walks the levels in order and pulls every vertex's
+                        distance from its predecessors over the transposed
+                        graph, so each dist[v] is written by one thread only
+                        and no atomics are needed. Ties pick the smallest
+                        predecessor, which keeps parent[] deterministic.
+  dagCriticalPath       longest path that may start anywhere, returned as a
+                        vertex sequence.
+
+Levels with fewer than DAG_PARALLEL_LEVEL vertices are processed serially,
+so long chains do not pay one OpenMP fork per vertex. Distances are 64-bit;
+unreachable vertices get DAG_NEG_INF. Compile with -fopenmp for threads. */
+
+#ifndef DAG_LONGEST_PATH_H
+#define DAG_LONGEST_PATH_H
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "csr_graph.h"
+
+#define DAG_NEG_INF LLONG_MIN
+
+// Smallest level worth an OpenMP parallel loop
+#define DAG_PARALLEL_LEVEL 2048
+
+// Vertices a thread collects before reserving room in the next level
+#define DAG_LOCAL_BUFFER 256
+
+// ---------- Kahn levels ----------
+// order[] (V entries) receives the vertices level by level; level l is
+// order[levelStart[l] .. levelStart[l + 1]). levelStart needs V + 1 entries.
+// Returns the number of levels, or -1 if the graph has a cycle.
+static inline int dagTopologicalLevels(const struct CSRGraph* g, int* order, int* levelStart) {
+    int V = g->V;
+    int* indeg = (int*)csrAlloc(V * sizeof(int));
+    memset(indeg, 0, V * sizeof(int));
+
+    #pragma omp parallel for schedule(static) if (g->E >= DAG_PARALLEL_LEVEL)
+    for (long long i = 0; i < g->E; i++)
+        __atomic_fetch_add(&indeg[g->dest[i]], 1, __ATOMIC_RELAXED);
+
+    int tail = 0;
+    for (int v = 0; v < V; v++)
+        if (indeg[v] == 0)
+            order[tail++] = v;
+
+    int levels = 0, head = 0;
+    while (head < tail) {
+        levelStart[levels++] = head;
+        int end = tail;
+
+        if (end - head < DAG_PARALLEL_LEVEL) {
+            for (int k = head; k < end; k++) {
+                int u = order[k];
+                for (long long i = g->offset[u]; i < g->offset[u + 1]; i++)
+                    if (--indeg[g->dest[i]] == 0)
+                        order[tail++] = g->dest[i];
+            }
+        } else {
+            #pragma omp parallel
+            {
+                int local[DAG_LOCAL_BUFFER], n = 0;
+                #pragma omp for schedule(dynamic, 64)
+                for (int k = head; k < end; k++) {
+                    int u = order[k];
+                    for (long long i = g->offset[u]; i < g->offset[u + 1]; i++) {
+                        int v = g->dest[i];
+                        if (__atomic_sub_fetch(&indeg[v], 1, __ATOMIC_RELAXED) == 0) {
+                            if (n == DAG_LOCAL_BUFFER) {
+                                int at = __atomic_fetch_add(&tail, n, __ATOMIC_RELAXED);
+                                memcpy(order + at, local, n * sizeof(int));
+                                n = 0;
+                            }
+                            local[n++] = v;
+                        }
+                    }
+                }
+                int at = __atomic_fetch_add(&tail, n, __ATOMIC_RELAXED);
+                memcpy(order + at, local, n * sizeof(int));
+            }
+        }
+        head = end;
+    }
+    levelStart[levels] = tail;
+
+    free(indeg);
+    return tail == V ? levels : -1;
+}
+
+// ---------- Longest paths ----------
+// Transposed graph, so the in-edges of v are contiguous. Counting sort on
+// the destination: in-degrees, prefix sum, scatter. In-edges keep the order
+// of their sources.
+static inline struct CSRGraph* dagTranspose(const struct CSRGraph* g) {
+    int V = g->V;
+    struct CSRGraph* rev = (struct CSRGraph*)csrAlloc(sizeof(struct CSRGraph));
+    rev->V = V;
+    rev->E = g->E;
+    rev->mapping = NULL;
+    rev->mappingBytes = 0;
+    rev->offset = (long long*)csrAlloc((V + 1) * sizeof(long long));
+    rev->dest = (int*)csrAlloc(g->E * sizeof(int));
+    rev->weight = (int*)csrAlloc(g->E * sizeof(int));
+
+    memset(rev->offset, 0, (V + 1) * sizeof(long long));
+    for (long long i = 0; i < g->E; i++)
+        rev->offset[g->dest[i] + 1]++;
+    for (int v = 0; v < V; v++)
+        rev->offset[v + 1] += rev->offset[v];
+
+    long long* next = (long long*)csrAlloc(V * sizeof(long long));
+    memcpy(next, rev->offset, V * sizeof(long long));
+    for (int u = 0; u < V; u++)
+        for (long long i = g->offset[u]; i < g->offset[u + 1]; i++) {
+            long long k = next[g->dest[i]]++;
+            rev->dest[k] = u;
+            rev->weight[k] = g->weight[i];
+        }
+    free(next);
+    return rev;
+}
+
+// Pull step for one vertex over the transposed graph rev
+static inline void dagPull(const struct CSRGraph* rev, int v, long long* dist, int* parent) {
+    long long best = dist[v];
+    int from = -1;
+    for (long long i = rev->offset[v]; i < rev->offset[v + 1]; i++) {
+        int u = rev->dest[i];
+        if (dist[u] == DAG_NEG_INF)
+            continue;
+        long long d = dist[u] + rev->weight[i];
+        if (d > best || (d == best && from >= 0 && u < from)) {
+            best = d;
+            from = u;
+        }
+    }
+    dist[v] = best;
+    if (from >= 0)
+        parent[v] = from;
+}
+
+// src >= 0: longest distances from src. src < 0: every vertex may start a
+// path (critical-path mode). parent[v] is the predecessor on the chosen
+// path, -1 at its start. Returns 0 if the graph has a cycle.
+static inline int dagLongestPaths(const struct CSRGraph* g, int src, long long* dist, int* parent) {
+    int V = g->V;
+    int* order = (int*)csrAlloc(V * sizeof(int));
+    int* levelStart = (int*)csrAlloc((V + 1) * sizeof(int));
+    int levels = dagTopologicalLevels(g, order, levelStart);
+    if (levels < 0) {
+        free(levelStart);
+        free(order);
+        return 0;
+    }
+
+    struct CSRGraph* rev = dagTranspose(g);
+
+    for (int v = 0; v < V; v++) {
+        dist[v] = src < 0 || v == src ? 0 : DAG_NEG_INF;
+        parent[v] = -1;
+    }
+
+    for (int l = 0; l < levels; l++) {
+        int begin = levelStart[l], end = levelStart[l + 1];
+        if (end - begin < DAG_PARALLEL_LEVEL) {
+            for (int k = begin; k < end; k++)
+                dagPull(rev, order[k], dist, parent);
+        } else {
+            #pragma omp parallel for schedule(dynamic, 64)
+            for (int k = begin; k < end; k++)
+                dagPull(rev, order[k], dist, parent);
+        }
+    }
+
+    freeCSRGraph(rev);
+    free(levelStart);
+    free(order);
+    return 1;
+}
+
+// Follows parent[] back from end; writes the path start..end into path[]
+// (room for V) and returns its vertex count.
+static inline int dagExtractPath(const int* parent, int end, int* path) {
+    int len = 0;
+    for (int v = end; v >= 0; v = parent[v])
+        path[len++] = v;
+    for (int i = 0; i < len / 2; i++) {
+        int t = path[i];
+        path[i] = path[len - 1 - i];
+        path[len - 1 - i] = t;
+    }
+    return len;
+}
+
+// Longest path anywhere in the DAG. Writes it to path[] (room for V),
+// its vertex count to *len and returns its length; *len = -1 on a cycle.
+static inline long long dagCriticalPath(const struct CSRGraph* g, int* path, int* len) {
+    long long* dist = (long long*)csrAlloc(g->V * sizeof(long long));
+    int* parent = (int*)csrAlloc(g->V * sizeof(int));
+    long long best = 0;
+    *len = 0;
+
+    if (!dagLongestPaths(g, -1, dist, parent)) {
+        *len = -1;
+    } else if (g->V > 0) {
+        int end = 0;
+        for (int v = 1; v < g->V; v++)
+            if (dist[v] > dist[end])
+                end = v;
+        best = dist[end];
+        *len = dagExtractPath(parent, end, path);
+    }
+
+    free(parent);
+    free(dist);
+    return best;
+}
+
+#endif // DAG_LONGEST_PATH_H
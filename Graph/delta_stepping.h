@@ -0,0 +1,158 @@
+/* Parallel delta-stepping SSSP (Meyer & Sanders 2003) over the CSR core.
+
+Vertices are grouped into buckets of width delta by tentative distance.
+The current bucket is held in one shared frontier array; a parallel loop
+relaxes the out-edges of every frontier vertex, lowering dist[] with an
+atomic compare-and-swap. Each improved vertex is appended to the relaxing
+thread's own bucket array (its request buffer), so no locks are taken on
+the hot path. Between rounds the threads agree on the lowest non-empty
+bucket and copy their local share of it into the next frontier. A bucket
+is re-processed until nothing falls back into it, then the search moves on.
+Every pending distance lies within maxWeight of the current bucket, so the
+local buckets are a ring of maxWeight / delta + 2 slots rather than one slot
+per possible bucket.
+
+delta = 1 behaves like a parallel Dial's algorithm; a very large delta
+degenerates into parallel Bellman-Ford. Edge weights must be non-negative.
+
+Compile with -fopenmp; without it the same code runs on one thread. */
+
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "csr_graph.h"
+
+#define DELTA_INF INT_MAX
+
+struct DeltaBucket {
+    long long size, capacity;
+    int* v;
+};
+
+static inline void deltaBucketPush(struct DeltaBucket* b, int v) {
+    if (b->size == b->capacity) {
+        b->capacity = b->capacity ? 2 * b->capacity : 64;
+        b->v = (int*)realloc(b->v, b->capacity * sizeof(int));
+        if (b->v == NULL) {
+            perror("delta-stepping allocation failed");
+            exit(1);
+        }
+    }
+    b->v[b->size++] = v;
+}
+
+// Lower dist[v] to nd if it is smaller; returns 1 if this call lowered it
+static inline int deltaAtomicMin(int* dist, int v, int nd) {
+    int old = __atomic_load_n(&dist[v], __ATOMIC_RELAXED);
+    while (nd < old)
+        if (__atomic_compare_exchange_n(&dist[v], &old, nd, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return 1;
+    return 0;
+}
+
+// Fills dist[] (DELTA_INF when unreachable). Returns the number of edge
+// relaxations performed, which exceeds E when vertices are re-settled.
+static inline long long deltaSteppingSSSP(const struct CSRGraph* g, int src, int* dist, int delta) {
+    for (int i = 0; i < g->V; i++)
+        dist[i] = DELTA_INF;
+    dist[src] = 0;
+
+    long long frontierSize = 1, frontierCapacity = 1024, frontierTail = 0;
+    int* frontier = (int*)csrAlloc(frontierCapacity * sizeof(int));
+    frontier[0] = src;
+    long long curBucket = 0, nextBucket = LLONG_MAX;
+    long long relaxations = 0;
+
+    int minW, maxW;
+    csrWeightRange(g, &minW, &maxW);
+    long long nSlots = maxW / delta + 2;
+
+    #pragma omp parallel reduction(+:relaxations)
+    {
+        // Thread-local request buffers; bucket b lives in slot b % nSlots
+        struct DeltaBucket* local = (struct DeltaBucket*)calloc(nSlots, sizeof(struct DeltaBucket));
+        if (local == NULL) {
+            perror("delta-stepping allocation failed");
+            exit(1);
+        }
+
+        while (frontierSize > 0) {
+            long long lower = curBucket * delta;
+
+            #pragma omp for schedule(dynamic, 64) nowait
+            for (long long i = 0; i < frontierSize; i++) {
+                int u = frontier[i];
+                int du = __atomic_load_n(&dist[u], __ATOMIC_RELAXED);
+                if (du < lower)
+                    continue;  // settled in an earlier bucket, stale entry
+                for (long long e = g->offset[u]; e < g->offset[u + 1]; e++) {
+                    int v = g->dest[e];
+                    int nd = du + g->weight[e];
+                    relaxations++;
+                    if (deltaAtomicMin(dist, v, nd))
+                        deltaBucketPush(&local[(nd / delta) % nSlots], v);
+                }
+            }
+
+            // Agree on the lowest non-empty bucket across all threads
+            for (long long b = curBucket; b < curBucket + nSlots; b++) {
+                if (local[b % nSlots].size > 0) {
+                    long long cur = __atomic_load_n(&nextBucket, __ATOMIC_RELAXED);
+                    while (b < cur && !__atomic_compare_exchange_n(&nextBucket, &cur, b, 1,
+                                                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                        ;
+                    break;
+                }
+            }
+            #pragma omp barrier
+
+            // Reserve this thread's slice of the next frontier
+            long long mine = 0, at = 0;
+            if (nextBucket != LLONG_MAX && local[nextBucket % nSlots].size > 0) {
+                mine = local[nextBucket % nSlots].size;
+                at = __atomic_fetch_add(&frontierTail, mine, __ATOMIC_RELAXED);
+            }
+            #pragma omp barrier
+
+            #pragma omp single
+            {
+                if (frontierTail > frontierCapacity) {
+                    while (frontierCapacity < frontierTail)
+                        frontierCapacity *= 2;
+                    free(frontier);
+                    frontier = (int*)csrAlloc(frontierCapacity * sizeof(int));
+                }
+                frontierSize = frontierTail;
+                curBucket = nextBucket;
+            }
+
+            if (mine > 0) {
+                memcpy(frontier + at, local[curBucket % nSlots].v, mine * sizeof(int));
+                local[curBucket % nSlots].size = 0;
+            }
+            #pragma omp barrier
+
+            #pragma omp single
+            {
+                frontierTail = 0;
+                nextBucket = LLONG_MAX;
+            }
+        }
+
+        for (long long b = 0; b < nSlots; b++)
+            free(local[b].v);
+        free(local);
+    }
+
+    free(frontier);
+    return relaxations;
+}
+
+#endif // DELTA_STEPPING_H
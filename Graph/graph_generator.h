@@ -0,0 +1,49 @@
+/* Synthetic graph generators for the benchmarks.
+
+Both return a malloc'ed edge list for buildCSRGraph; the caller frees it.
+Randomness comes from the deterministic xorshift64 of
+../Algorithms/xorshift.h, so runs are reproducible. */
+
+#ifndef GRAPH_GENERATOR_H
+#define GRAPH_GENERATOR_H
+
+#include "csr_graph.h"
+#include "../Algorithms/xorshift.h"
+
+// Road-like side x side grid, 4-neighbour, both directions share a weight
+// in [1, maxWeight]. *E receives 4 * side * (side - 1).
+static inline struct CSREdge* generateGridEdges(int side, int maxWeight, long long* E) {
+    *E = 4LL * side * (side - 1);
+    struct CSREdge* edges = (struct CSREdge*)csrAlloc(*E * sizeof(struct CSREdge));
+    long long k = 0;
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int u = r * side + c;
+            if (c + 1 < side) {
+                int w = 1 + (int)(xorshift64() % maxWeight);
+                edges[k++] = (struct CSREdge){u, u + 1, w};
+                edges[k++] = (struct CSREdge){u + 1, u, w};
+            }
+            if (r + 1 < side) {
+                int w = 1 + (int)(xorshift64() % maxWeight);
+                edges[k++] = (struct CSREdge){u, u + side, w};
+                edges[k++] = (struct CSREdge){u + side, u, w};
+            }
+        }
+    }
+    return edges;
+}
+
+// E directed edges with uniformly random endpoints in [0, V) and weights in
+// [1, maxWeight], emitted in random source order.
+static inline struct CSREdge* generateRandomEdges(int V, long long E, int maxWeight) {
+    struct CSREdge* edges = (struct CSREdge*)csrAlloc(E * sizeof(struct CSREdge));
+    for (long long i = 0; i < E; i++) {
+        edges[i].src = (int)(xorshift64() % V);
+        edges[i].dest = (int)(xorshift64() % V);
+        edges[i].weight = 1 + (int)(xorshift64() % maxWeight);
+    }
+    return edges;
+}
+
+#endif // GRAPH_GENERATOR_H
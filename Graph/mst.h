@@ -0,0 +1,286 @@
+/* Minimum spanning forest engine over an edge list.
+
+  MST_KRUSKAL         radix sort of all edges by weight (LSD, 8-bit digits,
+                      one histogram pre-pass, trivial passes skipped), then
+                      the usual union-find scan, stopping at V - 1 edges.
+  MST_FILTER_KRUSKAL  filter-Kruskal (Osipov, Sanders, Singler 2009): split
+                      the edges around a sampled pivot weight, solve the
+                      light half, drop heavy edges whose endpoints are
+                      already connected, then recurse on what is left. On
+                      dense or random graphs most heavy edges never get
+                      sorted.
+  MST_BORUVKA         parallel Boruvka: every round each component picks its
+                      lightest edge with an atomic 64-bit min over
+                      (weight, edge index), the picks are merged with the
+                      lock-free union-find, and edges inside one component
+                      are filtered out. Needs -fopenmp for more than one
+                      thread.
+
+The input array is used as scratch space: on return its order and contents
+are unspecified. The chosen edges are written to out[] (room for V - 1)
+in non-decreasing weight order. Edge ids must lie in [0, V). */
+
+#ifndef MST_H
+#define MST_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "csr_graph.h"
+#include "union_find.h"
+
+enum MSTMode {
+    MST_KRUSKAL,
+    MST_FILTER_KRUSKAL,
+    MST_BORUVKA
+};
+
+// Below this many edges filter-Kruskal just sorts
+#define MST_FILTER_THRESHOLD 4096
+
+static inline const char* mstModeName(enum MSTMode mode) {
+    switch (mode) {
+    case MST_KRUSKAL:        return "kruskal";
+    case MST_FILTER_KRUSKAL: return "filter-kruskal";
+    case MST_BORUVKA:        return "boruvka";
+    }
+    return "?";
+}
+
+static inline int parseMSTMode(const char* name, enum MSTMode* mode) {
+    for (int m = MST_KRUSKAL; m <= MST_BORUVKA; m++)
+        if (strcmp(name, mstModeName((enum MSTMode)m)) == 0) {
+            *mode = (enum MSTMode)m;
+            return 1;
+        }
+    return 0;
+}
+
+// Signed weight -> unsigned key with the same order
+static inline uint32_t mstKey(int weight) {
+    return (uint32_t)weight ^ 0x80000000u;
+}
+
+// ---------- LSD radix sort of edges by weight ----------
+// scratch must hold n edges. The sorted edges end up in edges[].
+static inline void mstRadixSort(struct CSREdge* edges, struct CSREdge* scratch, long long n) {
+    long long count[4][256];
+    memset(count, 0, sizeof(count));
+    for (long long i = 0; i < n; i++) {
+        uint32_t k = mstKey(edges[i].weight);
+        count[0][k & 255]++;
+        count[1][(k >> 8) & 255]++;
+        count[2][(k >> 16) & 255]++;
+        count[3][k >> 24]++;
+    }
+
+    struct CSREdge* from = edges;
+    struct CSREdge* to = scratch;
+    for (int d = 0; d < 4; d++) {
+        int shift = 8 * d;
+        // All keys share this digit: the pass would not move anything
+        if (n == 0 || count[d][(mstKey(from[0].weight) >> shift) & 255] == n)
+            continue;
+        long long pos[256], sum = 0;
+        for (int b = 0; b < 256; b++) {
+            pos[b] = sum;
+            sum += count[d][b];
+        }
+        for (long long i = 0; i < n; i++)
+            to[pos[(mstKey(from[i].weight) >> shift) & 255]++] = from[i];
+        struct CSREdge* t = from;
+        from = to;
+        to = t;
+    }
+    if (from != edges)
+        memcpy(edges, from, n * sizeof(struct CSREdge));
+}
+
+// Union-find scan over weight-sorted edges
+static inline void mstScan(const struct CSREdge* edges, long long n, struct UnionFind* uf,
+                           int V, struct CSREdge* out, int* count) {
+    for (long long i = 0; i < n && *count < V - 1; i++)
+        if (ufUnion(uf, edges[i].src, edges[i].dest))
+            out[(*count)++] = edges[i];
+}
+
+// ---------- Filter-Kruskal ----------
+static inline void mstFilterKruskal(struct CSREdge* edges, struct CSREdge* scratch, long long n,
+                                    struct UnionFind* uf, int V, struct CSREdge* out, int* count) {
+    while (*count < V - 1 && n > 0) {
+        if (n <= MST_FILTER_THRESHOLD) {
+            mstRadixSort(edges, scratch, n);
+            mstScan(edges, n, uf, V, out, count);
+            return;
+        }
+
+        // Pivot: median of 9 evenly spaced samples
+        int sample[9];
+        for (int s = 0; s < 9; s++)
+            sample[s] = edges[(n - 1) * s / 8].weight;
+        for (int i = 1; i < 9; i++)
+            for (int j = i; j > 0 && sample[j - 1] > sample[j]; j--) {
+                int t = sample[j];
+                sample[j] = sample[j - 1];
+                sample[j - 1] = t;
+            }
+        int pivot = sample[4];
+
+        // Light part: weight <= pivot, unless that is everything, then < pivot
+        long long light = 0;
+        for (long long i = 0; i < n; i++)
+            if (edges[i].weight <= pivot) {
+                struct CSREdge t = edges[light];
+                edges[light++] = edges[i];
+                edges[i] = t;
+            }
+        if (light == n) {
+            light = 0;
+            for (long long i = 0; i < n; i++)
+                if (edges[i].weight < pivot) {
+                    struct CSREdge t = edges[light];
+                    edges[light++] = edges[i];
+                    edges[i] = t;
+                }
+            if (light == 0) {
+                // every weight equals pivot: any order is sorted
+                mstScan(edges, n, uf, V, out, count);
+                return;
+            }
+        }
+
+        mstFilterKruskal(edges, scratch, light, uf, V, out, count);
+
+        // Filter the heavy part, then loop on it instead of recursing
+        struct CSREdge* heavy = edges + light;
+        long long kept = 0;
+        for (long long i = 0; i < n - light; i++)
+            if (ufFind(uf, heavy[i].src) != ufFind(uf, heavy[i].dest))
+                heavy[kept++] = heavy[i];
+        edges = heavy;
+        n = kept;
+    }
+}
+
+// ---------- Parallel Boruvka ----------
+static inline void mstAtomicMin64(uint64_t* p, uint64_t value) {
+    uint64_t old = __atomic_load_n(p, __ATOMIC_RELAXED);
+    while (value < old)
+        if (__atomic_compare_exchange_n(p, &old, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return;
+}
+
+static inline void mstBoruvka(struct CSREdge* edges, long long n, int V, struct CSREdge* out, int* count) {
+    struct UnionFind* uf = createUnionFind(V);
+    uint64_t* best = (uint64_t*)csrAlloc(V * sizeof(uint64_t));
+    int nThreads = 1;
+#ifdef _OPENMP
+    nThreads = omp_get_max_threads();
+#endif
+    long long* kept = (long long*)csrAlloc((nThreads + 1) * sizeof(long long));
+
+    #pragma omp parallel for
+    for (int v = 0; v < V; v++)
+        best[v] = UINT64_MAX;
+
+    int added = 1;
+    while (added && n > 0) {
+        // 1. Lightest edge leaving every component, ties broken by index
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < n; i++) {
+            int ru = ufFindConcurrent(uf, edges[i].src);
+            int rv = ufFindConcurrent(uf, edges[i].dest);
+            if (ru == rv)
+                continue;
+            uint64_t key = ((uint64_t)mstKey(edges[i].weight) << 32) | (uint64_t)i;
+            mstAtomicMin64(&best[ru], key);
+            mstAtomicMin64(&best[rv], key);
+        }
+
+        // 2. Merge along the picked edges; a pick shared by both sides joins once
+        added = 0;
+        #pragma omp parallel for schedule(static) reduction(+:added)
+        for (int r = 0; r < V; r++) {
+            if (best[r] == UINT64_MAX)
+                continue;
+            struct CSREdge e = edges[best[r] & 0xffffffffu];
+            best[r] = UINT64_MAX;
+            if (ufUnionConcurrent(uf, e.src, e.dest)) {
+                out[__atomic_fetch_add(count, 1, __ATOMIC_RELAXED)] = e;
+                added++;
+            }
+        }
+
+        // 3. Drop edges inside one component: compact each thread's slice,
+        //    then slide the slices down in order
+        #pragma omp parallel num_threads(nThreads)
+        {
+            int t = 0, T = 1;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+            T = omp_get_num_threads();
+#endif
+            long long begin = n * t / T, end = n * (t + 1) / T, k = begin;
+            for (long long i = begin; i < end; i++)
+                if (ufFindConcurrent(uf, edges[i].src) != ufFindConcurrent(uf, edges[i].dest))
+                    edges[k++] = edges[i];
+            kept[t] = k - begin;
+            #pragma omp barrier
+            #pragma omp single
+            {
+                long long at = 0;
+                for (int s = 0; s < T; s++) {
+                    long long from = n * s / T;
+                    memmove(edges + at, edges + from, kept[s] * sizeof(struct CSREdge));
+                    at += kept[s];
+                }
+                n = at;
+            }
+        }
+    }
+
+    free(kept);
+    free(best);
+    freeUnionFind(uf);
+}
+
+// Returns the number of forest edges written to out; *totalWeight gets their sum
+static inline int minimumSpanningForest(struct CSREdge* edges, long long E, int V, enum MSTMode mode,
+                                        struct CSREdge* out, long long* totalWeight) {
+    int count = 0;
+    if (mode == MST_BORUVKA) {
+        if (E > (long long)UINT32_MAX) {
+            fprintf(stderr, "Boruvka mode supports at most 2^32 - 1 edges\n");
+            exit(1);
+        }
+        mstBoruvka(edges, E, V, out, &count);
+        // Picks arrive in round order; present them sorted like Kruskal's
+        struct CSREdge* scratch = (struct CSREdge*)csrAlloc(count * sizeof(struct CSREdge));
+        mstRadixSort(out, scratch, count);
+        free(scratch);
+    } else {
+        struct CSREdge* scratch = (struct CSREdge*)csrAlloc(
+            (mode == MST_KRUSKAL ? E : MST_FILTER_THRESHOLD) * sizeof(struct CSREdge));
+        struct UnionFind* uf = createUnionFind(V);
+        if (mode == MST_KRUSKAL) {
+            mstRadixSort(edges, scratch, E);
+            mstScan(edges, E, uf, V, out, &count);
+        } else {
+            mstFilterKruskal(edges, scratch, E, uf, V, out, &count);
+        }
+        freeUnionFind(uf);
+        free(scratch);
+    }
+
+    long long total = 0;
+    for (int i = 0; i < count; i++)
+        total += out[i].weight;
+    *totalWeight = total;
+    return count;
+}
+
+#endif // MST_H
@@ -0,0 +1,232 @@
+/* Monotone integer priority queues for Dijkstra-style searches.
+
+One interface, three backends selected at run time:
+
+  PQ_DARY_HEAP     flat 4-ary min-heap of (key, vertex) pairs stored by value;
+                   works for any keys, O(log V) per operation.
+  PQ_RADIX_HEAP    radix heap (Ahuja, Mehlhorn, Orlin, Tarjan 1990) with 33
+                   buckets indexed by the highest bit in which a key differs
+                   from the last extracted key; O(log C) amortized.
+  PQ_DIAL_BUCKETS  Dial's circular bucket queue with maxWeight + 1 buckets;
+                   O(1) push, pop amortized over the empty buckets skipped.
+                   Above PQ_DIAL_MAX_BUCKETS buckets pqInit falls back to
+                   the radix heap, so check q->kind after pqInit.
+
+The radix heap and Dial's buckets are monotone: a pushed key must never be
+smaller than the last popped key, which holds for Dijkstra with
+non-negative weights. All backends use lazy deletion instead of
+decrease-key: the caller pushes a vertex again when its distance improves
+and skips popped entries whose key no longer matches dist[v]. */
+
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Largest Dial bucket array, 64 MB of bucket headers
+#define PQ_DIAL_MAX_BUCKETS (1 << 22)
+
+enum PQKind {
+    PQ_DARY_HEAP,
+    PQ_RADIX_HEAP,
+    PQ_DIAL_BUCKETS
+};
+
+struct PQItem {
+    unsigned key;
+    int v;
+};
+
+// Growable array of items, used as one bucket
+struct PQBucket {
+    int size, capacity;
+    struct PQItem* a;
+};
+
+struct PriorityQueue {
+    enum PQKind kind;
+    long long size;
+
+    // PQ_DARY_HEAP
+    struct PQBucket heap;
+
+    // PQ_RADIX_HEAP: bucket 0 holds keys equal to last, bucket i keys whose
+    // highest differing bit from last is i - 1
+    struct PQBucket radix[33];
+    unsigned last;
+
+    // PQ_DIAL_BUCKETS: bucket cur % nBuckets holds key cur
+    struct PQBucket* dial;
+    int nBuckets;
+    unsigned cur;
+};
+
+static inline void pqBucketPush(struct PQBucket* b, unsigned key, int v) {
+    if (b->size == b->capacity) {
+        b->capacity = b->capacity ? 2 * b->capacity : 16;
+        b->a = (struct PQItem*)realloc(b->a, b->capacity * sizeof(struct PQItem));
+        if (b->a == NULL) {
+            perror("priority queue allocation failed");
+            exit(1);
+        }
+    }
+    b->a[b->size].key = key;
+    b->a[b->size].v = v;
+    b->size++;
+}
+
+static inline const char* pqKindName(enum PQKind kind) {
+    switch (kind) {
+    case PQ_DARY_HEAP:    return "4-ary heap";
+    case PQ_RADIX_HEAP:   return "radix heap";
+    case PQ_DIAL_BUCKETS: return "dial buckets";
+    }
+    return "?";
+}
+
+// maxWeight is the largest edge weight; it is only used by PQ_DIAL_BUCKETS,
+// which becomes PQ_RADIX_HEAP when maxWeight + 1 buckets would be too many
+static inline void pqInit(struct PriorityQueue* q, enum PQKind kind, int maxWeight) {
+    memset(q, 0, sizeof(*q));
+    long long buckets = maxWeight > 0 ? (long long)maxWeight + 1 : 1;
+    if (kind == PQ_DIAL_BUCKETS && buckets > PQ_DIAL_MAX_BUCKETS)
+        kind = PQ_RADIX_HEAP;
+    q->kind = kind;
+    if (kind == PQ_DIAL_BUCKETS) {
+        q->nBuckets = (int)buckets;
+        q->dial = (struct PQBucket*)calloc(q->nBuckets, sizeof(struct PQBucket));
+        if (q->dial == NULL) {
+            perror("priority queue allocation failed");
+            exit(1);
+        }
+    }
+}
+
+static inline void pqFree(struct PriorityQueue* q) {
+    free(q->heap.a);
+    for (int i = 0; i < 33; i++)
+        free(q->radix[i].a);
+    for (int i = 0; i < q->nBuckets; i++)
+        free(q->dial[i].a);
+    free(q->dial);
+    memset(q, 0, sizeof(*q));
+}
+
+// Empty the queue but keep its buffers for the next search
+static inline void pqClear(struct PriorityQueue* q) {
+    q->size = 0;
+    q->heap.size = 0;
+    for (int i = 0; i < 33; i++)
+        q->radix[i].size = 0;
+    for (int i = 0; i < q->nBuckets; i++)
+        q->dial[i].size = 0;
+    q->last = 0;
+    q->cur = 0;
+}
+
+static inline int pqEmpty(const struct PriorityQueue* q) {
+    return q->size == 0;
+}
+
+// ---------- 4-ary heap ----------
+static inline void daryPush(struct PQBucket* h, unsigned key, int v) {
+    pqBucketPush(h, key, v);
+    struct PQItem* a = h->a;
+    int i = h->size - 1;
+    while (i > 0 && a[(i - 1) >> 2].key > key) {
+        a[i] = a[(i - 1) >> 2];
+        i = (i - 1) >> 2;
+    }
+    a[i].key = key;
+    a[i].v = v;
+}
+
+static inline struct PQItem daryPop(struct PQBucket* h) {
+    struct PQItem* a = h->a;
+    struct PQItem top = a[0];
+    struct PQItem last = a[--h->size];
+    int n = h->size, i = 0;
+    for (;;) {
+        int c = 4 * i + 1;
+        if (c >= n)
+            break;
+        int best = c;
+        int end = c + 4 < n ? c + 4 : n;
+        for (int k = c + 1; k < end; k++)
+            if (a[k].key < a[best].key)
+                best = k;
+        if (a[best].key >= last.key)
+            break;
+        a[i] = a[best];
+        i = best;
+    }
+    a[i] = last;
+    return top;
+}
+
+// ---------- Radix heap ----------
+static inline int radixBucket(unsigned key, unsigned last) {
+    return key == last ? 0 : 32 - __builtin_clz(key ^ last);
+}
+
+static inline struct PQItem radixPop(struct PriorityQueue* q) {
+    if (q->radix[0].size == 0) {
+        int i = 1;
+        while (q->radix[i].size == 0)
+            i++;
+        // New minimum becomes last; every item of bucket i moves to a lower bucket
+        struct PQBucket* b = &q->radix[i];
+        unsigned min = b->a[0].key;
+        for (int k = 1; k < b->size; k++)
+            if (b->a[k].key < min)
+                min = b->a[k].key;
+        q->last = min;
+        for (int k = 0; k < b->size; k++)
+            pqBucketPush(&q->radix[radixBucket(b->a[k].key, min)], b->a[k].key, b->a[k].v);
+        b->size = 0;
+    }
+    return q->radix[0].a[--q->radix[0].size];
+}
+
+// ---------- Dial's buckets ----------
+static inline struct PQItem dialPop(struct PriorityQueue* q) {
+    struct PQBucket* b = &q->dial[q->cur % q->nBuckets];
+    while (b->size == 0) {
+        q->cur++;
+        b = &q->dial[q->cur % q->nBuckets];
+    }
+    return b->a[--b->size];
+}
+
+// ---------- Interface ----------
+static inline void pqPush(struct PriorityQueue* q, unsigned key, int v) {
+    q->size++;
+    switch (q->kind) {
+    case PQ_DARY_HEAP:
+        daryPush(&q->heap, key, v);
+        break;
+    case PQ_RADIX_HEAP:
+        pqBucketPush(&q->radix[radixBucket(key, q->last)], key, v);
+        break;
+    case PQ_DIAL_BUCKETS:
+        pqBucketPush(&q->dial[key % q->nBuckets], key, v);
+        break;
+    }
+}
+
+// Remove and return an item with the smallest key; the queue must not be empty
+static inline struct PQItem pqPop(struct PriorityQueue* q) {
+    q->size--;
+    switch (q->kind) {
+    case PQ_RADIX_HEAP:
+        return radixPop(q);
+    case PQ_DIAL_BUCKETS:
+        return dialPop(q);
+    default:
+        return daryPop(&q->heap);
+    }
+}
+
+#endif // PRIORITY_QUEUE_H
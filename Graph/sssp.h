@@ -0,0 +1,54 @@
+/* Single-source shortest path kernels over the CSR graph core.
+
+dijkstraSSSP is the sequential reference engine: lazy-deletion Dijkstra
+over any backend of priority_queue.h. Edge weights must be non-negative. */
+
+#ifndef SSSP_H
+#define SSSP_H
+
+#include <limits.h>
+
+#include "csr_graph.h"
+#include "priority_queue.h"
+
+#define SSSP_INF INT_MAX
+
+// Fills dist[] (SSSP_INF when unreachable) and, if parent is not NULL,
+// parent[] (-1 for src and unreachable vertices). q is cleared first so it
+// can be reused across sources. Returns the number of settled vertices.
+static inline long long dijkstraSSSP(const struct CSRGraph* g, int src, int* dist, int* parent,
+                                     struct PriorityQueue* q) {
+    long long settled = 0;
+    for (int i = 0; i < g->V; i++)
+        dist[i] = SSSP_INF;
+    if (parent)
+        for (int i = 0; i < g->V; i++)
+            parent[i] = -1;
+
+    pqClear(q);
+    dist[src] = 0;
+    pqPush(q, 0, src);
+
+    while (!pqEmpty(q)) {
+        struct PQItem top = pqPop(q);
+        int u = top.v;
+        if ((int)top.key != dist[u])
+            continue;  // stale entry, u was settled with a smaller key
+        settled++;
+
+        int du = dist[u];
+        for (long long i = g->offset[u]; i < g->offset[u + 1]; i++) {
+            int v = g->dest[i];
+            int nd = du + g->weight[i];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                if (parent)
+                    parent[v] = u;
+                pqPush(q, (unsigned)nd, v);
+            }
+        }
+    }
+    return settled;
+}
+
+#endif // SSSP_H
@@ -0,0 +1,151 @@
+/* Union-find (disjoint sets) over vertex ids 0 .. n-1.
+
+Two variants share one parent[] layout:
+
+  ufFind / ufUnion                 sequential; iterative path halving and
+                                   union by rank, no recursion.
+  ufFindConcurrent /               safe to call from many threads at once
+  ufUnionConcurrent                without locks. Roots are linked with a
+                                   single CAS on parent[root]; the lower
+                                   index always becomes the parent, so no
+                                   cycle can form. Path halving is done with
+                                   CAS and may simply fail under contention,
+                                   which only costs compression, never
+                                   correctness.
+
+The concurrent variant ignores rank[]; do not mix both variants on one
+structure while threads are running.
+
+Batched calls take parallel arrays xs[i], ys[i] and spread them over the
+OpenMP threads (one thread without -fopenmp) using the concurrent variant:
+
+  ufUnionBatch      unions every pair, returns how many merged two sets
+  ufFindBatch       roots[i] = find(xs[i])
+  ufConnectedBatch  same[i] = xs[i] and ys[i] are in one set
+
+A find batch must not overlap a union batch. Because the smaller root
+always wins, the root of every set is its smallest id once the concurrent
+variant alone has been used, whatever order the threads took. */
+
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+struct UnionFind {
+    int n;
+    int* parent;
+    unsigned char* rank;  // only used by the sequential variant
+};
+
+static inline struct UnionFind* createUnionFind(int n) {
+    struct UnionFind* uf = (struct UnionFind*)malloc(sizeof(struct UnionFind));
+    int* parent = (int*)malloc((n ? n : 1) * sizeof(int));
+    unsigned char* rank = (unsigned char*)calloc(n ? n : 1, 1);
+    if (!uf || !parent || !rank) {
+        perror("union-find allocation failed");
+        exit(1);
+    }
+    uf->n = n;
+    uf->parent = parent;
+    uf->rank = rank;
+    for (int i = 0; i < n; i++)
+        parent[i] = i;
+    return uf;
+}
+
+static inline void freeUnionFind(struct UnionFind* uf) {
+    if (!uf)
+        return;
+    free(uf->parent);
+    free(uf->rank);
+    free(uf);
+}
+
+// ---------- Sequential ----------
+static inline int ufFind(struct UnionFind* uf, int x) {
+    int* p = uf->parent;
+    while (p[x] != x) {
+        p[x] = p[p[x]];  // path halving
+        x = p[x];
+    }
+    return x;
+}
+
+// Returns 1 if x and y were in different sets
+static inline int ufUnion(struct UnionFind* uf, int x, int y) {
+    x = ufFind(uf, x);
+    y = ufFind(uf, y);
+    if (x == y)
+        return 0;
+    if (uf->rank[x] < uf->rank[y]) {
+        int t = x;
+        x = y;
+        y = t;
+    }
+    uf->parent[y] = x;
+    if (uf->rank[x] == uf->rank[y])
+        uf->rank[x]++;
+    return 1;
+}
+
+// ---------- Concurrent ----------
+static inline int ufFindConcurrent(struct UnionFind* uf, int x) {
+    int* p = uf->parent;
+    for (;;) {
+        int px = __atomic_load_n(&p[x], __ATOMIC_RELAXED);
+        int gx = __atomic_load_n(&p[px], __ATOMIC_RELAXED);
+        if (px == gx)
+            return px;
+        __atomic_compare_exchange_n(&p[x], &px, gx, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        x = gx;
+    }
+}
+
+// Returns 1 if this call joined two different sets
+static inline int ufUnionConcurrent(struct UnionFind* uf, int x, int y) {
+    for (;;) {
+        x = ufFindConcurrent(uf, x);
+        y = ufFindConcurrent(uf, y);
+        if (x == y)
+            return 0;
+        if (x < y) {
+            int t = x;
+            x = y;
+            y = t;
+        }
+        // Link root x under the smaller root y; fails if x stopped being a root
+        int expected = x;
+        if (__atomic_compare_exchange_n(&uf->parent[x], &expected, y, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            return 1;
+    }
+}
+
+// ---------- Batched ----------
+static inline long long ufUnionBatch(struct UnionFind* uf, const int* xs, const int* ys, long long n) {
+    long long merged = 0;
+    #pragma omp parallel for schedule(static) reduction(+:merged)
+    for (long long i = 0; i < n; i++)
+        merged += ufUnionConcurrent(uf, xs[i], ys[i]);
+    return merged;
+}
+
+static inline void ufFindBatch(struct UnionFind* uf, const int* xs, int* roots, long long n) {
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; i++)
+        roots[i] = ufFindConcurrent(uf, xs[i]);
+}
+
+static inline void ufConnectedBatch(struct UnionFind* uf, const int* xs, const int* ys,
+                                    unsigned char* same, long long n) {
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < n; i++)
+        same[i] = ufFindConcurrent(uf, xs[i]) == ufFindConcurrent(uf, ys[i]);
+}
+
+#endif // UNION_FIND_H
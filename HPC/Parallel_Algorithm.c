@@ -1,71 +1,179 @@
-/* #pragma omp parallel sections
-{
-    #pragma omp section
-    parallel_merge_sort(arr, left, mid, depth+1);
+/* Parallel merge sort with OpenMP tasks
 
-    #pragma omp section
-    parallel_merge_sort(arr, mid+1, right, depth+1);
-}
+One task tree instead of nested parallel sections:
+
+  - a single scratch buffer of n ints, allocated once; the recursion
+    ping-pongs between the array and the scratch buffer, so no level
+    copies its halves out before merging,
+  - ranges of at most INSERTION_CUTOFF elements are insertion-sorted,
+  - ranges above TASK_CUTOFF sort their halves as separate tasks, so the
+    runtime's work stealing balances any number of threads,
+  - the merge is itself divide and conquer: split the larger input at its
+    middle, binary-search that key in the other input, and merge the two
+    pairs of halves as tasks. The top-level merge therefore runs on all
+    threads instead of one.
 
 gcc -fopenmp parallel_mergesort.c -o mergesort
 
+External mode, for files larger than RAM: merge-sorted runs of at most
+half of -m <MB> are spilled to temporary files in -t <dir> and merged with
+a loser tree (../Algorithms/external_sort.h). Text in and out by default,
+raw little-endian int32 with -b, -bi (input only) or -bo (output only).
+
+./mergesort -m MB [-t dir] [-b | -bi | -bo] input output
+
 */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <omp.h>
 
+#include "../Algorithms/external_sort.h"
 
-void merge(int arr[], int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-    int *L = malloc(n1 * sizeof(int));
-    int *R = malloc(n2 * sizeof(int));
 
-    for (int i = 0; i < n1; i++)
-        L[i] = arr[left + i];
-    for (int i = 0; i < n2; i++)
-        R[i] = arr[mid + 1 + i];
+// Ranges this small are insertion-sorted
+#define INSERTION_CUTOFF 32
 
-    int i = 0, j = 0, k = left;
+// Ranges above this size are split into tasks
+#define TASK_CUTOFF 8192
 
-    while (i < n1 && j < n2) {
-        if (L[i] <= R[j]) arr[k++] = L[i++];
-        else arr[k++] = R[j++];
-    }
+// Merges with fewer outputs than this run serially
+#define MERGE_CUTOFF 16384
 
-    while (i < n1) arr[k++] = L[i++];
-    while (j < n2) arr[k++] = R[j++];
+void insertion_sort(int arr[], size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        int x = arr[i];
+        size_t j = i;
+        for (; j > 0 && arr[j - 1] > x; j--)
+            arr[j] = arr[j - 1];
+        arr[j] = x;
+    }
+}
 
-    free(L);
-    free(R);
+// First position in b[0 .. n) whose value is >= x (or > x if upper)
+size_t search(const int b[], size_t n, int x, int upper) {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (b[mid] < x || (upper && b[mid] == x))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
 }
 
-void parallel_merge_sort(int arr[], int left, int right, int depth) {
-    if (left < right) {
-        int mid = left + (right - left) / 2;
-
-        // Parallel sections for left and right recursion
-        if (depth <= 3) {   // limit depth to avoid oversubscription
-            #pragma omp parallel sections
-            {
-                #pragma omp section
-                parallel_merge_sort(arr, left, mid, depth + 1);
-
-                #pragma omp section
-                parallel_merge_sort(arr, mid + 1, right, depth + 1);
-            }
-        } else {
-            // Fall back to sequential recursion
-            parallel_merge_sort(arr, left, mid, depth + 1);
-            parallel_merge_sort(arr, mid + 1, right, depth + 1);
+// Stable merge of the sorted L[0 .. n1) and R[0 .. n2) into out[]; on
+// equal keys L comes first
+void merge(const int L[], size_t n1, const int R[], size_t n2, int out[]) {
+    if (n1 + n2 < MERGE_CUTOFF) {
+        size_t i = 0, j = 0, k = 0;
+        while (i < n1 && j < n2) {
+            if (L[i] <= R[j]) out[k++] = L[i++];
+            else out[k++] = R[j++];
         }
+        while (i < n1) out[k++] = L[i++];
+        while (j < n2) out[k++] = R[j++];
+        return;
+    }
 
-        merge(arr, left, mid, right);
+    // Split the larger side at its middle and the other at the same key
+    size_t i, j;
+    if (n1 >= n2) {
+        i = n1 / 2;
+        j = search(R, n2, L[i], 0);  // R keys equal to L[i] go after it
+    } else {
+        j = n2 / 2;
+        i = search(L, n1, R[j], 1);  // L keys equal to R[j] go before it
     }
+    #pragma omp task
+    merge(L, i, R, j, out);
+    merge(L + i, n1 - i, R + j, n2 - j, out + i + j);
+    #pragma omp taskwait
 }
 
-int main() {
+// Sorts arr[0 .. n); the result ends up in arr if !intoScratch, otherwise in
+// scratch[0 .. n). The other array is used as workspace.
+void sort_range(int arr[], int scratch[], size_t n, int intoScratch) {
+    if (n <= INSERTION_CUTOFF) {
+        insertion_sort(arr, n);
+        if (intoScratch)
+            memcpy(scratch, arr, n * sizeof(int));
+        return;
+    }
+
+    size_t mid = n / 2;
+    // Sort both halves into the array we are not merging into
+    #pragma omp task if (n > TASK_CUTOFF)
+    sort_range(arr, scratch, mid, !intoScratch);
+    sort_range(arr + mid, scratch + mid, n - mid, !intoScratch);
+    #pragma omp taskwait
+
+    if (intoScratch)
+        merge(arr, mid, arr + mid, n - mid, scratch);
+    else
+        merge(scratch, mid, scratch + mid, n - mid, arr);
+}
+
+// Sorts arr[0 .. n). scratch must hold n ints, or be NULL to allocate it here.
+void parallel_merge_sort(int arr[], int scratch[], size_t n) {
+    int* buffer = scratch ? scratch : malloc((n ? n : 1) * sizeof(int));
+    if (buffer == NULL) {
+        perror("merge sort scratch allocation failed");
+        exit(1);
+    }
+
+    #pragma omp parallel
+    #pragma omp single
+    sort_range(arr, buffer, n, 0);
+
+    if (!scratch)
+        free(buffer);
+}
+
+// Run sort for the external mode
+void mergeSortRun(int32_t* a, int32_t* scratch, size_t n) {
+    parallel_merge_sort(a, scratch, n);
+}
+
+int externalMain(int argc, char* argv[]) {
+    const char* tmpDir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    const char* files[2] = {NULL, NULL};
+    int binaryIn = 0, binaryOut = 0, nFiles = 0;
+    size_t memoryMB = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+            memoryMB = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+            tmpDir = argv[++i];
+        else if (strcmp(argv[i], "-b") == 0)
+            binaryIn = binaryOut = 1;
+        else if (strcmp(argv[i], "-bi") == 0)
+            binaryIn = 1;
+        else if (strcmp(argv[i], "-bo") == 0)
+            binaryOut = 1;
+        else if (nFiles < 2)
+            files[nFiles++] = argv[i];
+        else
+            nFiles = 3;
+    }
+    if (memoryMB == 0 || nFiles != 2) {
+        printf("Usage: %s -m MB [-t dir] [-b | -bi | -bo] input output\n", argv[0]);
+        return 1;
+    }
+
+    struct ExternalSortStats stats;
+    externalSort(files[0], binaryIn, files[1], binaryOut, memoryMB << 20, tmpDir, mergeSortRun, &stats);
+    printExternalSortStats(&stats);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1)
+        return externalMain(argc, argv);
+
     int n;
     printf("Enter number of elements: ");
     scanf("%d", &n);
@@ -77,7 +185,7 @@ int main() {
 
     double start = omp_get_wtime();
     
-    parallel_merge_sort(arr, 0, n - 1, 0);
+    parallel_merge_sort(arr, NULL, n);
 
     double end = omp_get_wtime();
 